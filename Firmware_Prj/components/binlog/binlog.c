@@ -0,0 +1,122 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "esp_attr.h"
+#include "esp_cpu.h"
+#include "esp_timer.h"
+#include "binlog.h"
+#include "binlog_private.h"
+
+#if CONFIG_BINLOG_FUNC_IN_IRAM
+#define BINLOG_ATTR IRAM_ATTR
+#else
+#define BINLOG_ATTR
+#endif
+
+#define BINLOG_RING_DEPTH CONFIG_BINLOG_RING_DEPTH
+
+_Static_assert((BINLOG_RING_DEPTH & (BINLOG_RING_DEPTH - 1)) == 0, "CONFIG_BINLOG_RING_DEPTH must be a power of two");
+
+/*
+ * One ring per core. The producers of a ring are the tasks and ISRs of its core, they are
+ * serialised by masking interrupts on that core for the few stores of one entry, which also
+ * keeps the task from migrating. No lock is shared between cores, so a writer never spins.
+ * The consumer is the drain task. Indices are free running.
+ */
+typedef struct {
+    binlog_entry_t entries[BINLOG_RING_DEPTH];
+    atomic_uint head; // Next free slot, written by the producers of the core
+    atomic_uint tail; // Next entry to drain, written by the consumer
+    uint32_t dropped; // Events lost because the ring was full
+} binlog_ring_t;
+
+static DRAM_ATTR binlog_ring_t s_rings[portNUM_PROCESSORS];
+
+TaskHandle_t binlog_drain_task;
+
+static const struct {
+    const char *tag;
+    const char *format;
+} s_events[BINLOG_ID_MAX] = {
+#define BINLOG_EVENT_DESC(name, tag, format) [BINLOG_ID_##name] = {tag, format},
+    BINLOG_EVENTS(BINLOG_EVENT_DESC)
+#undef BINLOG_EVENT_DESC
+};
+
+void BINLOG_ATTR binlog_write(binlog_id_t id, uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3)
+{
+    UBaseType_t irq_state = portSET_INTERRUPT_MASK_FROM_ISR();
+    uint32_t core = esp_cpu_get_core_id();
+    binlog_ring_t *ring = &s_rings[core];
+    unsigned head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    if (head - atomic_load_explicit(&ring->tail, memory_order_acquire) >= BINLOG_RING_DEPTH) {
+        ring->dropped++;
+        portCLEAR_INTERRUPT_MASK_FROM_ISR(irq_state);
+        return;
+    }
+    binlog_entry_t *entry = &ring->entries[head & (BINLOG_RING_DEPTH - 1)];
+    entry->time_us = (uint32_t)esp_timer_get_time();
+    entry->id = (uint16_t)id;
+    entry->core = (uint8_t)core;
+    entry->reserved = 0;
+    entry->args[0] = a0;
+    entry->args[1] = a1;
+    entry->args[2] = a2;
+    entry->args[3] = a3;
+    /* Sequentially consistent so that either the drain sees this entry before it blocks, or this
+     * writer sees the ring was drained up to its entry and wakes the drain */
+    atomic_store_explicit(&ring->head, head + 1, memory_order_seq_cst);
+    bool wake = atomic_load_explicit(&ring->tail, memory_order_seq_cst) == head;
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(irq_state);
+
+    TaskHandle_t task = binlog_drain_task;
+    if (wake && task) {
+        if (xPortInIsrContext()) {
+            vTaskNotifyGiveIndexedFromISR(task, 0, NULL);
+        } else {
+            xTaskNotifyGiveIndexed(task, 0);
+        }
+    }
+}
+
+size_t binlog_drain(binlog_sink_t sink, void *ctx)
+{
+    size_t count = 0;
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        binlog_ring_t *ring = &s_rings[core];
+        unsigned tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+        while (tail != atomic_load_explicit(&ring->head, memory_order_seq_cst)) {
+            binlog_entry_t entry = ring->entries[tail & (BINLOG_RING_DEPTH - 1)];
+            atomic_store_explicit(&ring->tail, ++tail, memory_order_seq_cst);
+            sink(&entry, ctx);
+            count++;
+        }
+    }
+    return count;
+}
+
+uint32_t binlog_get_dropped(void)
+{
+    uint32_t dropped = 0;
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        dropped += s_rings[core].dropped;
+    }
+    return dropped;
+}
+
+const char *binlog_format(const binlog_entry_t *entry, char *buf, size_t size)
+{
+    if (entry->id >= BINLOG_ID_MAX) {
+        snprintf(buf, size, "unknown event %u", entry->id);
+        return "binlog";
+    }
+    snprintf(buf, size, s_events[entry->id].format, entry->args[0], entry->args[1], entry->args[2],
+             entry->args[3]);
+    return s_events[entry->id].tag;
+}
@@ -0,0 +1,68 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include "esp_check.h"
+#include "esp_log.h"
+#include "binlog.h"
+#include "binlog_private.h"
+
+#if CONFIG_BINLOG_ENABLE
+static const char *TAG = "binlog";
+
+#if CONFIG_BINLOG_DRAIN_RAW
+/* One entry per line as hex, decoded on the host by binlog_decode */
+static void binlog_print_entry(const binlog_entry_t *entry, void *ctx)
+{
+    const uint8_t *bytes = (const uint8_t *)entry;
+    char line[3 + 2 * sizeof(*entry) + 1] = "BL ";
+    for (size_t i = 0; i < sizeof(*entry); i++) {
+        snprintf(&line[3 + 2 * i], 3, "%02x", bytes[i]);
+    }
+    puts(line);
+}
+#else
+static void binlog_print_entry(const binlog_entry_t *entry, void *ctx)
+{
+    char text[128];
+    const char *tag = binlog_format(entry, text, sizeof(text));
+    printf("B (%" PRIu32 ") %s: %s\n", entry->time_us / 1000, tag, text);
+}
+#endif
+
+static void binlog_drain_task_fn(void *arg)
+{
+    uint32_t reported_dropped = 0;
+    while (1) {
+        /* Wake only when a ring gets its first entry, then wait so the whole burst is printed in one pass */
+        ulTaskNotifyTakeIndexed(0, pdTRUE, portMAX_DELAY);
+        vTaskDelay(pdMS_TO_TICKS(CONFIG_BINLOG_DRAIN_DELAY_MS));
+        binlog_drain(binlog_print_entry, NULL);
+        uint32_t dropped = binlog_get_dropped();
+        if (dropped != reported_dropped) {
+            ESP_LOGW(TAG, "%" PRIu32 " events dropped, ring full", dropped - reported_dropped);
+            reported_dropped = dropped;
+        }
+    }
+}
+#endif
+
+esp_err_t binlog_init(void)
+{
+#if CONFIG_BINLOG_ENABLE
+    if (binlog_drain_task) {
+        return ESP_OK;
+    }
+    TaskHandle_t task = NULL;
+    ESP_RETURN_ON_FALSE(xTaskCreate(binlog_drain_task_fn, "binlog", CONFIG_BINLOG_DRAIN_STACK_SIZE, NULL,
+                                    CONFIG_BINLOG_DRAIN_PRIORITY, &task) == pdPASS,
+                        ESP_ERR_NO_MEM, TAG, "create drain task failed");
+    binlog_drain_task = task;
+    /* Print whatever was recorded before the task existed */
+    xTaskNotifyGiveIndexed(task, 0);
+#endif
+    return ESP_OK;
+}
@@ -0,0 +1,13 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+/* Drain task, notified by the producer that finds its ring empty. NULL until binlog_init() */
+extern TaskHandle_t binlog_drain_task;
@@ -0,0 +1,115 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "sdkconfig.h"
+#include "binlog_events.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Binary log event IDs, generated from `BINLOG_EVENTS`
+ *
+ */
+typedef enum {
+#define BINLOG_EVENT_ID(name, tag, format) BINLOG_ID_##name,
+    BINLOG_EVENTS(BINLOG_EVENT_ID)
+#undef BINLOG_EVENT_ID
+    BINLOG_ID_MAX,
+} binlog_id_t;
+
+/**
+ * @brief Maximum number of arguments of one event
+ *
+ */
+#define BINLOG_MAX_ARGS 4
+
+/**
+ * @brief One recorded event, also the unit of the raw drain output
+ *
+ */
+typedef struct {
+    uint32_t time_us;                // Low 32 bits of esp_timer_get_time() when recorded
+    uint16_t id;                     // Event ID, see `binlog_id_t`
+    uint8_t core;                    // Core the event was recorded on
+    uint8_t reserved;                // Always 0
+    uint32_t args[BINLOG_MAX_ARGS];  // Raw arguments, unused ones are 0
+} binlog_entry_t;
+
+/**
+ * @brief Receives drained entries
+ *
+ */
+typedef void (*binlog_sink_t)(const binlog_entry_t *entry, void *ctx);
+
+/**
+ * @brief Record an event in the ring of the calling core
+ *
+ * Wait-free and callable from any task or ISR, including while the flash cache is disabled
+ * when `CONFIG_BINLOG_FUNC_IN_IRAM` is set. Nothing is formatted here: the entry holds the
+ * event ID and the raw arguments. If the ring is full the event is dropped and counted.
+ *
+ * Use `BINLOG()` rather than calling this directly.
+ */
+void binlog_write(binlog_id_t id, uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3);
+
+/**
+ * @brief Move all recorded entries to a sink, oldest first per core
+ *
+ * @note There must only be one caller at a time, normally the drain task
+ *
+ * @return Number of entries drained
+ */
+size_t binlog_drain(binlog_sink_t sink, void *ctx);
+
+/**
+ * @brief Number of events dropped because a ring was full, over all cores
+ *
+ */
+uint32_t binlog_get_dropped(void);
+
+/**
+ * @brief Format an entry with the format string of its event
+ *
+ * @return Tag of the event, "binlog" for an unknown ID
+ */
+const char *binlog_format(const binlog_entry_t *entry, char *buf, size_t size);
+
+/**
+ * @brief Start the low priority drain task, which prints entries shortly after they are recorded
+ *
+ * Events recorded before this call are kept in the rings and printed once the task runs.
+ *
+ * @return
+ *      - ESP_OK: Drain task started, or already running
+ *      - ESP_ERR_NO_MEM: Failed to create the drain task
+ */
+esp_err_t binlog_init(void);
+
+#define BINLOG_ARGS_(skip, a0, a1, a2, a3, ...) \
+    (uint32_t)(a0), (uint32_t)(a1), (uint32_t)(a2), (uint32_t)(a3)
+
+/**
+ * @brief Record event `name` from `BINLOG_EVENTS` with up to four integer arguments
+ *
+ * Compiles to nothing when `CONFIG_BINLOG_ENABLE` is not set.
+ */
+#if CONFIG_BINLOG_ENABLE
+#define BINLOG(name, ...) binlog_write(BINLOG_ID_##name, BINLOG_ARGS_(0, ##__VA_ARGS__, 0, 0, 0, 0))
+#else
+#define BINLOG(name, ...) ((void)0)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,28 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+/**
+ * @brief Binary log events: X(name, tag, format)
+ *
+ * The format takes up to four integer conversions, each argument is recorded as 32 bits.
+ * Only append to this list: the position of an event is its ID, and a host decoder has to be
+ * built from the same list as the firmware whose output it reads.
+ */
+#define BINLOG_EVENTS(X)                                                                          \
+    X(MOTOR_QUEUED,     "motor", "queued move %" PRIu32 ": %" PRId32 " half steps at %" PRIu32 " us/step, mode %" PRIu32) \
+    X(MOTOR_RING_FULL,  "motor", "command ring full, %" PRIu32 " overflows")                     \
+    X(MOTOR_DONE,       "motor", "move %" PRIu32 " done at %" PRId32)                            \
+    X(MOTOR_IDLE,       "motor", "ring drained, coils off at %" PRId32)                          \
+    X(CLOCK_TIME,       "clock", "current time %02" PRIu32 ":%02" PRIu32 ":%02" PRIu32)          \
+    X(CLOCK_MOVE,       "clock", "minute hand %" PRId32 " -> %" PRId32)                          \
+    X(CLOCK_MOVE_DONE,  "clock", "minute hand at %" PRId32)                                      \
+    X(CLOCK_JUMP,       "clock", "time jumped by %" PRId32 " steps, catching up")                \
+    X(CLOCK_CATCH_UP,   "clock", "catch-up %" PRId32 " -> %" PRId32 ", predicted %" PRIu32 " ms") \
+    X(CLOCK_ADJUST,     "clock", "adjusting %" PRId32 " -> %" PRId32)                           \
+    X(CLOCK_SWEEP,      "clock", "sweep phase error %" PRId32 " us, trim %" PRId32 " ppb")      \
+    X(CLOCK_RESTORE,    "clock", "hand restored at %" PRId32 ", phase %" PRIu32 ", journaled at %" PRIu32)
@@ -0,0 +1,124 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "pid_ctrl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Type of relay feedback auto-tuner handle
+ *
+ */
+typedef struct pid_autotune_t *pid_autotune_handle_t;
+
+/**
+ * @brief Tuning rule used to turn the ultimate gain and period into PID gains
+ *
+ */
+typedef enum {
+    PID_TUNE_RULE_ZIEGLER_NICHOLS, /*!< Classic Ziegler-Nichols, fast with about 25% overshoot */
+    PID_TUNE_RULE_SOME_OVERSHOOT,  /*!< Ziegler-Nichols "some overshoot" variant */
+    PID_TUNE_RULE_NO_OVERSHOOT,    /*!< Ziegler-Nichols "no overshoot" variant */
+} pid_tune_rule_t;
+
+/**
+ * @brief Relay feedback (Astrom-Hagglund) auto-tuner configuration
+ *
+ */
+typedef struct {
+    float setpoint;         // Process value the relay oscillates around
+    float relay_amplitude;  // Relay output is +/- this value
+    float hysteresis;       // Error band the relay ignores, filters measurement noise
+    float sample_period_s;  // Time between two calls of `pid_autotune_update()`
+    uint32_t settle_cycles; // Oscillation periods skipped before measuring
+    uint32_t cycles;        // Oscillation periods averaged for the result
+    uint32_t max_samples;   // Give up after this many samples
+} pid_autotune_config_t;
+
+/**
+ * @brief Result of a relay feedback experiment
+ *
+ */
+typedef struct {
+    float ultimate_gain;     // Ku, gain at which the closed loop oscillates
+    float ultimate_period_s; // Tu, period of that oscillation
+    float amplitude;         // Measured peak amplitude of the process value
+} pid_autotune_result_t;
+
+/**
+ * @brief Create a relay feedback auto-tuner
+ *
+ * @param[in] config Auto-tuner configuration
+ * @param[out] ret_tuner Returned auto-tuner handle
+ * @return
+ *      - ESP_OK: Created the auto-tuner successfully
+ *      - ESP_ERR_INVALID_ARG: Created the auto-tuner failed because of invalid argument
+ *      - ESP_ERR_NO_MEM: Created the auto-tuner failed because out of memory
+ */
+esp_err_t pid_new_autotune(const pid_autotune_config_t *config, pid_autotune_handle_t *ret_tuner);
+
+/**
+ * @brief Delete the auto-tuner
+ *
+ * @param[in] tuner Auto-tuner handle, created by `pid_new_autotune()`
+ * @return
+ *      - ESP_OK: Deleted the auto-tuner successfully
+ *      - ESP_ERR_INVALID_ARG: Deleted the auto-tuner failed because of invalid argument
+ */
+esp_err_t pid_del_autotune(pid_autotune_handle_t tuner);
+
+/**
+ * @brief Feed one process value sample and get the relay output to apply
+ *
+ * @param[in] tuner Auto-tuner handle, created by `pid_new_autotune()`
+ * @param[in] process_value Measured process value
+ * @param[out] ret_output Relay output for the next sample period, 0 once the experiment is done
+ * @param[out] ret_done Set when enough oscillation periods were measured
+ * @return
+ *      - ESP_OK: Sample processed
+ *      - ESP_ERR_INVALID_ARG: Invalid argument
+ *      - ESP_ERR_TIMEOUT: No stable oscillation within `max_samples`
+ */
+esp_err_t pid_autotune_update(pid_autotune_handle_t tuner, float process_value, float *ret_output, bool *ret_done);
+
+/**
+ * @brief Get the ultimate gain and period measured by the experiment
+ *
+ * @param[in] tuner Auto-tuner handle, created by `pid_new_autotune()`
+ * @param[out] ret_result Returned result
+ * @return
+ *      - ESP_OK: Got the result successfully
+ *      - ESP_ERR_INVALID_ARG: Invalid argument
+ *      - ESP_ERR_INVALID_STATE: The experiment has not finished yet
+ */
+esp_err_t pid_autotune_get_result(pid_autotune_handle_t tuner, pid_autotune_result_t *ret_result);
+
+/**
+ * @brief Turn an auto-tune result into gains for the discrete PID in `pid_ctrl`
+ *
+ * Only `kp`, `ki`, `kd` and `cal_type` (positional) are written, the limits are left to the caller.
+ *
+ * @param[in] result Result of the relay experiment
+ * @param[in] sample_period_s Control period the PID will run at
+ * @param[in] rule Tuning rule
+ * @param[inout] params PID parameters to fill in
+ * @return
+ *      - ESP_OK: Computed the gains successfully
+ *      - ESP_ERR_INVALID_ARG: Invalid argument
+ */
+esp_err_t pid_autotune_compute_parameters(const pid_autotune_result_t *result, float sample_period_s,
+                                          pid_tune_rule_t rule, pid_ctrl_parameter_t *params);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,118 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "pid_ctrl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Largest gain shift, gains are Q15 mantissas scaled by 2^gain_shift
+ *
+ */
+#define PID_BATCH_MAX_GAIN_SHIFT 15
+
+/**
+ * @brief Type of batched fixed point PID handle
+ *
+ */
+typedef struct pid_batch_t *pid_batch_handle_t;
+
+/**
+ * @brief Batched PID configuration
+ *
+ * Every block of a batch shares the calculation type and the gain scaling, so one call runs
+ * the same integer arithmetic over all blocks. Errors, outputs and limits are `int32_t` in
+ * any fixed point format common to the batch, Q31 for normalised signals.
+ */
+typedef struct {
+    size_t count;                  // Number of PID blocks
+    uint8_t gain_shift;            // Gain = Q15 mantissa * 2^gain_shift, 0 keeps gains in [-1, 1)
+    pid_calculate_type_t cal_type; // PID calculation type of all blocks
+} pid_batch_config_t;
+
+/**
+ * @brief Create a batch of fixed point PID blocks stored structure-of-arrays
+ *
+ * All blocks start with zero gains and state and unlimited output and integral.
+ *
+ * @param[in] config Batch configuration
+ * @param[out] ret_batch Returned batch handle
+ * @return
+ *      - ESP_OK: Created the batch successfully
+ *      - ESP_ERR_INVALID_ARG: Created the batch failed because of invalid argument
+ *      - ESP_ERR_NO_MEM: Created the batch failed because out of memory
+ */
+esp_err_t pid_new_batch(const pid_batch_config_t *config, pid_batch_handle_t *ret_batch);
+
+/**
+ * @brief Delete a batch
+ *
+ * @param[in] batch Batch handle, created by `pid_new_batch()`
+ * @return
+ *      - ESP_OK: Deleted the batch successfully
+ *      - ESP_ERR_INVALID_ARG: Deleted the batch failed because of invalid argument
+ */
+esp_err_t pid_del_batch(pid_batch_handle_t batch);
+
+/**
+ * @brief Update the parameters of one block in a batch
+ *
+ * Gains are rounded to the batch's Q15 gain format and limits to the nearest integer in the
+ * batch's signal format. `params->cal_type` must match the batch.
+ *
+ * @param[in] batch Batch handle, created by `pid_new_batch()`
+ * @param[in] index Block index
+ * @param[in] params PID parameters
+ * @return
+ *      - ESP_OK: Updated the parameters successfully
+ *      - ESP_ERR_INVALID_ARG: Index out of range, calculation type mismatch or gain not representable
+ */
+esp_err_t pid_batch_update_parameters(pid_batch_handle_t batch, size_t index, const pid_ctrl_parameter_t *params);
+
+/**
+ * @brief Clear the error history, integral and last output of every block
+ *
+ * @param[in] batch Batch handle, created by `pid_new_batch()`
+ * @return
+ *      - ESP_OK: Reset the batch successfully
+ *      - ESP_ERR_INVALID_ARG: Reset the batch failed because of invalid argument
+ */
+esp_err_t pid_batch_reset(pid_batch_handle_t batch);
+
+/**
+ * @brief Run one control period of every block in the batch
+ *
+ * @note No argument checks and no logging, safe to call from an ISR when
+ *       CONFIG_PID_CTRL_BATCH_FUNC_IN_IRAM is enabled.
+ *
+ * @param[in] batch Batch handle, created by `pid_new_batch()`
+ * @param[in] errors Input error of each block
+ * @param[out] outputs PID output of each block, must not overlap `errors`
+ */
+void pid_batch_compute(pid_batch_handle_t batch, const int32_t *errors, int32_t *outputs);
+
+/**
+ * @brief Scalar reference for `pid_batch_compute()`
+ *
+ * Runs the blocks one after another with straightforward code. The batched path must match it
+ * bit for bit.
+ *
+ * @param[in] batch Batch handle, created by `pid_new_batch()`
+ * @param[in] errors Input error of each block
+ * @param[out] outputs PID output of each block, must not overlap `errors`
+ */
+void pid_batch_compute_reference(pid_batch_handle_t batch, const int32_t *errors, int32_t *outputs);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,145 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include "esp_check.h"
+#include "esp_log.h"
+#include "pid_autotune.h"
+
+static const char *TAG = "pid_autotune";
+
+struct pid_autotune_t {
+    pid_autotune_config_t config;
+    float output;            // Current relay output
+    float peak_high;         // Highest process value in the current half period
+    float peak_low;          // Lowest process value in the current half period
+    float amplitude_sum;     // Sum of measured peak to peak amplitudes
+    uint32_t samples;        // Samples processed
+    uint32_t last_rise;      // Sample index of the last switch to the positive output
+    uint32_t period_samples; // Sum of measured periods in samples
+    uint32_t periods;        // Oscillation periods seen, including the settling ones
+    uint32_t measured;       // Periods contributing to the result
+    bool done;
+};
+
+esp_err_t pid_new_autotune(const pid_autotune_config_t *config, pid_autotune_handle_t *ret_tuner)
+{
+    ESP_RETURN_ON_FALSE(config && ret_tuner, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(config->relay_amplitude > 0 && config->hysteresis >= 0 && config->sample_period_s > 0 &&
+                        config->cycles, ESP_ERR_INVALID_ARG, TAG, "invalid relay configuration");
+
+    struct pid_autotune_t *tuner = calloc(1, sizeof(struct pid_autotune_t));
+    ESP_RETURN_ON_FALSE(tuner, ESP_ERR_NO_MEM, TAG, "no mem for auto-tuner");
+    tuner->config = *config;
+    tuner->output = config->relay_amplitude;
+    tuner->peak_high = -INFINITY;
+    tuner->peak_low = INFINITY;
+    *ret_tuner = tuner;
+    return ESP_OK;
+}
+
+esp_err_t pid_del_autotune(pid_autotune_handle_t tuner)
+{
+    ESP_RETURN_ON_FALSE(tuner, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    free(tuner);
+    return ESP_OK;
+}
+
+esp_err_t pid_autotune_update(pid_autotune_handle_t tuner, float process_value, float *ret_output, bool *ret_done)
+{
+    ESP_RETURN_ON_FALSE(tuner && ret_output && ret_done, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    const pid_autotune_config_t *config = &tuner->config;
+
+    if (tuner->done) {
+        *ret_output = 0;
+        *ret_done = true;
+        return ESP_OK;
+    }
+    if (config->max_samples && tuner->samples >= config->max_samples) {
+        *ret_output = 0;
+        *ret_done = false;
+        return ESP_ERR_TIMEOUT;
+    }
+    tuner->samples++;
+    tuner->peak_high = fmaxf(tuner->peak_high, process_value);
+    tuner->peak_low = fminf(tuner->peak_low, process_value);
+
+    /* Relay with hysteresis: switch only once the error left the band on the other side */
+    float error = config->setpoint - process_value;
+    if (tuner->output < 0 && error > config->hysteresis) {
+        tuner->output = config->relay_amplitude;
+        /* A rising switch closes one full oscillation period */
+        if (tuner->periods++ >= config->settle_cycles + 1) {
+            tuner->period_samples += tuner->samples - tuner->last_rise;
+            tuner->amplitude_sum += (tuner->peak_high - tuner->peak_low) / 2;
+            tuner->measured++;
+        }
+        tuner->last_rise = tuner->samples;
+        tuner->peak_high = -INFINITY;
+        tuner->peak_low = INFINITY;
+        if (tuner->measured >= config->cycles) {
+            tuner->done = true;
+        }
+    } else if (tuner->output > 0 && error < -config->hysteresis) {
+        tuner->output = -config->relay_amplitude;
+    }
+
+    *ret_output = tuner->done ? 0 : tuner->output;
+    *ret_done = tuner->done;
+    return ESP_OK;
+}
+
+esp_err_t pid_autotune_get_result(pid_autotune_handle_t tuner, pid_autotune_result_t *ret_result)
+{
+    ESP_RETURN_ON_FALSE(tuner && ret_result, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(tuner->done, ESP_ERR_INVALID_STATE, TAG, "auto-tune not finished");
+
+    const pid_autotune_config_t *config = &tuner->config;
+    float amplitude = tuner->amplitude_sum / tuner->measured;
+    /* Describing function of a relay with hysteresis: Ku = 4d / (pi * sqrt(a^2 - eps^2)) */
+    float effective = sqrtf(fmaxf(amplitude * amplitude - config->hysteresis * config->hysteresis, 1e-12f));
+    ret_result->ultimate_gain = 4 * config->relay_amplitude / ((float)M_PI * effective);
+    ret_result->ultimate_period_s = config->sample_period_s * tuner->period_samples / tuner->measured;
+    ret_result->amplitude = amplitude;
+    return ESP_OK;
+}
+
+esp_err_t pid_autotune_compute_parameters(const pid_autotune_result_t *result, float sample_period_s,
+                                          pid_tune_rule_t rule, pid_ctrl_parameter_t *params)
+{
+    ESP_RETURN_ON_FALSE(result && params && sample_period_s > 0 && result->ultimate_period_s > 0,
+                        ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    float ku = result->ultimate_gain;
+    float tu = result->ultimate_period_s;
+    float kp, ti, td;
+    switch (rule) {
+    case PID_TUNE_RULE_ZIEGLER_NICHOLS:
+        kp = 0.6f * ku;
+        ti = tu / 2;
+        td = tu / 8;
+        break;
+    case PID_TUNE_RULE_SOME_OVERSHOOT:
+        kp = 0.33f * ku;
+        ti = tu / 2;
+        td = tu / 3;
+        break;
+    case PID_TUNE_RULE_NO_OVERSHOOT:
+        kp = 0.2f * ku;
+        ti = tu / 2;
+        td = tu / 3;
+        break;
+    default:
+        ESP_RETURN_ON_FALSE(false, ESP_ERR_INVALID_ARG, TAG, "invalid tuning rule:%d", rule);
+    }
+
+    /* pid_calc_positional() sums raw errors and differences raw errors, so fold the period in */
+    params->kp = kp;
+    params->ki = kp * sample_period_s / ti;
+    params->kd = kp * td / sample_period_s;
+    params->cal_type = PID_CAL_TYPE_POSITIONAL;
+    return ESP_OK;
+}
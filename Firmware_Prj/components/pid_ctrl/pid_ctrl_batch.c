@@ -0,0 +1,274 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sys/param.h>
+#include "esp_attr.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include "pid_ctrl_batch.h"
+
+#if CONFIG_PID_CTRL_BATCH_FUNC_IN_IRAM
+#define PID_BATCH_ATTR IRAM_ATTR
+#else
+#define PID_BATCH_ATTR
+#endif
+
+static const char *TAG = "pid_batch";
+
+/*
+ * Structure-of-arrays storage, every array holds one entry per block. Gains are Q15 mantissas,
+ * so a product with a 33 bit error difference stays below 2^48 and the sum of the three terms
+ * fits comfortably in 64 bits.
+ */
+struct pid_batch_t {
+    size_t count;                  // Number of PID blocks
+    uint8_t shift;                 // Right shift applied to the accumulator, 15 - gain_shift
+    pid_calculate_type_t cal_type; // PID calculation type of all blocks
+    int32_t *previous_err1;        // e(k-1)
+    int32_t *previous_err2;        // e(k-2)
+    int32_t *integral_err;         // Sum of error
+    int32_t *last_output;          // PID output in last control period
+    int32_t *max_output;           // PID maximum output limitation
+    int32_t *min_output;           // PID minimum output limitation
+    int32_t *max_integral;         // PID maximum integral value limitation
+    int32_t *min_integral;         // PID minimum integral value limitation
+    int16_t *kp;                   // PID Kp mantissa
+    int16_t *ki;                   // PID Ki mantissa
+    int16_t *kd;                   // PID Kd mantissa
+};
+
+static inline int32_t sat32(int64_t value)
+{
+    return (int32_t)MAX(MIN(value, (int64_t)INT32_MAX), (int64_t)INT32_MIN);
+}
+
+/* Arithmetic shift with round half up, keeps the incremental form free of a drift bias */
+static inline int64_t round_shift(int64_t acc, uint8_t shift)
+{
+    return shift ? (acc + ((int64_t)1 << (shift - 1))) >> shift : acc;
+}
+
+static inline int32_t clamp32(int32_t value, int32_t min, int32_t max)
+{
+    return MAX(MIN(value, max), min);
+}
+
+/* Reference positional update of block `i`, same formula as `pid_calc_positional()` */
+static int32_t pid_q_positional(struct pid_batch_t *batch, size_t i, int32_t error)
+{
+    int32_t integral = sat32((int64_t)batch->integral_err[i] + error);
+    integral = clamp32(integral, batch->min_integral[i], batch->max_integral[i]);
+    batch->integral_err[i] = integral;
+
+    /* u(k) = e(k)*Kp + (e(k)-e(k-1))*Kd + integral*Ki */
+    int64_t acc = (int64_t)error * batch->kp[i] +
+                  ((int64_t)error - batch->previous_err1[i]) * batch->kd[i] +
+                  (int64_t)integral * batch->ki[i];
+    int32_t output = clamp32(sat32(round_shift(acc, batch->shift)), batch->min_output[i], batch->max_output[i]);
+
+    batch->previous_err1[i] = error;
+    return output;
+}
+
+/* Reference incremental update of block `i`, same formula as `pid_calc_incremental()` */
+static int32_t pid_q_incremental(struct pid_batch_t *batch, size_t i, int32_t error)
+{
+    int64_t e1 = batch->previous_err1[i];
+    int64_t e2 = batch->previous_err2[i];
+
+    /* du(k) = (e(k)-e(k-1))*Kp + (e(k)-2*e(k-1)+e(k-2))*Kd + e(k)*Ki */
+    int64_t acc = (error - e1) * batch->kp[i] +
+                  (error - 2 * e1 + e2) * batch->kd[i] +
+                  (int64_t)error * batch->ki[i];
+    /* u(k) = du(k) + u(k-1) */
+    int32_t output = sat32((round_shift(acc, batch->shift)) + batch->last_output[i]);
+    output = clamp32(output, batch->min_output[i], batch->max_output[i]);
+
+    batch->previous_err2[i] = batch->previous_err1[i];
+    batch->previous_err1[i] = error;
+    batch->last_output[i] = output;
+    return output;
+}
+
+void pid_batch_compute_reference(pid_batch_handle_t batch, const int32_t *errors, int32_t *outputs)
+{
+    for (size_t i = 0; i < batch->count; i++) {
+        if (batch->cal_type == PID_CAL_TYPE_POSITIONAL) {
+            outputs[i] = pid_q_positional(batch, i, errors[i]);
+        } else {
+            outputs[i] = pid_q_incremental(batch, i, errors[i]);
+        }
+    }
+}
+
+/*
+ * Batched paths: the calculation type is resolved once per call and every loop runs over plain
+ * arrays through restrict pointers with branch free clamping, so the compiler can keep the
+ * state in registers, unroll and vectorise where the target has 64 bit lanes.
+ */
+static void PID_BATCH_ATTR pid_batch_positional(struct pid_batch_t *batch, const int32_t *restrict errors,
+                                                int32_t *restrict outputs)
+{
+    const size_t count = batch->count;
+    const uint8_t shift = batch->shift;
+    const int16_t *restrict kp = batch->kp;
+    const int16_t *restrict ki = batch->ki;
+    const int16_t *restrict kd = batch->kd;
+    const int32_t *restrict max_output = batch->max_output;
+    const int32_t *restrict min_output = batch->min_output;
+    const int32_t *restrict max_integral = batch->max_integral;
+    const int32_t *restrict min_integral = batch->min_integral;
+    int32_t *restrict e1 = batch->previous_err1;
+    int32_t *restrict integral = batch->integral_err;
+
+    for (size_t i = 0; i < count; i++) {
+        int32_t error = errors[i];
+        int32_t sum = clamp32(sat32((int64_t)integral[i] + error), min_integral[i], max_integral[i]);
+        int64_t acc = (int64_t)error * kp[i] + ((int64_t)error - e1[i]) * kd[i] + (int64_t)sum * ki[i];
+        integral[i] = sum;
+        e1[i] = error;
+        outputs[i] = clamp32(sat32(round_shift(acc, shift)), min_output[i], max_output[i]);
+    }
+}
+
+static void PID_BATCH_ATTR pid_batch_incremental(struct pid_batch_t *batch, const int32_t *restrict errors,
+                                                 int32_t *restrict outputs)
+{
+    const size_t count = batch->count;
+    const uint8_t shift = batch->shift;
+    const int16_t *restrict kp = batch->kp;
+    const int16_t *restrict ki = batch->ki;
+    const int16_t *restrict kd = batch->kd;
+    const int32_t *restrict max_output = batch->max_output;
+    const int32_t *restrict min_output = batch->min_output;
+    int32_t *restrict e1 = batch->previous_err1;
+    int32_t *restrict e2 = batch->previous_err2;
+    int32_t *restrict last = batch->last_output;
+
+    for (size_t i = 0; i < count; i++) {
+        int64_t error = errors[i];
+        int64_t prev1 = e1[i];
+        int64_t acc = (error - prev1) * kp[i] + (error - 2 * prev1 + e2[i]) * kd[i] + error * ki[i];
+        int32_t output = clamp32(sat32((round_shift(acc, shift)) + last[i]), min_output[i], max_output[i]);
+        e2[i] = (int32_t)prev1;
+        e1[i] = (int32_t)error;
+        last[i] = output;
+        outputs[i] = output;
+    }
+}
+
+void PID_BATCH_ATTR pid_batch_compute(pid_batch_handle_t batch, const int32_t *errors, int32_t *outputs)
+{
+    if (batch->cal_type == PID_CAL_TYPE_POSITIONAL) {
+        pid_batch_positional(batch, errors, outputs);
+    } else {
+        pid_batch_incremental(batch, errors, outputs);
+    }
+}
+
+esp_err_t pid_new_batch(const pid_batch_config_t *config, pid_batch_handle_t *ret_batch)
+{
+    ESP_RETURN_ON_FALSE(config && ret_batch && config->count, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(config->gain_shift <= PID_BATCH_MAX_GAIN_SHIFT, ESP_ERR_INVALID_ARG, TAG,
+                        "invalid gain shift:%d", config->gain_shift);
+    ESP_RETURN_ON_FALSE(config->cal_type == PID_CAL_TYPE_INCREMENTAL || config->cal_type == PID_CAL_TYPE_POSITIONAL,
+                        ESP_ERR_INVALID_ARG, TAG, "invalid PID calculation type:%d", config->cal_type);
+
+    /* One allocation: header, eight int32 arrays, then three int16 arrays */
+    size_t count = config->count;
+    size_t size = sizeof(struct pid_batch_t) + count * (8 * sizeof(int32_t) + 3 * sizeof(int16_t));
+    struct pid_batch_t *batch = calloc(1, size);
+    ESP_RETURN_ON_FALSE(batch, ESP_ERR_NO_MEM, TAG, "no mem for PID batch");
+
+    int32_t *words = (int32_t *)(batch + 1);
+    batch->previous_err1 = words;
+    batch->previous_err2 = words + count;
+    batch->integral_err = words + 2 * count;
+    batch->last_output = words + 3 * count;
+    batch->max_output = words + 4 * count;
+    batch->min_output = words + 5 * count;
+    batch->max_integral = words + 6 * count;
+    batch->min_integral = words + 7 * count;
+    int16_t *halves = (int16_t *)(words + 8 * count);
+    batch->kp = halves;
+    batch->ki = halves + count;
+    batch->kd = halves + 2 * count;
+
+    batch->count = count;
+    batch->shift = 15 - config->gain_shift;
+    batch->cal_type = config->cal_type;
+    for (size_t i = 0; i < count; i++) {
+        batch->max_output[i] = INT32_MAX;
+        batch->min_output[i] = INT32_MIN;
+        batch->max_integral[i] = INT32_MAX;
+        batch->min_integral[i] = INT32_MIN;
+    }
+    *ret_batch = batch;
+    return ESP_OK;
+}
+
+esp_err_t pid_del_batch(pid_batch_handle_t batch)
+{
+    ESP_RETURN_ON_FALSE(batch, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    free(batch);
+    return ESP_OK;
+}
+
+/* Round a float to the batch's integer format, saturating at the int32 range */
+static int32_t pid_batch_round(float value)
+{
+    if (value >= (float)INT32_MAX) {
+        return INT32_MAX;
+    }
+    if (value <= (float)INT32_MIN) {
+        return INT32_MIN;
+    }
+    return (int32_t)lroundf(value);
+}
+
+/* Convert a gain to a Q15 mantissa under the batch's gain shift */
+static bool pid_batch_gain(const struct pid_batch_t *batch, float gain, int16_t *ret_gain)
+{
+    float mantissa = roundf(ldexpf(gain, batch->shift));
+    if (mantissa > INT16_MAX || mantissa < INT16_MIN) {
+        return false;
+    }
+    *ret_gain = (int16_t)mantissa;
+    return true;
+}
+
+esp_err_t pid_batch_update_parameters(pid_batch_handle_t batch, size_t index, const pid_ctrl_parameter_t *params)
+{
+    ESP_RETURN_ON_FALSE(batch && params && index < batch->count, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(params->cal_type == batch->cal_type, ESP_ERR_INVALID_ARG, TAG,
+                        "calculation type %d does not match the batch", params->cal_type);
+    int16_t kp, ki, kd;
+    ESP_RETURN_ON_FALSE(pid_batch_gain(batch, params->kp, &kp) && pid_batch_gain(batch, params->ki, &ki) &&
+                        pid_batch_gain(batch, params->kd, &kd), ESP_ERR_INVALID_ARG, TAG,
+                        "gain out of range for gain shift %d", 15 - batch->shift);
+    batch->kp[index] = kp;
+    batch->ki[index] = ki;
+    batch->kd[index] = kd;
+    batch->max_output[index] = pid_batch_round(params->max_output);
+    batch->min_output[index] = pid_batch_round(params->min_output);
+    batch->max_integral[index] = pid_batch_round(params->max_integral);
+    batch->min_integral[index] = pid_batch_round(params->min_integral);
+    return ESP_OK;
+}
+
+esp_err_t pid_batch_reset(pid_batch_handle_t batch)
+{
+    ESP_RETURN_ON_FALSE(batch, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    memset(batch->previous_err1, 0, batch->count * sizeof(int32_t));
+    memset(batch->previous_err2, 0, batch->count * sizeof(int32_t));
+    memset(batch->integral_err, 0, batch->count * sizeof(int32_t));
+    memset(batch->last_output, 0, batch->count * sizeof(int32_t));
+    return ESP_OK;
+}
@@ -0,0 +1,141 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Layout version stored in every record, records of another version are ignored
+ *
+ */
+#define POS_JOURNAL_VERSION 1
+
+/**
+ * @brief Maximum number of NVS keys the journal rotates through
+ *
+ */
+#define POS_JOURNAL_MAX_SLOTS 16
+
+/**
+ * @brief Where the hand was when the record was appended
+ *
+ */
+typedef struct {
+    uint32_t seq;       // Increments with every commit, the newest valid record wins
+    int32_t position;   // Absolute position in half steps
+    uint32_t timestamp; // Wall clock time in Unix seconds when the hand got there
+    uint8_t step_index; // Phase table index the coils were last energized at
+    uint8_t version;    // POS_JOURNAL_VERSION
+    uint16_t crc;       // CRC-16/CCITT of the bytes before it
+} pos_journal_record_t;
+
+/**
+ * @brief Journal configuration
+ *
+ */
+typedef struct {
+    const char *nvs_namespace; // NVS namespace holding the slots, opened read-write
+    uint8_t slots;             // Number of keys written in turn, at least 2
+    uint32_t min_interval_ms;  // Shortest time between two commits, appends in between are coalesced
+} pos_journal_config_t;
+
+/**
+ * @brief Journal configuration from Kconfig
+ *
+ */
+#define POS_JOURNAL_DEFAULT_CONFIG()                                 \
+    {                                                                \
+        .nvs_namespace = "pos_journal",                              \
+        .slots = CONFIG_POS_JOURNAL_SLOTS,                           \
+        .min_interval_ms = CONFIG_POS_JOURNAL_MIN_INTERVAL_S * 1000, \
+    }
+
+/**
+ * @brief Journal statistics
+ *
+ */
+typedef struct {
+    uint32_t commits;   // Records written to NVS
+    uint32_t coalesced; // Appends overwritten by a later one before they were committed
+    uint32_t failures;  // Commits that NVS rejected
+} pos_journal_stats_t;
+
+typedef struct pos_journal_t *pos_journal_handle_t;
+
+/**
+ * @brief Open the journal and recover the newest valid record
+ *
+ * Every slot is read once and checked against its CRC, so recovery costs a few NVS lookups and
+ * does not depend on how long the journal has been running. NVS must be initialized.
+ *
+ * @return
+ *      - ESP_OK: Journal opened, with or without a record
+ *      - ESP_ERR_INVALID_ARG: NULL argument or slot count out of range
+ *      - ESP_ERR_NO_MEM: Out of memory
+ *      - Others: NVS could not be opened
+ */
+esp_err_t pos_journal_new(const pos_journal_config_t *config, pos_journal_handle_t *ret_journal);
+
+/**
+ * @brief Commit what is pending and close the journal
+ *
+ */
+esp_err_t pos_journal_del(pos_journal_handle_t journal);
+
+/**
+ * @brief Newest record committed before this boot or since
+ *
+ * @return
+ *      - ESP_OK: Record copied
+ *      - ESP_ERR_INVALID_ARG: NULL argument
+ *      - ESP_ERR_NOT_FOUND: Journal is empty or no slot passed the CRC check
+ */
+esp_err_t pos_journal_recover(pos_journal_handle_t journal, pos_journal_record_t *ret_record);
+
+/**
+ * @brief Record where the hand stopped
+ *
+ * Commits right away unless the previous commit was less than `min_interval_ms` ago, in which
+ * case the record stays pending: a later append replaces it, and a one-shot timer commits it
+ * `min_interval_ms` after the previous commit unless `pos_journal_flush()` does so first.
+ * Appending the position the journal already holds writes nothing.
+ *
+ * @return
+ *      - ESP_OK: Committed, pending or unchanged
+ *      - ESP_ERR_INVALID_ARG: NULL journal
+ *      - Others: NVS write failed or the deadline timer could not be armed, the record stays pending
+ */
+esp_err_t pos_journal_append(pos_journal_handle_t journal, int32_t position, uint8_t step_index, uint32_t timestamp);
+
+/**
+ * @brief Commit the pending record now, regardless of `min_interval_ms`
+ *
+ */
+esp_err_t pos_journal_flush(pos_journal_handle_t journal);
+
+/**
+ * @brief Get journal statistics
+ *
+ */
+esp_err_t pos_journal_get_stats(pos_journal_handle_t journal, pos_journal_stats_t *stats);
+
+/**
+ * @brief CRC-16/CCITT (polynomial 0x1021, initial value 0xFFFF)
+ *
+ */
+uint16_t pos_journal_crc16(const void *data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,237 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "esp_check.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "nvs.h"
+#include "pos_journal.h"
+
+static const char *TAG = "pos_journal";
+
+/*
+ * Every commit goes to the next of `slots` keys, so a commit torn by a power cut only ever
+ * damages the newest record and the previous one is still there to fall back to. NVS itself
+ * appends entries and spreads page erases, the journal bounds how often it is asked to.
+ * A record held back by `min_interval_ms` is committed by a one-shot timer once the interval has
+ * passed, so it never waits for the next append.
+ */
+struct pos_journal_t {
+    nvs_handle_t nvs;
+    uint8_t slots;
+    uint32_t min_interval_ms;
+    bool has_last;                // `last` holds a committed or recovered record
+    bool pending;                 // `next` has not been committed yet
+    pos_journal_record_t last;    // Newest record in NVS
+    pos_journal_record_t next;    // Record waiting for its commit, `seq` and `crc` not filled in
+    int64_t last_commit_us;       // esp_timer time of the last commit
+    esp_timer_handle_t deadline;  // Commits `next` at last_commit_us + min_interval_ms
+    SemaphoreHandle_t lock;       // Appends and the deadline timer task commit in turn
+    pos_journal_stats_t stats;
+};
+
+uint16_t pos_journal_crc16(const void *data, size_t len)
+{
+    const uint8_t *bytes = data;
+    uint16_t crc = 0xFFFF;
+    while (len--) {
+        crc ^= (uint16_t)(*bytes++) << 8;
+        for (int i = 0; i < 8; i++) {
+            crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static uint16_t pos_journal_record_crc(const pos_journal_record_t *record)
+{
+    return pos_journal_crc16(record, offsetof(pos_journal_record_t, crc));
+}
+
+static void pos_journal_slot_key(char *key, size_t size, uint32_t slot)
+{
+    snprintf(key, size, "pos%" PRIu32, slot);
+}
+
+/* Read every slot and keep the valid record with the newest sequence number */
+static void pos_journal_scan(struct pos_journal_t *journal)
+{
+    for (uint32_t slot = 0; slot < journal->slots; slot++) {
+        char key[8];
+        pos_journal_record_t record;
+        size_t len = sizeof(record);
+        pos_journal_slot_key(key, sizeof(key), slot);
+        if (nvs_get_blob(journal->nvs, key, &record, &len) != ESP_OK || len != sizeof(record)) {
+            continue;
+        }
+        if (record.version != POS_JOURNAL_VERSION || record.crc != pos_journal_record_crc(&record)) {
+            ESP_LOGW(TAG, "slot %" PRIu32 " corrupted, ignored", slot);
+            continue;
+        }
+        // Sequence numbers wrap, compare their distance instead of their values
+        if (!journal->has_last || (int32_t)(record.seq - journal->last.seq) > 0) {
+            journal->last = record;
+            journal->has_last = true;
+        }
+    }
+}
+
+static esp_err_t pos_journal_commit(struct pos_journal_t *journal)
+{
+    pos_journal_record_t record = journal->next;
+    record.seq = journal->has_last ? journal->last.seq + 1 : 0;
+    record.version = POS_JOURNAL_VERSION;
+    record.crc = pos_journal_record_crc(&record);
+
+    char key[8];
+    pos_journal_slot_key(key, sizeof(key), record.seq % journal->slots);
+    esp_err_t ret = nvs_set_blob(journal->nvs, key, &record, sizeof(record));
+    if (ret == ESP_OK) {
+        ret = nvs_commit(journal->nvs);
+    }
+    if (ret != ESP_OK) {
+        journal->stats.failures++;
+        ESP_LOGW(TAG, "commit failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    journal->last = record;
+    journal->has_last = true;
+    journal->pending = false;
+    journal->last_commit_us = esp_timer_get_time();
+    journal->stats.commits++;
+    return ESP_OK;
+}
+
+static void pos_journal_on_deadline(void *arg)
+{
+    struct pos_journal_t *journal = arg;
+    xSemaphoreTake(journal->lock, portMAX_DELAY);
+    if (journal->pending) {
+        pos_journal_commit(journal);
+    }
+    xSemaphoreGive(journal->lock);
+}
+
+esp_err_t pos_journal_new(const pos_journal_config_t *config, pos_journal_handle_t *ret_journal)
+{
+    ESP_RETURN_ON_FALSE(config && config->nvs_namespace && ret_journal, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(config->slots >= 2 && config->slots <= POS_JOURNAL_MAX_SLOTS, ESP_ERR_INVALID_ARG, TAG,
+                        "slots out of range");
+    struct pos_journal_t *journal = calloc(1, sizeof(struct pos_journal_t));
+    ESP_RETURN_ON_FALSE(journal, ESP_ERR_NO_MEM, TAG, "no mem for journal");
+
+    esp_err_t ret = ESP_OK;
+    journal->lock = xSemaphoreCreateMutex();
+    ESP_GOTO_ON_FALSE(journal->lock, ESP_ERR_NO_MEM, err, TAG, "no mem for lock");
+    const esp_timer_create_args_t timer_args = {
+        .callback = pos_journal_on_deadline,
+        .arg = journal,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "pos_journal",
+    };
+    ESP_GOTO_ON_ERROR(esp_timer_create(&timer_args, &journal->deadline), err, TAG, "create deadline timer failed");
+    ESP_GOTO_ON_ERROR(nvs_open(config->nvs_namespace, NVS_READWRITE, &journal->nvs), err, TAG,
+                      "open namespace %s failed", config->nvs_namespace);
+    journal->slots = config->slots;
+    journal->min_interval_ms = config->min_interval_ms;
+
+    int64_t start_us = esp_timer_get_time();
+    pos_journal_scan(journal);
+    if (journal->has_last) {
+        ESP_LOGI(TAG, "recovered #%" PRIu32 ": position %" PRId32 ", phase %u in %" PRId64 " us", journal->last.seq,
+                 journal->last.position, journal->last.step_index, esp_timer_get_time() - start_us);
+    }
+    *ret_journal = journal;
+    return ESP_OK;
+
+err:
+    if (journal->deadline) {
+        esp_timer_delete(journal->deadline);
+    }
+    if (journal->lock) {
+        vSemaphoreDelete(journal->lock);
+    }
+    free(journal);
+    return ret;
+}
+
+esp_err_t pos_journal_del(pos_journal_handle_t journal)
+{
+    ESP_RETURN_ON_FALSE(journal, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    pos_journal_flush(journal);
+    esp_timer_stop(journal->deadline);
+    esp_timer_delete(journal->deadline);
+    nvs_close(journal->nvs);
+    vSemaphoreDelete(journal->lock);
+    free(journal);
+    return ESP_OK;
+}
+
+esp_err_t pos_journal_recover(pos_journal_handle_t journal, pos_journal_record_t *ret_record)
+{
+    ESP_RETURN_ON_FALSE(journal && ret_record, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    if (!journal->has_last) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    *ret_record = journal->last;
+    return ESP_OK;
+}
+
+esp_err_t pos_journal_append(pos_journal_handle_t journal, int32_t position, uint8_t step_index, uint32_t timestamp)
+{
+    ESP_RETURN_ON_FALSE(journal, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    esp_err_t ret = ESP_OK;
+    xSemaphoreTake(journal->lock, portMAX_DELAY);
+    if (journal->pending) {
+        journal->stats.coalesced++;
+    } else if (journal->has_last && journal->last.position == position && journal->last.step_index == step_index) {
+        goto out;
+    }
+    journal->next = (pos_journal_record_t) {
+        .position = position,
+        .timestamp = timestamp,
+        .step_index = step_index,
+    };
+    journal->pending = true;
+
+    int64_t wait_us = journal->last_commit_us + (int64_t)journal->min_interval_ms * 1000 - esp_timer_get_time();
+    if (journal->stats.commits && wait_us > 0) {
+        // Rearm in case an earlier deadline commit failed and left the timer idle
+        esp_timer_stop(journal->deadline);
+        ret = esp_timer_start_once(journal->deadline, (uint64_t)wait_us);
+    } else {
+        ret = pos_journal_commit(journal);
+    }
+out:
+    xSemaphoreGive(journal->lock);
+    return ret;
+}
+
+esp_err_t pos_journal_flush(pos_journal_handle_t journal)
+{
+    ESP_RETURN_ON_FALSE(journal, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    xSemaphoreTake(journal->lock, portMAX_DELAY);
+    esp_err_t ret = journal->pending ? pos_journal_commit(journal) : ESP_OK;
+    if (!journal->pending) {
+        esp_timer_stop(journal->deadline);
+    }
+    xSemaphoreGive(journal->lock);
+    return ret;
+}
+
+esp_err_t pos_journal_get_stats(pos_journal_handle_t journal, pos_journal_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(journal && stats, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    *stats = journal->stats;
+    return ESP_OK;
+}
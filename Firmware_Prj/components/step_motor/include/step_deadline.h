@@ -0,0 +1,141 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Number of deadlines the heap can hold, one per motor sharing a timer
+ *
+ */
+#ifndef STEP_DEADLINE_DEPTH
+#define STEP_DEADLINE_DEPTH 8
+#endif
+
+/**
+ * @brief Next step time of one motor
+ *
+ */
+typedef struct {
+    uint64_t deadline; // Timer count at which the motor is due
+    void *owner;       // Motor the deadline belongs to, opaque to the heap
+} step_deadline_t;
+
+/**
+ * @brief Binary min-heap of step deadlines, earliest first
+ *
+ * With at most a handful of motors the heap is a few dozen bytes and every operation is a couple
+ * of compares, cheap enough for the step ISR. The heap does no locking, the caller serializes it.
+ */
+typedef struct {
+    step_deadline_t items[STEP_DEADLINE_DEPTH]; // Heap ordered storage
+    uint8_t count;                              // Number of valid items
+} step_deadline_heap_t;
+
+/**
+ * @brief Remove the deadline of `owner`, if any
+ *
+ * @return true if a deadline was removed
+ */
+bool step_deadline_remove(step_deadline_heap_t *heap, const void *owner);
+
+/**
+ * @brief Earliest deadline, NULL if the heap is empty
+ *
+ */
+static inline const step_deadline_t *step_deadline_top(const step_deadline_heap_t *heap)
+{
+    return heap->count ? &heap->items[0] : NULL;
+}
+
+/**
+ * @brief Move the item at `index` towards the root until its parent is not later
+ *
+ */
+static inline void step_deadline_sift_up(step_deadline_heap_t *heap, unsigned index)
+{
+    step_deadline_t item = heap->items[index];
+    while (index) {
+        unsigned parent = (index - 1) / 2;
+        if (heap->items[parent].deadline <= item.deadline) {
+            break;
+        }
+        heap->items[index] = heap->items[parent];
+        index = parent;
+    }
+    heap->items[index] = item;
+}
+
+/**
+ * @brief Move the item at `index` towards the leaves until no child is earlier
+ *
+ */
+static inline void step_deadline_sift_down(step_deadline_heap_t *heap, unsigned index)
+{
+    step_deadline_t item = heap->items[index];
+    for (;;) {
+        unsigned child = index * 2 + 1;
+        if (child >= heap->count) {
+            break;
+        }
+        if (child + 1 < heap->count && heap->items[child + 1].deadline < heap->items[child].deadline) {
+            child++;
+        }
+        if (item.deadline <= heap->items[child].deadline) {
+            break;
+        }
+        heap->items[index] = heap->items[child];
+        index = child;
+    }
+    heap->items[index] = item;
+}
+
+/**
+ * @brief Insert a deadline
+ *
+ * @return false if the heap is full
+ */
+static inline bool step_deadline_push(step_deadline_heap_t *heap, uint64_t deadline, void *owner)
+{
+    if (heap->count >= STEP_DEADLINE_DEPTH) {
+        return false;
+    }
+    heap->items[heap->count] = (step_deadline_t) {
+        .deadline = deadline,
+        .owner = owner,
+    };
+    step_deadline_sift_up(heap, heap->count++);
+    return true;
+}
+
+/**
+ * @brief Pop the earliest deadline if it is not later than `now`
+ *
+ * @return false if the heap is empty or the earliest deadline is still in the future
+ */
+static inline bool step_deadline_pop_due(step_deadline_heap_t *heap, uint64_t now, step_deadline_t *out)
+{
+    if (!heap->count || heap->items[0].deadline > now) {
+        return false;
+    }
+    *out = heap->items[0];
+    heap->items[0] = heap->items[--heap->count];
+    if (heap->count) {
+        step_deadline_sift_down(heap, 0);
+    }
+    return true;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -7,50 +7,202 @@
 #ifndef STEP_MOTOR_H
 #define STEP_MOTOR_H
 
+#include <stdatomic.h>
 #include <stdbool.h>
 #include "time.h"
 
-#include "driver/dedic_gpio.h"
+#include "sdkconfig.h"
 #include "driver/gptimer.h"
 #include "freertos/FreeRTOS.h"
-#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "step_deadline.h"
+#include "step_output.h"
+#include "step_planner.h"
+#include "step_profile.h"
+
+// 每个运动命令的完成句柄（序号），0 表示无效
+typedef uint32_t stepper_move_handle_t;
+
+// 运动完成时通知提交任务所用的任务通知下标
+#define STEPPER_NOTIFY_INDEX 1
+
+// 相对转动的角度单位为角秒，整分钟的表盘角度都是整数
+#define STEPPER_ARCSEC_PER_REV 1296000
+
+// 驱动方式，位置始终以半步计
+typedef enum
+{
+    STEPPER_DRIVE_HALF,  // 八拍半步，单双相交替，每圈 4096 步
+    STEPPER_DRIVE_FULL,  // 四拍双相整步，转矩更大，中断频率减半，每圈 2048 步
+    STEPPER_DRIVE_WAVE,  // 四拍单相整步，功耗最低，每圈 2048 步
+} stepper_drive_mode_t;
+
+// 共用一个定时器的电机数上限
+#define STEPPER_GROUP_MAX_MOTORS STEP_DEADLINE_DEPTH
+
+// 单个电机的输出配置，驱动接管其中的输出后端，随电机一起删除
+typedef struct stepper_config
+{
+    int phase_gpios[4];          // 四路线圈的 GPIO，依次对应相位的第 0-3 位
+    step_output_t* output;       // 步进中断逐步输出用的后端，NULL 时按 phase_gpios 创建专用 GPIO 后端
+    step_output_t* playback;     // 可选的整段回放后端，NULL 表示所有运动都由步进中断输出
+    uint32_t playback_min_rate;  // 静止起步且中断频率不低于该值（步/秒）的运动交给回放后端
+} stepper_config_t;
+
+// 原理图上的默认接法：GPIO35-38 接 ULN2003 的 IN1-IN4
+#define STEPPER_DEFAULT_CONFIG()         \
+    {                                    \
+        .phase_gpios = {35, 36, 37, 38}, \
+    }
+
+// 电机组：组内所有电机共用一个 gptimer，由一个中断按截止时间先后服务
+typedef struct stepper_group stepper_group_t;
+
+// ISR 统计直方图的格数
+#define STEPPER_ISR_HIST_BUCKETS 16
+// 保留最近多少次服务的执行时间，用于求中位数和分位数
+#define STEPPER_ISR_CYCLE_SAMPLES 128
+
+typedef struct stepper_isr_stats
+{
+    uint32_t isr_count;        // 步进中断次数
+    uint32_t late_alarms;      // 进入延迟超过 CONFIG_STEP_MOTOR_ISR_LATE_US 的次数
+    uint32_t missed_alarms;    // 下一步在本次进入时就已过期的次数，该步从本次起重新计时，错过的间隔不补走
+    uint32_t max_cycles;       // 最长执行时间（CPU 周期），从进入组定时器中断到重装闹钟
+    uint32_t max_latency_us;   // 最大闹钟到进入延迟
+    uint64_t total_cycles;     // 累计执行时间，用于求平均
+    uint32_t cycles_hist[STEPPER_ISR_HIST_BUCKETS];  // 执行时间，第 i 格为 [2^i, 2^(i+1)) 周期，最后一格含更长的
+    uint32_t latency_hist[STEPPER_ISR_HIST_BUCKETS]; // 闹钟到进入延迟，每格 1us，最后一格含更长的
+} stepper_isr_stats_t;
 
 typedef struct stepper_cmd
 {
     int steps;
     bool dir_cw;
     int speed_us;
+    stepper_drive_mode_t mode;  // 驱动方式，steps 与 speed_us 以该方式的步为单位
+    stepper_move_handle_t seq;  // 由 stepper_enqueue() 分配
+    TaskHandle_t owner;         // 完成时通知的任务
 } stepper_cmd_t;
 
+typedef struct motor_control motor_control_t;
+
+// 运动完成回调，在 ISR 中执行
+typedef void (*stepper_done_cb_t)(motor_control_t* motor_control, stepper_move_handle_t move, void* arg);
+
 typedef struct motor_motion
 {
     int total_steps;
     int executed_steps;
-    int step_index;
+    int step_index;         // 当前通电的相位在半步相位表中的下标
     bool direction_cw;
-    int absolute_position; // 绝对位置记录
+    int absolute_position; // 绝对位置记录（半步）
+    uint32_t half_steps_left; // 当前段剩余的半步数
+    uint8_t stride;           // 当前段每步的半步数
+    uint8_t parity;           // 当前段整步所在相位的奇偶
+    step_profile_t profile; // 当前运动的加减速曲线
+    uint16_t ramp_level;    // 当前所处的加速表档位
+    stepper_move_handle_t seq; // 当前段的完成句柄
+    TaskHandle_t owner;        // 当前段完成时通知的任务
+    bool loaded;               // 当前段尚未记为完成
+    bool exit_planned;         // 已按环形缓冲中的后继段抬高出口速度
+    atomic_bool running;       // 由提交任务置位、ISR 在缓冲取空后清零
+    bool playback;             // 当前段由回放后端整段输出，期间没有步进中断
+    bool sweep;                // 扫动模式：不取环形缓冲，按小数间隔逐个半步走
+    bool sweep_coils_on;       // 扫动中线圈仍在保持，下一次闹钟断电
+    uint64_t sweep_last_step;  // 扫动上一步的闹钟计数值
+    uint64_t sweep_next_q16;   // 扫动下一步的闹钟计数值，Q16 定点，小数部分逐步累加
+    volatile uint32_t completed_moves; // 已完成的运动段计数
+    volatile uint32_t emitted_steps;   // 已输出的半步数，包括回放和扫动
 } motor_motion_t;
 
-typedef struct motor_control
+struct motor_control
 {
     motor_motion_t motion;
-    dedic_gpio_bundle_handle_t motor_dedic_gpio_bundle;
-    gptimer_handle_t motor_gptimer;
+    step_output_t* output;      // 逐步输出的后端，步进中断中写相位
+    step_output_t* playback;    // 整段回放的后端，没有时为 NULL
+    uint32_t playback_min_rate; // 交给回放后端的最低中断频率（步/秒）
+    step_wave_item_t* wave;     // 渲染好的回放波形，回放结束前由后端读取
+    size_t wave_len;
+    int playback_delta;         // 回放走完后的位置变化（半步）
+    int64_t playback_start_us;  // 回放开始的时间，中途停止时据此推算已走的步数
+    volatile uint32_t playback_moves; // 由回放后端完成的运动段数
+    stepper_group_t* group; // 所属电机组，定时器由组内电机共用
+    uint32_t sched_epoch;   // 每次启动或停止加一，作废中断正在服务的旧截止时间，由组自旋锁保护
     void* motor_spinlock;
-    QueueHandle_t motor_cmd_queue;
-}motor_control_t;
+    SemaphoreHandle_t motor_mutex; // 串行化提交命令的任务，保证环形缓冲只有一个生产者
+    step_ramp_t ramp; // 预计算的加速表，ISR 只做查表
+    step_planner_t planner; // 运动段环形缓冲，提交任务写入，步进 ISR 在当前段结束时直接取出
+    int plan_index;         // 已规划的运动全部走完后的相位下标，用于整步对齐
+    int plan_position;      // 已规划的运动全部走完后的绝对位置（半步）
+    int32_t arc_carry;      // 相对转动尚未走出的小数步，单位为 1/STEPPER_ARCSEC_PER_REV 半步
+    uint64_t sweep_interval_q16; // 扫动的步进间隔（微秒，Q16 定点），运行中可修改
+    stepper_drive_mode_t drive_mode; // 未指定驱动方式的接口使用的默认方式
+    volatile stepper_move_handle_t next_seq;      // 上一个分配的完成句柄
+    volatile stepper_move_handle_t completed_seq; // 最近完成的完成句柄
+    stepper_done_cb_t done_cb;
+    void* done_cb_arg;
+#if CONFIG_STEP_MOTOR_ISR_STATS
+    stepper_isr_stats_t isr_stats; // 步进中断耗时与抖动统计，由 ISR 在 motor_spinlock 内写入
+    uint32_t isr_cycles[STEPPER_ISR_CYCLE_SAMPLES]; // 服务过该电机的最近各次中断的执行时间，按 isr_count 循环写入
+#endif
+};
 
+// 电机组与多电机：组在第一个电机启动时使能定时器，所有电机停下后关闭
+esp_err_t stepper_group_new(stepper_group_t** ret_group);
+esp_err_t stepper_group_del(stepper_group_t* group);
+motor_control_t* stepper_driver_new(stepper_group_t* group, const stepper_config_t* config);
+void stepper_driver_deinit(motor_control_t* motor_control);
 
+// 按默认接法在默认电机组上创建电机
 motor_control_t* stepper_driver_init(void);
-void stepper_rotate_angle(const motor_control_t* motor_control, float degree, bool cw, float rpm);
+stepper_move_handle_t stepper_rotate_angle(motor_control_t* motor_control, float degree, bool cw, float rpm);
+stepper_move_handle_t stepper_rotate_angle_mode(motor_control_t* motor_control, float degree, bool cw, float rpm,
+                                                stepper_drive_mode_t mode);
+stepper_move_handle_t stepper_rotate_arcsec(motor_control_t* motor_control, int32_t arcsec, bool cw, uint32_t rpm,
+                                            stepper_drive_mode_t mode);
+stepper_move_handle_t stepper_move_to(motor_control_t* motor_control, int32_t target, uint32_t rpm,
+                                      stepper_drive_mode_t mode);
+uint32_t stepper_max_rpm(const motor_control_t* motor_control);
+uint64_t stepper_move_duration_us(const motor_control_t* motor_control, uint32_t half_steps, uint32_t rpm,
+                                  stepper_drive_mode_t mode);
+
+// 扫动模式：定时器按 Q16 小数间隔逐个半步连续走，每步后线圈只保持很短时间。
+// 只能从静止开始，扫动期间拒绝其他运动，用 stepper_stop() 结束
+esp_err_t stepper_sweep_start(motor_control_t* motor_control, uint64_t interval_q16, uint32_t first_delay_us,
+                              bool cw);
+esp_err_t stepper_sweep_set_interval(motor_control_t* motor_control, uint64_t interval_q16);
+bool stepper_is_sweeping(const motor_control_t* motor_control);
+int64_t stepper_sweep_position_q16(const motor_control_t* motor_control);
 void stepper_set_time(motor_control_t* motor_control, int steps, bool dir, int speed_us);
 
 // 新增的接口函数
 int stepper_get_position(const motor_control_t* motor_control);
 void stepper_set_position(motor_control_t* motor_control, int position);
+void stepper_get_position_phase(motor_control_t* motor_control, int* position, int* step_index);
+esp_err_t stepper_restore_position(motor_control_t* motor_control, int position, int step_index);
 bool stepper_is_moving(const motor_control_t* motor_control);
 void stepper_stop(motor_control_t* motor_control);
-void stepper_rotate_time(motor_control_t* motor_control, int duration_ms, bool dir_cw, int speed_us);
-void stepper_rotate_to_angle(motor_control_t* motor_control, float target_angle, float rpm);
+stepper_move_handle_t stepper_rotate_time(motor_control_t* motor_control, int duration_ms, bool dir_cw, int speed_us);
+stepper_move_handle_t stepper_rotate_to_angle(motor_control_t* motor_control, float target_angle, float rpm);
+stepper_move_handle_t stepper_submit(motor_control_t* motor_control, stepper_cmd_t* cmd);
+bool stepper_move_done(const motor_control_t* motor_control, stepper_move_handle_t move);
+esp_err_t stepper_wait_move(const motor_control_t* motor_control, stepper_move_handle_t move, TickType_t timeout);
+void stepper_register_done_callback(motor_control_t* motor_control, stepper_done_cb_t cb, void* arg);
+esp_err_t stepper_enqueue(motor_control_t* motor_control, stepper_cmd_t* cmd, stepper_move_handle_t* move);
+uint32_t stepper_get_cmd_overflows(const motor_control_t* motor_control);
+uint32_t stepper_get_completed_moves(const motor_control_t* motor_control);
+uint32_t stepper_get_emitted_steps(const motor_control_t* motor_control);
+uint32_t stepper_get_queue_depth(const motor_control_t* motor_control);
+uint32_t stepper_take_queue_peak(motor_control_t* motor_control);
+uint32_t stepper_get_playback_moves(const motor_control_t* motor_control);
+esp_err_t stepper_set_ramp(motor_control_t* motor_control, const step_ramp_config_t* config);
+esp_err_t stepper_set_drive_mode(motor_control_t* motor_control, stepper_drive_mode_t mode);
+int stepper_steps_per_rev(stepper_drive_mode_t mode);
+esp_err_t stepper_get_isr_stats(motor_control_t* motor_control, stepper_isr_stats_t* stats);
+esp_err_t stepper_get_isr_cycles(motor_control_t* motor_control, uint32_t* cycles, size_t capacity, size_t* count);
+esp_err_t stepper_reset_isr_stats(motor_control_t* motor_control);
+esp_err_t stepper_dump_isr_stats(motor_control_t* motor_control);
 
 #endif
@@ -0,0 +1,133 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Coil mask of a 4-wire motor, bit i drives coil i
+ *
+ */
+#define STEP_OUTPUT_COIL_MASK 0x0F
+
+/**
+ * @brief One step of a rendered move
+ *
+ */
+typedef struct {
+    uint32_t duration_us; // Time to hold `phase` before the next item
+    uint8_t phase;        // Coils to energize, see STEP_OUTPUT_COIL_MASK
+    int8_t step;          // Signed half steps this item moved the rotor by
+} step_wave_item_t;
+
+typedef struct step_output_t step_output_t;
+
+/**
+ * @brief Playback finished callback, runs in ISR context
+ *
+ * @return Whether a higher priority task was woken
+ */
+typedef bool (*step_output_done_cb_t)(step_output_t *output, void *arg);
+
+/**
+ * @brief Phase output backend of a motor
+ *
+ * A backend either drives the coils one phase at a time from the step ISR (`write`), or plays a
+ * whole pre-rendered move back in hardware (`play`), or both. Members a backend does not support
+ * are NULL. The driver takes ownership of the backends it is given and deletes them with the motor.
+ */
+struct step_output_t {
+    /**
+     * @brief Drive the coils now
+     *
+     * @note Called from the step ISR with a spinlock held, must be IRAM safe and must not block
+     */
+    void (*write)(step_output_t *output, uint32_t phase);
+
+    /**
+     * @brief Start playing `count` items back, return without waiting
+     *
+     * The first item is applied right away and every item is held for its duration. The last item
+     * is expected to release the coils. `wave` stays valid until `done_cb` runs or `stop` returns.
+     * On error nothing is played, the pins are left as they were and `done_cb` is not called.
+     * Called from task context.
+     */
+    esp_err_t (*play)(step_output_t *output, const step_wave_item_t *wave, size_t count,
+                      step_output_done_cb_t done_cb, void *arg);
+
+    /**
+     * @brief Abort a playback and release the coils, `done_cb` is not called afterwards
+     *
+     */
+    esp_err_t (*stop)(step_output_t *output);
+
+    /**
+     * @brief Free the backend and its hardware
+     *
+     */
+    esp_err_t (*del)(step_output_t *output);
+
+    size_t max_items; // Longest wave `play` accepts, 0 without playback support
+};
+
+/**
+ * @brief Dedicated GPIO backend configuration
+ *
+ */
+typedef struct {
+    int phase_gpios[4]; // Coil GPIOs, bit i of a phase drives `phase_gpios[i]`
+} step_dedic_output_config_t;
+
+/**
+ * @brief Create a backend that writes phases through a dedicated GPIO bundle
+ *
+ * A write is a single CPU instruction, which keeps the step ISR short. No playback support.
+ *
+ * @return
+ *      - ESP_OK: Backend created
+ *      - ESP_ERR_INVALID_ARG: NULL argument
+ *      - ESP_ERR_NO_MEM: Out of memory
+ *      - ESP_ERR_NOT_FOUND: No free dedicated GPIO channels on this core
+ */
+esp_err_t step_new_dedic_output(const step_dedic_output_config_t *config, step_output_t **ret_output);
+
+/**
+ * @brief RMT playback backend configuration
+ *
+ */
+typedef struct {
+    int phase_gpios[4]; // Coil GPIOs, one RMT TX channel each
+    size_t max_items;   // Longest move in steps that can be played back
+} step_rmt_output_config_t;
+
+/**
+ * @brief Create a backend that plays rendered moves through four synchronized RMT TX channels
+ *
+ * Each coil's level sequence is run length encoded into RMT symbols, the channels start together
+ * and the step timing comes from the RMT hardware, so a move costs no step interrupts. The backend
+ * has no `write`, so it is used as a motor's playback backend next to a per-step one on the same
+ * pins: the GPIO matrix is switched to the RMT channels for the duration of a playback and then
+ * back to whatever drove the pins before.
+ *
+ * @return
+ *      - ESP_OK: Backend created
+ *      - ESP_ERR_INVALID_ARG: NULL argument or zero `max_items`
+ *      - ESP_ERR_NO_MEM: Out of memory
+ *      - ESP_ERR_NOT_FOUND: Not enough free RMT TX channels
+ */
+esp_err_t step_new_rmt_output(const step_rmt_output_config_t *config, step_output_t **ret_output);
+
+#ifdef __cplusplus
+}
+#endif
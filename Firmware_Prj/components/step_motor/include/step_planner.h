@@ -0,0 +1,151 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "step_profile.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Number of segments the ring can hold, must be a power of two
+ *
+ */
+#ifndef STEP_PLANNER_DEPTH
+#define STEP_PLANNER_DEPTH 8
+#endif
+
+_Static_assert((STEP_PLANNER_DEPTH & (STEP_PLANNER_DEPTH - 1)) == 0, "STEP_PLANNER_DEPTH must be a power of two");
+
+/**
+ * @brief One move of the step stream
+ *
+ */
+typedef struct {
+    step_profile_t profile; // Motion profile, `exit_level` is raised by the consumer once a successor is queued
+    bool dir_cw;            // Rotation direction
+    uint32_t half_steps;    // Distance in half steps
+    uint8_t stride;         // Half steps per step once aligned, 1 or 2
+    uint8_t parity;         // Phase index parity a stride 2 step lands on
+    uint32_t seq;           // Completion sequence number, 0 if nobody waits for this segment
+    void *owner;            // Completion target, opaque to the planner
+} step_segment_t;
+
+/**
+ * @brief Single producer, single consumer ring of planned segments
+ *
+ * The producer is the task side of the driver, the consumer is the step ISR, which pops the next
+ * segment itself when the current one ends. Neither side ever waits for the other: indices are
+ * free running, each is written by one side only and published with release ordering.
+ */
+typedef struct {
+    step_segment_t segments[STEP_PLANNER_DEPTH]; // Segment storage
+    atomic_uint head;                            // Next segment to consume, written by the consumer
+    atomic_uint tail;                            // Next free slot, written by the producer
+    uint32_t overflows;                          // Pushes rejected because the ring was full
+    uint32_t peak;                               // Most segments queued after a push, written by the producer
+} step_planner_t;
+
+/**
+ * @brief Drop all queued segments
+ *
+ * @note Only call this while the consumer is stopped
+ */
+void step_planner_reset(step_planner_t *planner);
+
+/**
+ * @brief Number of queued segments
+ *
+ */
+static inline uint32_t step_planner_count(const step_planner_t *planner)
+{
+    return atomic_load_explicit(&planner->tail, memory_order_acquire) -
+           atomic_load_explicit(&planner->head, memory_order_acquire);
+}
+
+/**
+ * @brief Whether another segment can be pushed
+ *
+ */
+static inline bool step_planner_full(const step_planner_t *planner)
+{
+    return step_planner_count(planner) >= STEP_PLANNER_DEPTH;
+}
+
+/**
+ * @brief Producer side: append a segment, its exit level is planned to a stop
+ *
+ * @return false if the ring is full, the overflow counter is incremented
+ */
+static inline bool step_planner_push(step_planner_t *planner, const step_segment_t *segment)
+{
+    unsigned tail = atomic_load_explicit(&planner->tail, memory_order_relaxed);
+    if (tail - atomic_load_explicit(&planner->head, memory_order_acquire) >= STEP_PLANNER_DEPTH) {
+        planner->overflows++;
+        return false;
+    }
+    step_segment_t *slot = &planner->segments[tail & (STEP_PLANNER_DEPTH - 1)];
+    *slot = *segment;
+    slot->profile.exit_level = 0;
+    /* Sequentially consistent so that a producer which then finds the consumer stopped and a
+     * consumer which then finds the ring non-empty cannot both miss each other */
+    atomic_store_explicit(&planner->tail, tail + 1, memory_order_seq_cst);
+    uint32_t count = tail + 1 - atomic_load_explicit(&planner->head, memory_order_relaxed);
+    if (count > planner->peak) {
+        planner->peak = count;
+    }
+    return true;
+}
+
+/**
+ * @brief Consumer side: oldest queued segment, NULL if there is none
+ *
+ */
+static inline step_segment_t *step_planner_peek(step_planner_t *planner)
+{
+    unsigned head = atomic_load_explicit(&planner->head, memory_order_relaxed);
+    if (head == atomic_load_explicit(&planner->tail, memory_order_seq_cst)) {
+        return NULL;
+    }
+    return &planner->segments[head & (STEP_PLANNER_DEPTH - 1)];
+}
+
+/**
+ * @brief Consumer side: release the oldest queued segment after it was copied out
+ *
+ */
+static inline void step_planner_pop(step_planner_t *planner)
+{
+    atomic_store_explicit(&planner->head, atomic_load_explicit(&planner->head, memory_order_relaxed) + 1,
+                          memory_order_release);
+}
+
+/**
+ * @brief Highest level a running segment may leave at when `next` follows it
+ *
+ * A junction keeps the lower of the two cruise levels when the direction and drive stride are
+ * unchanged and drops to the start rate on a reversal or a stride change. It is also bounded by
+ * how far `next` can decelerate, as if it had to stop. The one level per step acceleration limit
+ * is enforced by the step ISR itself, so the result is an upper bound.
+ */
+static inline uint16_t step_planner_junction_level(bool dir_cw, uint8_t stride, uint8_t parity,
+                                                   uint16_t cruise_level, const step_segment_t *next)
+{
+    if (dir_cw != next->dir_cw || stride != next->stride || parity != next->parity) {
+        return 0;
+    }
+    uint32_t level = cruise_level < next->profile.cruise_level ? cruise_level : next->profile.cruise_level;
+    return (uint16_t)(level < next->profile.total_steps ? level : next->profile.total_steps);
+}
+
+#ifdef __cplusplus
+}
+#endif
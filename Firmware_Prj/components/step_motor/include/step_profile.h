@@ -0,0 +1,169 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Maximum number of speed levels in an acceleration ramp
+ *
+ */
+#ifndef STEP_RAMP_MAX_LEN
+#define STEP_RAMP_MAX_LEN 768
+#endif
+
+/**
+ * @brief Acceleration ramp shape
+ *
+ */
+typedef enum {
+    STEP_RAMP_SHAPE_TRAPEZOIDAL, /*!< Constant acceleration */
+    STEP_RAMP_SHAPE_S_CURVE,     /*!< Jerk limited (raised cosine velocity) acceleration */
+} step_ramp_shape_t;
+
+/**
+ * @brief Acceleration ramp configuration
+ *
+ */
+typedef struct {
+    uint32_t start_rate;     // Rate the motor can start and stop at without ramping (steps/s)
+    uint32_t max_rate;       // Top rate at the end of the ramp (steps/s)
+    uint32_t accel;          // Acceleration, peak value for S-curve (steps/s^2)
+    step_ramp_shape_t shape; // Ramp shape
+} step_ramp_config_t;
+
+/**
+ * @brief Position indexed acceleration ramp
+ *
+ * `interval_us[i]` is the time between the step taken at speed level `i` and the next one.
+ * Level 0 is the start rate, every further step while accelerating goes up one level,
+ * and deceleration walks the same table back down.
+ */
+typedef struct {
+    uint16_t interval_us[STEP_RAMP_MAX_LEN]; // Step interval of each speed level
+    uint16_t len;                            // Number of valid speed levels
+    step_ramp_config_t config;               // Configuration the ramp was built from
+} step_ramp_t;
+
+/**
+ * @brief Motion profile of a single move over a ramp
+ *
+ */
+typedef struct {
+    uint32_t total_steps;  // Steps in the move
+    uint32_t cruise_us;    // Requested step interval, never run faster than this
+    uint16_t cruise_level; // Highest profile level allowed by `cruise_us`
+    uint16_t exit_level;   // Profile level the move must be back at on its last step
+    uint8_t interval_shift; // Every step covers 2^shift ramp steps, see `step_profile_interval()`
+} step_profile_t;
+
+/**
+ * @brief Build an acceleration ramp
+ *
+ * @note Uses floating point math, call it at init time and not from the step ISR
+ *
+ * @param[out] ramp Ramp to fill
+ * @param[in] config Ramp configuration
+ * @return
+ *      - ESP_OK: Ramp built successfully
+ *      - ESP_ERR_INVALID_ARG: Ramp build failed because of invalid argument
+ */
+esp_err_t step_ramp_build(step_ramp_t *ramp, const step_ramp_config_t *config);
+
+/**
+ * @brief Get the highest ramp level whose interval is not shorter than `interval_us`
+ *
+ * @param[in] ramp Ramp built by `step_ramp_build()`
+ * @param[in] interval_us Step interval
+ * @return Ramp level, 0 if `interval_us` is slower than the start rate
+ */
+uint16_t step_ramp_level_for_interval(const step_ramp_t *ramp, uint32_t interval_us);
+
+/**
+ * @brief Fill in the motion profile of a move
+ *
+ * Profile levels count the move's own steps. A step that covers 2^`interval_shift` ramp steps
+ * (a full step over a half step ramp) advances the ramp by that many levels, so the move keeps
+ * the ramp's velocity at every position: the same angular acceleration and ramp distance.
+ *
+ * @param[in] ramp Ramp built by `step_ramp_build()`
+ * @param[in] steps Steps in the move
+ * @param[in] cruise_us Requested interval per ramp step, never run faster than this
+ * @param[in] interval_shift Every step of the move covers 2^shift ramp steps
+ * @param[out] profile Returned motion profile, ending at the start rate
+ */
+void step_profile_init(const step_ramp_t *ramp, uint32_t steps, uint32_t cruise_us, uint8_t interval_shift,
+                       step_profile_t *profile);
+
+/**
+ * @brief Total duration of a move that starts at `entry_level`
+ *
+ * Walks the move exactly like the step ISR does.
+ *
+ * @param[in] ramp Ramp built by `step_ramp_build()`
+ * @param[in] profile Motion profile
+ * @param[in] entry_level Ramp level of the first step, its interval is the first one of the move
+ * @return Time from the first step to the end of the last step interval (us)
+ */
+uint64_t step_profile_duration_us(const step_ramp_t *ramp, const step_profile_t *profile, uint16_t entry_level);
+
+/**
+ * @brief Ramp level of the next step
+ *
+ * Accelerates one level per step up to `cruise_level` and starts decelerating as soon as
+ * the remaining steps are just enough to get back down to `exit_level`. A move entered at
+ * level 0 and ending at level 0 takes the same intervals on the way down as on the way up.
+ *
+ * @param[in] level Ramp level of the step just taken, whose interval has been used
+ * @param[in] remaining Steps left in the move after the step just taken
+ * @param[in] cruise_level Highest level allowed in the move
+ * @param[in] exit_level Level the move must end at
+ * @return Ramp level of the next step
+ */
+static inline uint16_t step_ramp_next_level(uint16_t level, uint32_t remaining,
+                                            uint16_t cruise_level, uint16_t exit_level)
+{
+    if (level > cruise_level || (level > exit_level && remaining + exit_level <= level)) {
+        return level - 1;
+    }
+    if (level < cruise_level && remaining + exit_level > (uint32_t)level + 1) {
+        return level + 1;
+    }
+    return level;
+}
+
+/**
+ * @brief Step interval of a ramp level, clamped to the cruise interval of the move
+ *
+ */
+static inline uint32_t step_ramp_interval(const step_ramp_t *ramp, uint16_t level, uint32_t cruise_us)
+{
+    uint32_t interval = ramp->interval_us[level];
+    return interval > cruise_us ? interval : cruise_us;
+}
+
+/**
+ * @brief Step interval of a profile level within a move
+ *
+ * Profile level `level` is ramp level `level << interval_shift`, and its interval covers
+ * 2^`interval_shift` ramp steps at that level's rate.
+ */
+static inline uint32_t step_profile_interval(const step_ramp_t *ramp, const step_profile_t *profile, uint16_t level)
+{
+    return step_ramp_interval(ramp, (uint16_t)(level << profile->interval_shift), profile->cruise_us)
+           << profile->interval_shift;
+}
+
+#ifdef __cplusplus
+}
+#endif
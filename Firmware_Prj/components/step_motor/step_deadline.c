@@ -0,0 +1,24 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "step_deadline.h"
+
+bool step_deadline_remove(step_deadline_heap_t *heap, const void *owner)
+{
+    for (unsigned i = 0; i < heap->count; i++) {
+        if (heap->items[i].owner != owner) {
+            continue;
+        }
+        /* Fill the hole with the last item, which may belong either above or below it */
+        heap->items[i] = heap->items[--heap->count];
+        if (i < heap->count) {
+            step_deadline_sift_down(heap, i);
+            step_deadline_sift_up(heap, i);
+        }
+        return true;
+    }
+    return false;
+}
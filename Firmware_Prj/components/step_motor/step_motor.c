@@ -4,64 +4,897 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 #include "step_motor.h"
-#include "driver/gpio.h"
 #include "freertos/FreeRTOS.h"
+#include "freertos/timers.h"
+#include "esp_check.h"
+#include "esp_cpu.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "binlog.h"
+#include <inttypes.h>
 #include <stdint.h>
+#include <string.h>
 
-#define STEPS_PER_REV 4096
+#define STEPS_PER_REV 4096  // 半步
 #define MIN_SPEED_US 100  // 对应最大10kHz频率
+
+// 28BYJ-48 默认加速表：无需加速即可启停的频率、最高频率与加速度
+#define RAMP_START_RATE 600   // steps/s
+#define RAMP_MAX_RATE   2400  // steps/s
+#define RAMP_ACCEL      6000  // steps/s^2
 #define MOTOR_TAG "STEP_MOTOR"
 
-static const uint8_t code_octa_phase[8] = {0x08, 0x0C, 0x04, 0x06, 0x02, 0x03, 0x01, 0x09};
+#define SWEEP_HOLD_US 20000  // 扫动时每步后线圈的保持时间，之后断电，减速箱靠自锁保持位置
+
+// 由线圈编号生成八拍相位：偶数拍单相通电，奇数拍与下一相同时通电
+#define PHASE_COIL(c) (0x08 >> ((c) & 0x03))
+#define PHASE_HALF(i) (PHASE_COIL((i) >> 1) | (((i) & 1) ? PHASE_COIL(((i) >> 1) + 1) : 0))
 
-/* 定时器回调（ISR）*/
-static bool IRAM_ATTR gptimer_on_alarm_cb(gptimer_handle_t timer, const gptimer_alarm_event_data_t* edata,
-                                          void* user_data)
+// 半步相位表 0x08 0x0C 0x04 0x06 0x02 0x03 0x01 0x09，
+// 双相整步取其中的奇数拍，单相整步取偶数拍，三种方式共用同一个电角度下标
+static const uint8_t code_octa_phase[8] = {
+    PHASE_HALF(0), PHASE_HALF(1), PHASE_HALF(2), PHASE_HALF(3),
+    PHASE_HALF(4), PHASE_HALF(5), PHASE_HALF(6), PHASE_HALF(7),
+};
+
+typedef struct
 {
-    motor_control_t* motor_control_isr = (motor_control_t*)user_data;
+    uint8_t stride;    // 每步的半步数
+    uint8_t parity;    // 整步所在相位下标的奇偶
+    int steps_per_rev; // 该方式下每圈步数
+} stepper_drive_desc_t;
+
+static const stepper_drive_desc_t drive_modes[] = {
+    [STEPPER_DRIVE_HALF] = {.stride = 1, .parity = 0, .steps_per_rev = STEPS_PER_REV},
+    [STEPPER_DRIVE_FULL] = {.stride = 2, .parity = 1, .steps_per_rev = STEPS_PER_REV / 2},
+    [STEPPER_DRIVE_WAVE] = {.stride = 2, .parity = 0, .steps_per_rev = STEPS_PER_REV / 2},
+};
 
-    if unlikely(motor_control_isr->motion.executed_steps >= motor_control_isr->motion.total_steps)
+static const stepper_drive_desc_t* stepper_drive_desc(stepper_drive_mode_t mode)
+{
+    if ((unsigned)mode >= sizeof(drive_modes) / sizeof(drive_modes[0]))
     {
-        gptimer_stop(timer);
-        taskENTER_CRITICAL_ISR(motor_control_isr->motor_spinlock);
-        dedic_gpio_bundle_write(motor_control_isr->motor_dedic_gpio_bundle, 0x1111, 0x0000);
-        taskEXIT_CRITICAL_ISR(motor_control_isr->motor_spinlock);
-        return false;
+        mode = STEPPER_DRIVE_HALF;
+    }
+    return &drive_modes[mode];
+}
+
+struct stepper_group
+{
+    gptimer_handle_t timer;
+    portMUX_TYPE spinlock;          // 保护截止时间堆、running 和闹钟设置，中断与各电机的任务共用
+    SemaphoreHandle_t mutex;        // 串行化定时器的使能与关闭
+    step_deadline_heap_t deadlines; // 组内运动中电机的下一步时间，最早的决定下一次闹钟
+    bool running;                   // 定时器正在计数，由中断在堆取空后清零
+    bool timer_enabled;             // 定时器仅在有电机运动时使能
+    uint8_t motor_count;
+};
+
+static stepper_group_t* s_default_group; // stepper_driver_init() 使用的组，首次调用时创建
+
+/* 从相位下标 index 出发走 half_steps 个半步需要的中断次数，整步方式下相位不对齐时先走一个半步 */
+static uint32_t stepper_isr_steps(const stepper_drive_desc_t* desc, int index, uint32_t half_steps)
+{
+    if (desc->stride == 1 || !half_steps)
+    {
+        return half_steps;
+    }
+    uint32_t steps = 0;
+    if ((index & 1) != desc->parity)
+    {
+        steps = 1;
+        half_steps--;
+    }
+    return steps + half_steps / 2 + (half_steps & 1);
+}
+
+/* 写相位到逐步输出的后端 */
+static inline void IRAM_ATTR stepper_write_phase(motor_control_t* motor_control, uint32_t phase)
+{
+    motor_control->output->write(motor_control->output, phase);
+}
+
+/* 装载一段运动，保留当前加速档位以便无缝衔接 */
+static inline void IRAM_ATTR stepper_load_segment(motor_motion_t* motion, const step_segment_t* segment)
+{
+    motion->direction_cw = segment->dir_cw;
+    motion->total_steps = (int)segment->profile.total_steps;
+    motion->executed_steps = 0;
+    motion->profile = segment->profile;
+    motion->half_steps_left = segment->half_steps;
+    motion->stride = segment->stride;
+    motion->parity = segment->parity;
+    motion->seq = segment->seq;
+    motion->owner = (TaskHandle_t)segment->owner;
+    motion->loaded = true;
+    motion->exit_planned = false;
+}
+
+/* 一段运动结束：记录完成句柄，直接在 ISR 中通知等待者 */
+static inline void IRAM_ATTR stepper_complete_isr(motor_control_t* motor_control, BaseType_t* task_woken)
+{
+    motor_motion_t* motion = &motor_control->motion;
+
+    motion->completed_moves++;
+    if (motion->seq)
+    {
+        motor_control->completed_seq = motion->seq;
+        BINLOG(MOTOR_DONE, motion->seq, motion->absolute_position);
+        if (motion->owner)
+        {
+            xTaskNotifyIndexedFromISR(motion->owner, STEPPER_NOTIFY_INDEX, motion->seq, eSetValueWithOverwrite,
+                                      task_woken);
+        }
+        if (motor_control->done_cb)
+        {
+            motor_control->done_cb(motor_control, motion->seq, motor_control->done_cb_arg);
+        }
+        motion->seq = 0;
+    }
+}
+
+#if CONFIG_STEP_MOTOR_ISR_STATS
+/* 记录一次服务的截止时间到进入中断的延迟，missed 表示下一步已经过期、被重新计时；
+ * 调用者持有 motor_spinlock，与另一个核上读取统计的任务互斥 */
+static inline void IRAM_ATTR stepper_isr_stats_latency(motor_control_t* motor_control, uint64_t deadline, uint64_t now,
+                                                       bool missed)
+{
+    stepper_isr_stats_t* stats = &motor_control->isr_stats;
+    // now 是进入中断时捕获的计数值，1MHz 分辨率下差值即为微秒；同一次中断里服务的电机共用它
+    uint32_t latency_us = (uint32_t)(now - deadline);
+    stats->isr_count++;
+    stats->latency_hist[latency_us < STEPPER_ISR_HIST_BUCKETS ? latency_us : STEPPER_ISR_HIST_BUCKETS - 1]++;
+    if (latency_us > stats->max_latency_us)
+    {
+        stats->max_latency_us = latency_us;
+    }
+    if (latency_us > CONFIG_STEP_MOTOR_ISR_LATE_US)
+    {
+        stats->late_alarms++;
+    }
+    if (missed)
+    {
+        stats->missed_alarms++;
+    }
+}
+
+/* 记录服务过该电机的那次中断从进入到重装闹钟的执行时间，含截止时间堆的操作 */
+static inline void IRAM_ATTR stepper_isr_stats_cycles(motor_control_t* motor_control, uint32_t cycles)
+{
+    stepper_isr_stats_t* stats = &motor_control->isr_stats;
+    uint32_t bucket = cycles ? 31 - __builtin_clz(cycles) : 0;
+
+    taskENTER_CRITICAL_ISR(motor_control->motor_spinlock);
+    stats->cycles_hist[bucket < STEPPER_ISR_HIST_BUCKETS ? bucket : STEPPER_ISR_HIST_BUCKETS - 1]++;
+    motor_control->isr_cycles[(stats->isr_count - 1) % STEPPER_ISR_CYCLE_SAMPLES] = cycles;
+    stats->total_cycles += cycles;
+    if (cycles > stats->max_cycles)
+    {
+        stats->max_cycles = cycles;
+    }
+    taskEXIT_CRITICAL_ISR(motor_control->motor_spinlock);
+}
+#endif
+
+static void stepper_deferred_idle(void* arg, uint32_t unused);
+static void stepper_group_deferred_idle(void* arg, uint32_t unused);
+
+/* 走一步：整步方式下相位未对齐或只剩一个半步时走半步，返回带方向的半步数。
+ * 步进中断与回放渲染共用，两条路径输出完全相同的相位序列 */
+static inline int IRAM_ATTR stepper_advance(motor_motion_t* motion)
+{
+    uint32_t stride = motion->stride;
+    if (stride > 1 && (motion->step_index & 1) != motion->parity)
+    {
+        stride = 1;
+    }
+    if (stride > motion->half_steps_left)
+    {
+        stride = motion->half_steps_left;
+    }
+    motion->half_steps_left -= stride;
+    int step = motion->direction_cw ? (int)stride : -(int)stride;
+    motion->step_index = (motion->step_index + step) & 0x07;
+    return step;
+}
+
+/* 记一步已走完，按这一步所在的级别查加速表得到到下一步的间隔，再为下一步升降级别；
+ * 第一步在第 0 级（起步频率），加速段与减速段的间隔对称 */
+static inline uint32_t IRAM_ATTR stepper_next_interval(motor_motion_t* motion, const step_ramp_t* ramp)
+{
+    uint32_t interval = step_profile_interval(ramp, &motion->profile, motion->ramp_level);
+    motion->executed_steps++;
+    motion->ramp_level = step_ramp_next_level(motion->ramp_level, motion->total_steps - motion->executed_steps,
+                                              motion->profile.cruise_level, motion->profile.exit_level);
+    return interval;
+}
+
+/* 扫动模式的一次到期：走一个半步并通电保持，或在保持结束时断电；返回下一次到期的计数值 */
+static inline uint64_t IRAM_ATTR stepper_sweep_isr(motor_control_t* motor_control, uint64_t deadline, uint64_t now)
+{
+    motor_motion_t* motion = &motor_control->motion;
+    uint64_t alarm;
+
+    taskENTER_CRITICAL_ISR(motor_control->motor_spinlock);
+    if (motion->sweep_coils_on)
+    {
+        stepper_write_phase(motor_control, 0x0000);
+        motion->sweep_coils_on = false;
+        alarm = motion->sweep_next_q16 >> 16;
+    }
+    else
+    {
+        int step = motion->direction_cw ? 1 : -1;
+        motion->step_index = (motion->step_index + step) & 0x07;
+        stepper_write_phase(motor_control, code_octa_phase[motion->step_index]);
+        motion->absolute_position += step;
+        motion->emitted_steps++;
+        motion->sweep_last_step = deadline;
+        // 间隔的小数部分留在 Q16 累加值里，长期平均速率与设定值一致
+        motion->sweep_next_q16 += motor_control->sweep_interval_q16;
+        alarm = deadline + SWEEP_HOLD_US;
+        // 间隔比保持时间还短时线圈不断电，直接走下一步
+        motion->sweep_coils_on = alarm < (motion->sweep_next_q16 >> 16);
+        if (!motion->sweep_coils_on)
+        {
+            alarm = motion->sweep_next_q16 >> 16;
+        }
+    }
+#if CONFIG_STEP_MOTOR_ISR_STATS
+    stepper_isr_stats_latency(motor_control, deadline, now, false);
+#endif
+    taskEXIT_CRITICAL_ISR(motor_control->motor_spinlock);
+    return alarm;
+}
+
+/* 服务一个到期的电机：走一步或衔接下一段，返回它的下一个截止时间，0 表示该电机已停下 */
+static inline uint64_t IRAM_ATTR stepper_service_isr(motor_control_t* motor_control_isr, uint64_t deadline,
+                                                     uint64_t now, BaseType_t* task_woken)
+{
+    motor_motion_t* motion = &motor_control_isr->motion;
+
+    if unlikely(motion->sweep)
+    {
+        return stepper_sweep_isr(motor_control_isr, deadline, now);
     }
 
-    uint8_t phase = code_octa_phase[motor_control_isr->motion.step_index & 0x07];
     taskENTER_CRITICAL_ISR(motor_control_isr->motor_spinlock);
-    dedic_gpio_bundle_write(motor_control_isr->motor_dedic_gpio_bundle, 0x1111, phase);
+    while unlikely(motion->executed_steps >= motion->total_steps)
+    {
+        if (motion->loaded)
+        {
+            stepper_complete_isr(motor_control_isr, task_woken);
+            motion->loaded = false;
+        }
+        step_segment_t* segment = step_planner_peek(&motor_control_isr->planner);
+        if (!segment)
+        {
+            stepper_write_phase(motor_control_isr, 0x0000);
+            atomic_store(&motion->running, false);
+#if CONFIG_STEP_MOTOR_ISR_STATS
+            stepper_isr_stats_latency(motor_control_isr, deadline, now, false);
+#endif
+            taskEXIT_CRITICAL_ISR(motor_control_isr->motor_spinlock);
+            BINLOG(MOTOR_IDLE, motion->absolute_position);
+            // 恰好在停止时入队的段交给定时器服务任务启动，组定时器在所有电机都停下后由组关闭
+            xTimerPendFunctionCallFromISR(stepper_deferred_idle, motor_control_isr, 0, task_woken);
+            return 0;
+        }
+        // 下一段已在环形缓冲中，直接衔接，不停止也不断电
+        stepper_load_segment(motion, segment);
+        step_planner_pop(&motor_control_isr->planner);
+    }
+
+    // 后继段入队后才能抬高当前段的出口速度，否则按停止减速
+    if (!motion->exit_planned)
+    {
+        const step_segment_t* next = step_planner_peek(&motor_control_isr->planner);
+        if (next)
+        {
+            motion->profile.exit_level = step_planner_junction_level(motion->direction_cw, motion->stride,
+                                                                     motion->parity,
+                                                                     motion->profile.cruise_level, next);
+            motion->exit_planned = true;
+        }
+    }
+
+    int step = stepper_advance(motion);
+    stepper_write_phase(motor_control_isr, code_octa_phase[motion->step_index]);
+    motion->emitted_steps += step < 0 ? -step : step;
+
+    // 更新位置
+    motion->absolute_position += step;
+
+    // 截止时间累加避免误差
+    uint32_t interval = stepper_next_interval(motion, &motor_control_isr->ramp);
+    uint64_t next_deadline = deadline + interval;
+    // 晚了一个间隔以上时不补走错过的步，从这次写相位起重新计时，否则几步会在同一次中断里
+    // 相隔几微秒连续写出，转子跟不上而丢步，位置却照样计数
+    bool missed = next_deadline <= now;
+    if unlikely(missed)
+    {
+        next_deadline = now + interval;
+    }
+#if CONFIG_STEP_MOTOR_ISR_STATS
+    stepper_isr_stats_latency(motor_control_isr, deadline, now, missed);
+#endif
     taskEXIT_CRITICAL_ISR(motor_control_isr->motor_spinlock);
+    return next_deadline;
+}
+
+/* 组定时器回调（ISR）：服务所有已到期的电机，再按最早的截止时间重装闹钟 */
+static bool IRAM_ATTR stepper_group_on_alarm_cb(gptimer_handle_t timer, const gptimer_alarm_event_data_t* edata,
+                                                void* user_data)
+{
+#if CONFIG_STEP_MOTOR_ISR_STATS
+    // 执行时间从进入中断算起，截止时间堆的出入和闹钟重装都计在内
+    uint32_t start_cycles = esp_cpu_get_cycle_count();
+    motor_control_t* served[STEP_DEADLINE_DEPTH];
+    size_t served_count = 0;
+#endif
+    stepper_group_t* group = (stepper_group_t*)user_data;
+    BaseType_t task_woken = pdFALSE;
+    step_deadline_t due;
+    bool idle = false;
+
+    taskENTER_CRITICAL_ISR(&group->spinlock);
+    // 服务期间不持有组锁，其他核上的任务可以照常启动或停止别的电机；
+    // 每个电机在一次中断里只走一步，已经过期的下一步由 stepper_service_isr 推到一个间隔之后
+    while (step_deadline_pop_due(&group->deadlines, edata->count_value, &due))
+    {
+        motor_control_t* motor_control_isr = (motor_control_t*)due.owner;
+        uint32_t epoch = motor_control_isr->sched_epoch;
+        taskEXIT_CRITICAL_ISR(&group->spinlock);
+        uint64_t next = stepper_service_isr(motor_control_isr, due.deadline, edata->count_value, &task_woken);
+#if CONFIG_STEP_MOTOR_ISR_STATS
+        if (served_count < STEP_DEADLINE_DEPTH)
+        {
+            served[served_count++] = motor_control_isr;
+        }
+#endif
+        taskENTER_CRITICAL_ISR(&group->spinlock);
+        // 服务期间被停止或重新启动的电机已有新的安排，旧的截止时间作废
+        if (next && epoch == motor_control_isr->sched_epoch)
+        {
+            step_deadline_push(&group->deadlines, next, motor_control_isr);
+        }
+    }
+    const step_deadline_t* first = step_deadline_top(&group->deadlines);
+    if (first)
+    {
+        gptimer_alarm_config_t alarm_config = {
+            .alarm_count = first->deadline,
+        };
+        gptimer_set_alarm_action(timer, &alarm_config);
+    }
+    else if (group->running)
+    {
+        gptimer_stop(timer);
+        group->running = false;
+        idle = true;
+    }
+    taskEXIT_CRITICAL_ISR(&group->spinlock);
+#if CONFIG_STEP_MOTOR_ISR_STATS
+    uint32_t cycles = esp_cpu_get_cycle_count() - start_cycles;
+    for (size_t i = 0; i < served_count; i++)
+    {
+        stepper_isr_stats_cycles(served[i], cycles);
+    }
+#endif
+
+    if (idle)
+    {
+        // 定时器不能在 ISR 中关闭，交给定时器服务任务
+        xTimerPendFunctionCallFromISR(stepper_group_deferred_idle, group, 0, &task_woken);
+    }
+    return task_woken == pdTRUE;
+}
+
+/* 把电机排进组定时器，delay 个计数后第一次到期，调用者持有 motor_mutex。
+ * 组定时器自由计数不清零，各电机的截止时间都是绝对计数值 */
+static void stepper_timer_start_locked(motor_control_t* motor_control, uint32_t delay)
+{
+    stepper_group_t* group = motor_control->group;
+    motor_motion_t* motion = &motor_control->motion;
+    atomic_store(&motion->running, true);
+
+    xSemaphoreTake(group->mutex, portMAX_DELAY);
+    // 定时器只在有电机运动时使能，其电源锁才不会阻止自动浅睡眠
+    if (!group->timer_enabled)
+    {
+        ESP_ERROR_CHECK(gptimer_enable(group->timer));
+        group->timer_enabled = true;
+    }
+    taskENTER_CRITICAL(&group->spinlock);
+    uint64_t now = 0;
+    gptimer_get_raw_count(group->timer, &now);
+    uint64_t deadline = now + delay;
+    if (motion->sweep)
+    {
+        // 电机还不在堆中，ISR 不会同时访问扫动状态
+        taskENTER_CRITICAL(motor_control->motor_spinlock);
+        motion->sweep_last_step = now;
+        motion->sweep_next_q16 = deadline << 16;
+        taskEXIT_CRITICAL(motor_control->motor_spinlock);
+    }
+    step_deadline_remove(&group->deadlines, motor_control);
+    motor_control->sched_epoch++;
+    step_deadline_push(&group->deadlines, deadline, motor_control);
+    if (!group->running)
+    {
+        gptimer_start(group->timer);
+        group->running = true;
+    }
+    // 新的截止时间可能早于已装的闹钟，按堆顶重装；已经过去的闹钟值会立即触发
+    gptimer_alarm_config_t alarm_config = {
+        .alarm_count = step_deadline_top(&group->deadlines)->deadline,
+    };
+    gptimer_set_alarm_action(group->timer, &alarm_config);
+    taskEXIT_CRITICAL(&group->spinlock);
+    xSemaphoreGive(group->mutex);
+}
+
+/* 把电机移出组定时器的安排，ISR 正在服务的那一步也不再续排；闹钟留给 ISR 处理 */
+static void stepper_timer_cancel(motor_control_t* motor_control)
+{
+    stepper_group_t* group = motor_control->group;
+    taskENTER_CRITICAL(&group->spinlock);
+    motor_control->sched_epoch++;
+    step_deadline_remove(&group->deadlines, motor_control);
+    taskEXIT_CRITICAL(&group->spinlock);
+}
+
+/* 从静止启动，调用者持有 motor_mutex；第一步在下一个计数就执行，由 ISR 从环形缓冲取段 */
+static void stepper_start_locked(motor_control_t* motor_control)
+{
+    motor_control->motion.ramp_level = 0;
+    stepper_timer_start_locked(motor_control, 1);
+}
+
+/* ISR 停下电机后的收尾，线圈已在 ISR 中断电；调用者持有 motor_mutex */
+static void stepper_idle_locked(motor_control_t* motor_control)
+{
+    if (atomic_load(&motor_control->motion.running))
+    {
+        return;
+    }
+    // ISR 取空缓冲后、清零 running 前入队的段，提交任务看不到停止，在这里补启动
+    if (step_planner_count(&motor_control->planner))
+    {
+        stepper_start_locked(motor_control);
+    }
+}
+
+/* 由 ISR 推迟到定时器服务任务执行 */
+static void stepper_deferred_idle(void* arg, uint32_t unused)
+{
+    motor_control_t* motor_control = (motor_control_t*)arg;
+    xSemaphoreTake(motor_control->motor_mutex, portMAX_DELAY);
+    stepper_idle_locked(motor_control);
+    xSemaphoreGive(motor_control->motor_mutex);
+}
+
+/* 组内所有电机都停下后关闭定时器，释放其电源锁；由 ISR 推迟到定时器服务任务执行 */
+static void stepper_group_deferred_idle(void* arg, uint32_t unused)
+{
+    stepper_group_t* group = (stepper_group_t*)arg;
+    xSemaphoreTake(group->mutex, portMAX_DELAY);
+    taskENTER_CRITICAL(&group->spinlock);
+    bool idle = !group->running;
+    taskEXIT_CRITICAL(&group->spinlock);
+    // 期间已有电机重新启动时定时器保持使能
+    if (idle && group->timer_enabled)
+    {
+        ESP_ERROR_CHECK(gptimer_disable(group->timer));
+        group->timer_enabled = false;
+    }
+    xSemaphoreGive(group->mutex);
+}
+
+/* 回放结束（ISR）：位置一次性前进整段，按与步进中断相同的方式完成并收尾 */
+static bool IRAM_ATTR stepper_playback_done_isr(step_output_t* output, void* arg)
+{
+    motor_control_t* motor_control = (motor_control_t*)arg;
+    motor_motion_t* motion = &motor_control->motion;
+    BaseType_t task_woken = pdFALSE;
+
+    taskENTER_CRITICAL_ISR(motor_control->motor_spinlock);
+    bool active = motion->playback;
+    if (active)
+    {
+        motion->playback = false;
+        motion->absolute_position += motor_control->playback_delta;
+        motion->emitted_steps += motor_control->playback_delta < 0 ? -motor_control->playback_delta
+                                                                  : motor_control->playback_delta;
+        motion->step_index = (motion->step_index + motor_control->playback_delta) & 0x07;
+        motion->executed_steps = motion->total_steps;
+    }
+    taskEXIT_CRITICAL_ISR(motor_control->motor_spinlock);
+    // 已被 stepper_stop() 中止
+    if (!active)
+    {
+        return false;
+    }
 
-    // 更新步进索引和位置
-    motor_control_isr->motion.step_index += motor_control_isr->motion.direction_cw ? 1 : -1;
-    motor_control_isr->motion.step_index &= 0x07;
-    motor_control_isr->motion.absolute_position += motor_control_isr->motion.direction_cw ? 1 : -1;
-    motor_control_isr->motion.executed_steps++;
+    motor_control->playback_moves++;
+    stepper_complete_isr(motor_control, &task_woken);
+    motion->loaded = false;
+    atomic_store(&motion->running, false);
+    BINLOG(MOTOR_IDLE, motion->absolute_position);
+    // 回放期间入队的段由定时器服务任务交给步进中断
+    xTimerPendFunctionCallFromISR(stepper_deferred_idle, motor_control, 0, &task_woken);
+    return task_woken == pdTRUE;
+}
+
+/* 按与步进中断相同的步距、相位和加速表把一段运动渲染成波形，返回波形项数，放不下时返回 0 */
+static size_t stepper_render_locked(motor_control_t* motor_control, const step_segment_t* segment)
+{
+    motor_motion_t motion = {.step_index = motor_control->motion.step_index};
+    size_t capacity = motor_control->playback->max_items;
+    size_t count = 0;
+    int delta = 0;
+
+    stepper_load_segment(&motion, segment);
+    while (motion.executed_steps < motion.total_steps)
+    {
+        if (count + 1 >= capacity)
+        {
+            return 0;
+        }
+        int step = stepper_advance(&motion);
+        step_wave_item_t* item = &motor_control->wave[count++];
+        item->phase = code_octa_phase[motion.step_index];
+        item->step = (int8_t)step;
+        item->duration_us = stepper_next_interval(&motion, &motor_control->ramp);
+        delta += step;
+    }
+    // 与步进中断相同，最后一步保持一个间隔后断电
+    motor_control->wave[count++] = (step_wave_item_t){
+        .duration_us = 1,
+        .phase = 0x0000,
+        .step = 0,
+    };
+    motor_control->playback_delta = delta;
+    return count;
+}
+
+/* 静止时中断频率够高的运动整段渲染后交给回放后端，走完之前不产生步进中断；
+ * 不满足条件或后端拒绝时返回 false，由调用者走步进中断。调用者持有 motor_mutex */
+static bool stepper_playback_locked(motor_control_t* motor_control, const step_segment_t* segment, int speed_us)
+{
+    motor_motion_t* motion = &motor_control->motion;
+    if (!motor_control->playback || !segment->profile.total_steps ||
+        1000000u / (uint32_t)speed_us < motor_control->playback_min_rate ||
+        stepper_is_moving(motor_control) || step_planner_count(&motor_control->planner))
+    {
+        return false;
+    }
+    size_t count = stepper_render_locked(motor_control, segment);
+    if (!count)
+    {
+        return false;
+    }
 
+    taskENTER_CRITICAL(motor_control->motor_spinlock);
+    stepper_load_segment(motion, segment);
+    motion->playback = true;
+    taskEXIT_CRITICAL(motor_control->motor_spinlock);
+    atomic_store(&motion->running, true);
+    motor_control->wave_len = count;
+    if (motor_control->playback->play(motor_control->playback, motor_control->wave, count,
+                                      stepper_playback_done_isr, motor_control) != ESP_OK)
+    {
+        taskENTER_CRITICAL(motor_control->motor_spinlock);
+        motion->playback = false;
+        motion->loaded = false;
+        motion->total_steps = motion->executed_steps;
+        taskEXIT_CRITICAL(motor_control->motor_spinlock);
+        atomic_store(&motion->running, false);
+        return false;
+    }
+    // 波形在全部通道排队后才开始，切换引脚和复位同步的耗时不计入已走的时间
+    motor_control->playback_start_us = esp_timer_get_time();
     return true;
 }
 
-/* 设置运动参数 */
+/* 中止回放，调用者持有 motor_mutex。回放硬件不报告进度，按已经过去的时间在波形中找出已走的步；
+ * 时间在停止之前取，停止本身要关闭再打开四个通道，不能算进回放的时间 */
+static void stepper_playback_abort_locked(motor_control_t* motor_control)
+{
+    motor_motion_t* motion = &motor_control->motion;
+    if (!motion->playback)
+    {
+        return;
+    }
+    uint64_t elapsed = esp_timer_get_time() - motor_control->playback_start_us;
+    motor_control->playback->stop(motor_control->playback);
+
+    taskENTER_CRITICAL(motor_control->motor_spinlock);
+    if (motion->playback)
+    {
+        motion->playback = false;
+        // 只计保持时间已经走完的项，正在保持的那一步按未走计
+        uint64_t end = 0;
+        for (size_t i = 0; i < motor_control->wave_len; i++)
+        {
+            end += motor_control->wave[i].duration_us;
+            if (end > elapsed)
+            {
+                break;
+            }
+            motion->absolute_position += motor_control->wave[i].step;
+            motion->emitted_steps += motor_control->wave[i].step < 0 ? -motor_control->wave[i].step
+                                                                    : motor_control->wave[i].step;
+            motion->step_index = (motion->step_index + motor_control->wave[i].step) & 0x07;
+        }
+    }
+    taskEXIT_CRITICAL(motor_control->motor_spinlock);
+}
+
+/* 追加一段半步运动 */
 void stepper_set_time(motor_control_t* motor_control, int steps, bool dir, int speed_us)
 {
-    if (speed_us < MIN_SPEED_US) speed_us = MIN_SPEED_US;
+    stepper_cmd_t cmd = {
+        .steps = steps,
+        .dir_cw = dir,
+        .speed_us = speed_us,
+        .mode = STEPPER_DRIVE_HALF,
+    };
+    stepper_submit(motor_control, &cmd);
+}
 
-    motor_control->motion.direction_cw = dir;
-    motor_control->motion.total_steps = steps;
-    motor_control->motion.executed_steps = 0;
-    gptimer_alarm_config_t alarm_config = {
-        .reload_count = 0,
-        .alarm_count = speed_us,
-        .flags.auto_reload_on_alarm = true,
+/* 没有在途的运动时从实际通电的相位和位置开始推算，调用者持有 motor_mutex */
+static void stepper_sync_plan_locked(motor_control_t* motor_control)
+{
+    if (!step_planner_count(&motor_control->planner) && !stepper_is_moving(motor_control))
+    {
+        motor_control->plan_index = motor_control->motion.step_index;
+        motor_control->plan_position = motor_control->motion.absolute_position;
+    }
+}
+
+/* 规划一段 half_steps 个半步的运动并放入环形缓冲，调用者持有 motor_mutex。
+ * 加速表以半步为单位，整步方式每步跨两级、间隔按 2 倍缩放，与半步方式的角加速度相同；
+ * 电机静止时直接启动定时器 */
+static esp_err_t stepper_push_locked(motor_control_t* motor_control, stepper_cmd_t* cmd, uint32_t half_steps,
+                                     stepper_move_handle_t* move)
+{
+    const stepper_drive_desc_t* desc = stepper_drive_desc(cmd->mode);
+    int speed_us = cmd->speed_us < MIN_SPEED_US ? MIN_SPEED_US : cmd->speed_us;
+    step_planner_t* planner = &motor_control->planner;
+
+    // 扫动期间 ISR 不取环形缓冲，先用 stepper_stop() 结束扫动
+    if (motor_control->motion.sweep)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    stepper_sync_plan_locked(motor_control);
+
+    stepper_move_handle_t seq = motor_control->next_seq + 1;
+    if (!seq) seq = 1;
+    cmd->seq = seq;
+    cmd->owner = xTaskGetCurrentTaskHandle();
+
+    step_segment_t segment = {
+        .dir_cw = cmd->dir_cw,
+        .half_steps = half_steps,
+        .stride = desc->stride,
+        .parity = desc->parity,
+        .seq = seq,
+        .owner = cmd->owner,
     };
-    ESP_ERROR_CHECK(gptimer_set_alarm_action(motor_control->motor_gptimer, &alarm_config));
-    ESP_ERROR_CHECK(gptimer_set_raw_count(motor_control->motor_gptimer, 0));
-    ESP_ERROR_CHECK(gptimer_start(motor_control->motor_gptimer));
-    ESP_LOGD(MOTOR_TAG, "Motion: %d steps %s at %dus/step",
-             steps, dir ? "CW" : "CCW", speed_us);
+    step_profile_init(&motor_control->ramp, stepper_isr_steps(desc, motor_control->plan_index, half_steps),
+                      speed_us / desc->stride, desc->stride - 1, &segment.profile);
+    bool played = stepper_playback_locked(motor_control, &segment, speed_us);
+    if (!played && !step_planner_push(planner, &segment))
+    {
+        BINLOG(MOTOR_RING_FULL, planner->overflows);
+        return ESP_ERR_NO_MEM;
+    }
+    motor_control->next_seq = seq;
+    int delta = (int)(half_steps & 0x07);
+    motor_control->plan_index = (motor_control->plan_index + (cmd->dir_cw ? delta : -delta)) & 0x07;
+    motor_control->plan_position += cmd->dir_cw ? (int)half_steps : -(int)half_steps;
+
+    // 运动中由 ISR 在当前段结束时取走，无需唤醒任何任务
+    if (!played && !stepper_is_moving(motor_control))
+    {
+        stepper_start_locked(motor_control);
+    }
+    // 命令路径上只记录原始参数，格式化和串口输出由 binlog 的排空任务在之后完成
+    BINLOG(MOTOR_QUEUED, seq, cmd->dir_cw ? (int32_t)half_steps : -(int32_t)half_steps, speed_us, cmd->mode);
+    if (move)
+    {
+        *move = seq;
+    }
+    return ESP_OK;
+}
+
+/* 以驱动方式的步数放入一段运动，调用者持有 motor_mutex */
+static esp_err_t stepper_enqueue_locked(motor_control_t* motor_control, stepper_cmd_t* cmd,
+                                        stepper_move_handle_t* move)
+{
+    uint32_t half_steps = (cmd->steps < 0 ? 0 : cmd->steps) * stepper_drive_desc(cmd->mode)->stride;
+    return stepper_push_locked(motor_control, cmd, half_steps, move);
+}
+
+/* 把一段运动放入环形缓冲，不等待：缓冲满时返回 ESP_ERR_NO_MEM 并计入溢出次数 */
+esp_err_t stepper_enqueue(motor_control_t* motor_control, stepper_cmd_t* cmd, stepper_move_handle_t* move)
+{
+    ESP_RETURN_ON_FALSE(motor_control && cmd, ESP_ERR_INVALID_ARG, MOTOR_TAG, "invalid argument");
+    xSemaphoreTake(motor_control->motor_mutex, portMAX_DELAY);
+    esp_err_t ret = stepper_enqueue_locked(motor_control, cmd, move);
+    xSemaphoreGive(motor_control->motor_mutex);
+    return ret;
+}
+
+/* 提交运动命令，返回完成句柄，环形缓冲满时返回 0 */
+stepper_move_handle_t stepper_submit(motor_control_t* motor_control, stepper_cmd_t* cmd)
+{
+    stepper_move_handle_t move = 0;
+    stepper_enqueue(motor_control, cmd, &move);
+    return move;
+}
+
+/* 句柄对应的运动是否已完成，句柄按提交顺序递增且按顺序完成 */
+bool stepper_move_done(const motor_control_t* motor_control, stepper_move_handle_t move)
+{
+    return (int32_t)(motor_control->completed_seq - move) >= 0;
+}
+
+/* 等待句柄对应的运动完成，由 ISR 在最后一步后直接唤醒提交任务，须在提交该运动的任务中调用 */
+esp_err_t stepper_wait_move(const motor_control_t* motor_control, stepper_move_handle_t move, TickType_t timeout)
+{
+    ESP_RETURN_ON_FALSE(motor_control && move, ESP_ERR_INVALID_ARG, MOTOR_TAG, "invalid argument");
+    TimeOut_t time_out;
+    vTaskSetTimeOutState(&time_out);
+    while (!stepper_move_done(motor_control, move))
+    {
+        if (xTaskCheckForTimeOut(&time_out, &timeout) == pdTRUE)
+        {
+            return ESP_ERR_TIMEOUT;
+        }
+        xTaskNotifyWaitIndexed(STEPPER_NOTIFY_INDEX, 0, 0, NULL, timeout);
+    }
+    return ESP_OK;
+}
+
+/* 注册运动完成回调（ISR 上下文） */
+void stepper_register_done_callback(motor_control_t* motor_control, stepper_done_cb_t cb, void* arg)
+{
+    taskENTER_CRITICAL(motor_control->motor_spinlock);
+    motor_control->done_cb = cb;
+    motor_control->done_cb_arg = arg;
+    taskEXIT_CRITICAL(motor_control->motor_spinlock);
+}
+
+/* 因环形缓冲满而被拒绝的命令数 */
+uint32_t stepper_get_cmd_overflows(const motor_control_t* motor_control)
+{
+    return motor_control->planner.overflows;
+}
+
+/* 已完成的运动段计数 */
+uint32_t stepper_get_completed_moves(const motor_control_t* motor_control)
+{
+    return motor_control->motion.completed_moves;
+}
+
+/* 已输出的半步数，逐步输出、回放和扫动都计入，不论方向 */
+uint32_t stepper_get_emitted_steps(const motor_control_t* motor_control)
+{
+    return motor_control->motion.emitted_steps;
+}
+
+/* 环形缓冲中等待执行的运动段数 */
+uint32_t stepper_get_queue_depth(const motor_control_t* motor_control)
+{
+    return step_planner_count(&motor_control->planner);
+}
+
+/* 上次调用以来环形缓冲的最高占用，取出后从当前占用重新开始统计 */
+uint32_t stepper_take_queue_peak(motor_control_t* motor_control)
+{
+    xSemaphoreTake(motor_control->motor_mutex, portMAX_DELAY);
+    uint32_t peak = motor_control->planner.peak;
+    motor_control->planner.peak = step_planner_count(&motor_control->planner);
+    xSemaphoreGive(motor_control->motor_mutex);
+    return peak;
+}
+
+/* 更换加速表，只能在电机静止时调用 */
+esp_err_t stepper_set_ramp(motor_control_t* motor_control, const step_ramp_config_t* config)
+{
+    ESP_RETURN_ON_FALSE(motor_control && config, ESP_ERR_INVALID_ARG, MOTOR_TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(!stepper_is_moving(motor_control), ESP_ERR_INVALID_STATE, MOTOR_TAG, "motor is moving");
+    return step_ramp_build(&motor_control->ramp, config);
+}
+
+/* 读取步进中断统计的快照 */
+esp_err_t stepper_get_isr_stats(motor_control_t* motor_control, stepper_isr_stats_t* stats)
+{
+#if CONFIG_STEP_MOTOR_ISR_STATS
+    ESP_RETURN_ON_FALSE(motor_control && stats, ESP_ERR_INVALID_ARG, MOTOR_TAG, "invalid argument");
+    taskENTER_CRITICAL(motor_control->motor_spinlock);
+    *stats = motor_control->isr_stats;
+    taskEXIT_CRITICAL(motor_control->motor_spinlock);
+    return ESP_OK;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+/* 按先后顺序取出最近至多 capacity 次服务的执行时间（CPU 周期） */
+esp_err_t stepper_get_isr_cycles(motor_control_t* motor_control, uint32_t* cycles, size_t capacity, size_t* count)
+{
+#if CONFIG_STEP_MOTOR_ISR_STATS
+    ESP_RETURN_ON_FALSE(motor_control && cycles && count, ESP_ERR_INVALID_ARG, MOTOR_TAG, "invalid argument");
+    taskENTER_CRITICAL(motor_control->motor_spinlock);
+    uint32_t total = motor_control->isr_stats.isr_count;
+    size_t n = total < STEPPER_ISR_CYCLE_SAMPLES ? total : STEPPER_ISR_CYCLE_SAMPLES;
+    if (n > capacity)
+    {
+        n = capacity;
+    }
+    for (size_t i = 0; i < n; i++)
+    {
+        cycles[i] = motor_control->isr_cycles[(total - n + i) % STEPPER_ISR_CYCLE_SAMPLES];
+    }
+    taskEXIT_CRITICAL(motor_control->motor_spinlock);
+    *count = n;
+    return ESP_OK;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+/* 清零步进中断统计 */
+esp_err_t stepper_reset_isr_stats(motor_control_t* motor_control)
+{
+#if CONFIG_STEP_MOTOR_ISR_STATS
+    ESP_RETURN_ON_FALSE(motor_control, ESP_ERR_INVALID_ARG, MOTOR_TAG, "invalid argument");
+    taskENTER_CRITICAL(motor_control->motor_spinlock);
+    memset(&motor_control->isr_stats, 0, sizeof(stepper_isr_stats_t));
+    taskEXIT_CRITICAL(motor_control->motor_spinlock);
+    return ESP_OK;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+/* 打印步进中断统计 */
+esp_err_t stepper_dump_isr_stats(motor_control_t* motor_control)
+{
+    stepper_isr_stats_t stats;
+    ESP_RETURN_ON_ERROR(stepper_get_isr_stats(motor_control, &stats), MOTOR_TAG, "no ISR stats");
+
+    ESP_LOGI(MOTOR_TAG, "ISR: %"PRIu32" calls, %"PRIu32" late, %"PRIu32" missed, max latency %"PRIu32"us",
+             stats.isr_count, stats.late_alarms, stats.missed_alarms, stats.max_latency_us);
+    ESP_LOGI(MOTOR_TAG, "ISR: avg %"PRIu32" cycles, max %"PRIu32" cycles",
+             stats.isr_count ? (uint32_t)(stats.total_cycles / stats.isr_count) : 0, stats.max_cycles);
+    for (int i = 0; i < STEPPER_ISR_HIST_BUCKETS; i++)
+    {
+        if (stats.cycles_hist[i])
+        {
+            ESP_LOGI(MOTOR_TAG, "ISR cycles %s%u: %"PRIu32, i == STEPPER_ISR_HIST_BUCKETS - 1 ? ">=" : "",
+                     1u << i, stats.cycles_hist[i]);
+        }
+    }
+    for (int i = 0; i < STEPPER_ISR_HIST_BUCKETS; i++)
+    {
+        if (stats.latency_hist[i])
+        {
+            ESP_LOGI(MOTOR_TAG, "ISR latency %s%dus: %"PRIu32, i == STEPPER_ISR_HIST_BUCKETS - 1 ? ">=" : "", i,
+                     stats.latency_hist[i]);
+        }
+    }
+    return ESP_OK;
+}
+
+/* 由回放后端完成的运动段数，其余的都由步进中断逐步输出 */
+uint32_t stepper_get_playback_moves(const motor_control_t* motor_control)
+{
+    return motor_control->playback_moves;
 }
 
 /* 获取绝对位置 */
@@ -73,29 +906,267 @@ int stepper_get_position(const motor_control_t* motor_control)
 /* 位置归零或设定 */
 void stepper_set_position(motor_control_t* motor_control, int position)
 {
+    xSemaphoreTake(motor_control->motor_mutex, portMAX_DELAY);
     motor_control->motion.absolute_position = position;
+    motor_control->arc_carry = 0;
+    xSemaphoreGive(motor_control->motor_mutex);
     ESP_LOGD(MOTOR_TAG, "Position set to %d", position);
 }
 
+/* 同时读取位置和相位下标，扫动期间两者也来自同一步 */
+void stepper_get_position_phase(motor_control_t* motor_control, int* position, int* step_index)
+{
+    taskENTER_CRITICAL(motor_control->motor_spinlock);
+    *position = motor_control->motion.absolute_position;
+    *step_index = motor_control->motion.step_index;
+    taskEXIT_CRITICAL(motor_control->motor_spinlock);
+}
+
+/* 恢复断电前的位置和最后通电的相位：转子停在该相位的位置上，下一步从相邻的相位开始，不会跳拍 */
+esp_err_t stepper_restore_position(motor_control_t* motor_control, int position, int step_index)
+{
+    ESP_RETURN_ON_FALSE(motor_control && step_index >= 0 && step_index < 8, ESP_ERR_INVALID_ARG, MOTOR_TAG,
+                        "invalid argument");
+    ESP_RETURN_ON_FALSE(!stepper_is_moving(motor_control), ESP_ERR_INVALID_STATE, MOTOR_TAG, "motor is moving");
+    xSemaphoreTake(motor_control->motor_mutex, portMAX_DELAY);
+    motor_control->motion.absolute_position = position;
+    motor_control->motion.step_index = step_index;
+    motor_control->arc_carry = 0;
+    xSemaphoreGive(motor_control->motor_mutex);
+    ESP_LOGI(MOTOR_TAG, "Position restored to %d, phase %d", position, step_index);
+    return ESP_OK;
+}
+
 /* 检查电机是否正在运动 */
 bool stepper_is_moving(const motor_control_t* motor_control)
 {
-    return motor_control->motion.executed_steps < motor_control->motion.total_steps;
+    return atomic_load(&motor_control->motion.running);
 }
 
-/* 立即停止电机 */
+/* 立即停止电机，丢弃缓冲中的段，被打断的运动不会记为完成 */
 void stepper_stop(motor_control_t* motor_control)
 {
-    motor_control->motion.total_steps = motor_control->motion.executed_steps;
-    gptimer_stop(motor_control->motor_gptimer);
+    xSemaphoreTake(motor_control->motor_mutex, portMAX_DELAY);
+    stepper_playback_abort_locked(motor_control);
+    stepper_timer_cancel(motor_control);
     taskENTER_CRITICAL(motor_control->motor_spinlock);
-    dedic_gpio_bundle_write(motor_control->motor_dedic_gpio_bundle, 0x1111, 0x0000);
+    step_planner_reset(&motor_control->planner);
+    motor_control->motion.total_steps = motor_control->motion.executed_steps;
+    motor_control->motion.loaded = false;
+    motor_control->motion.seq = 0;
+    motor_control->motion.sweep = false;
+    atomic_store(&motor_control->motion.running, false);
+    stepper_write_phase(motor_control, 0x0000);
     taskEXIT_CRITICAL(motor_control->motor_spinlock);
+    stepper_idle_locked(motor_control);
+    xSemaphoreGive(motor_control->motor_mutex);
     ESP_LOGD(MOTOR_TAG, "Motor stopped");
 }
 
+/* 设置默认驱动方式 */
+esp_err_t stepper_set_drive_mode(motor_control_t* motor_control, stepper_drive_mode_t mode)
+{
+    ESP_RETURN_ON_FALSE(motor_control && (unsigned)mode < sizeof(drive_modes) / sizeof(drive_modes[0]),
+                        ESP_ERR_INVALID_ARG, MOTOR_TAG, "invalid argument");
+    motor_control->drive_mode = mode;
+    return ESP_OK;
+}
+
+/* 驱动方式对应的每圈步数 */
+int stepper_steps_per_rev(stepper_drive_mode_t mode)
+{
+    return stepper_drive_desc(mode)->steps_per_rev;
+}
+
+/* 整数转速换算为该驱动方式下每步的微秒数 */
+static int stepper_rpm_to_us(uint32_t rpm, stepper_drive_mode_t mode)
+{
+    return (int)(60000000u / (rpm * (uint32_t)stepper_steps_per_rev(mode)));
+}
+
+/* 加速表允许的最高转速。加速表以半步计，各驱动方式共用同一条速度-位置曲线，最高转速也相同；
+ * 整步方式在这一转速下力矩更大，要跑得更快须用 stepper_set_ramp() 提高 max_rate */
+uint32_t stepper_max_rpm(const motor_control_t* motor_control)
+{
+    return motor_control->ramp.config.max_rate * 60 / STEPS_PER_REV;
+}
+
+/* 从静止走 half_steps 个半步再停下所需的时间，按当前加速表计算，用于追赶规划 */
+uint64_t stepper_move_duration_us(const motor_control_t* motor_control, uint32_t half_steps, uint32_t rpm,
+                                  stepper_drive_mode_t mode)
+{
+    const stepper_drive_desc_t* desc = stepper_drive_desc(mode);
+    int speed_us = rpm ? stepper_rpm_to_us(rpm, mode) : MIN_SPEED_US;
+    if (speed_us < MIN_SPEED_US) speed_us = MIN_SPEED_US;
+
+    step_profile_t profile;
+    // 起点相位未知，按已对齐估计
+    step_profile_init(&motor_control->ramp, stepper_isr_steps(desc, desc->parity, half_steps),
+                      speed_us / desc->stride, desc->stride - 1, &profile);
+    return step_profile_duration_us(&motor_control->ramp, &profile, 0);
+}
+
+/* 开始扫动：first_delay_us 后走第一步，之后每 interval_q16 走一个半步，电机须静止 */
+esp_err_t stepper_sweep_start(motor_control_t* motor_control, uint64_t interval_q16, uint32_t first_delay_us, bool cw)
+{
+    ESP_RETURN_ON_FALSE(motor_control && interval_q16 >= ((uint64_t)MIN_SPEED_US << 16), ESP_ERR_INVALID_ARG,
+                        MOTOR_TAG, "invalid argument");
+    esp_err_t ret = ESP_OK;
+    xSemaphoreTake(motor_control->motor_mutex, portMAX_DELAY);
+    if (stepper_is_moving(motor_control) || step_planner_count(&motor_control->planner))
+    {
+        ret = ESP_ERR_INVALID_STATE;
+    }
+    else
+    {
+        motor_motion_t* motion = &motor_control->motion;
+        taskENTER_CRITICAL(motor_control->motor_spinlock);
+        motion->sweep = true;
+        motion->sweep_coils_on = false;
+        motion->direction_cw = cw;
+        motor_control->sweep_interval_q16 = interval_q16;
+        taskEXIT_CRITICAL(motor_control->motor_spinlock);
+        // 第一步的计数值在排入组定时器时确定
+        stepper_timer_start_locked(motor_control, first_delay_us ? first_delay_us : 1);
+    }
+    xSemaphoreGive(motor_control->motor_mutex);
+    return ret;
+}
+
+/* 修改扫动间隔，从下一步之后的间隔开始生效 */
+esp_err_t stepper_sweep_set_interval(motor_control_t* motor_control, uint64_t interval_q16)
+{
+    ESP_RETURN_ON_FALSE(motor_control && interval_q16 >= ((uint64_t)MIN_SPEED_US << 16), ESP_ERR_INVALID_ARG,
+                        MOTOR_TAG, "invalid argument");
+    taskENTER_CRITICAL(motor_control->motor_spinlock);
+    motor_control->sweep_interval_q16 = interval_q16;
+    taskEXIT_CRITICAL(motor_control->motor_spinlock);
+    return ESP_OK;
+}
+
+/* 是否处于扫动模式 */
+bool stepper_is_sweeping(const motor_control_t* motor_control)
+{
+    return motor_control->motion.sweep;
+}
+
+/* 扫动中的连续位置（半步，Q16 定点）：整步位置加上当前间隔已经过去的比例，用作锁相环的鉴相 */
+int64_t stepper_sweep_position_q16(const motor_control_t* motor_control)
+{
+    const motor_motion_t* motion = &motor_control->motion;
+    uint64_t now = 0;
+    gptimer_get_raw_count(motor_control->group->timer, &now);
+
+    taskENTER_CRITICAL(motor_control->motor_spinlock);
+    int64_t position = motion->absolute_position;
+    uint64_t last_q16 = motion->sweep_last_step << 16;
+    uint64_t span_q16 = motion->sweep_next_q16 - last_q16;
+    bool cw = motion->direction_cw;
+    bool sweep = motion->sweep;
+    taskEXIT_CRITICAL(motor_control->motor_spinlock);
+
+    // 读计数后 ISR 可能刚走了一步，此时已过去的比例按 0 计
+    uint64_t frac = 0;
+    if (sweep && span_q16 && (now << 16) > last_q16)
+    {
+        frac = (((now << 16) - last_q16) << 16) / span_q16;
+        frac = frac > 0xFFFF ? 0xFFFF : frac;
+    }
+    return position * 65536 + (cw ? (int64_t)frac : -(int64_t)frac);
+}
+
+/* 向下取整的除法，除数为正 */
+static inline int64_t floor_div(int64_t num, int64_t den)
+{
+    int64_t q = num / den;
+    return (num % den < 0) ? q - 1 : q;
+}
+
+/* 按角秒相对转动：以“角秒 x 半步”为单位精确累加，取最接近的整步，余量留到下一次，
+ * 相对转动的累计误差因此始终不超过半个驱动步 */
+static stepper_move_handle_t stepper_rotate_arcsec_us(motor_control_t* motor_control, int32_t arcsec, bool cw,
+                                                      int speed_us, stepper_drive_mode_t mode)
+{
+    const stepper_drive_desc_t* desc = stepper_drive_desc(mode);
+    const int64_t quantum = (int64_t)desc->stride * STEPPER_ARCSEC_PER_REV;
+    stepper_move_handle_t move = 0;
+
+    xSemaphoreTake(motor_control->motor_mutex, portMAX_DELAY);
+    int64_t units = motor_control->arc_carry + (int64_t)(cw ? arcsec : -arcsec) * STEPS_PER_REV;
+    int64_t steps = floor_div(units + quantum / 2, quantum);
+    stepper_cmd_t cmd = {
+        .steps = (int)(steps < 0 ? -steps : steps),
+        .dir_cw = steps >= 0,
+        .speed_us = speed_us,
+        .mode = mode,
+    };
+    // 命令被拒绝时余量不变，下一次转动仍然补上
+    if (stepper_enqueue_locked(motor_control, &cmd, &move) == ESP_OK)
+    {
+        motor_control->arc_carry = (int32_t)(units - steps * quantum);
+    }
+    xSemaphoreGive(motor_control->motor_mutex);
+    return move;
+}
+
+/* 以指定驱动方式按角秒旋转电机，只用整数运算 */
+stepper_move_handle_t stepper_rotate_arcsec(motor_control_t* motor_control, int32_t arcsec, bool cw, uint32_t rpm,
+                                            stepper_drive_mode_t mode)
+{
+    ESP_RETURN_ON_FALSE(motor_control && rpm, 0, MOTOR_TAG, "invalid argument");
+    int speed_us = stepper_rpm_to_us(rpm, mode);
+    return stepper_rotate_arcsec_us(motor_control, arcsec, cw, speed_us, mode);
+}
+
+/* 转到表盘上的绝对位置（半步，按每圈取模），从所有已规划运动的终点出发走最短方向，
+ * 之前丢失的步数或漏掉的跳动都在这一次里补上 */
+stepper_move_handle_t stepper_move_to(motor_control_t* motor_control, int32_t target, uint32_t rpm,
+                                      stepper_drive_mode_t mode)
+{
+    ESP_RETURN_ON_FALSE(motor_control && rpm, 0, MOTOR_TAG, "invalid argument");
+    stepper_move_handle_t move = 0;
+    stepper_cmd_t cmd = {
+        .speed_us = stepper_rpm_to_us(rpm, mode),
+        .mode = mode,
+    };
+
+    xSemaphoreTake(motor_control->motor_mutex, portMAX_DELAY);
+    stepper_sync_plan_locked(motor_control);
+    int32_t diff = (target - motor_control->plan_position) % STEPS_PER_REV;
+    if (diff > STEPS_PER_REV / 2)
+    {
+        diff -= STEPS_PER_REV;
+    }
+    else if (diff <= -STEPS_PER_REV / 2)
+    {
+        diff += STEPS_PER_REV;
+    }
+    cmd.dir_cw = diff >= 0;
+    uint32_t half_steps = cmd.dir_cw ? diff : -diff;
+    cmd.steps = (int)(half_steps / stepper_drive_desc(mode)->stride);
+    stepper_push_locked(motor_control, &cmd, half_steps, &move);
+    xSemaphoreGive(motor_control->motor_mutex);
+    return move;
+}
+
+/* 按角度旋转电机，使用默认驱动方式 */
+stepper_move_handle_t stepper_rotate_angle(motor_control_t* motor_control, float degree, bool cw, float rpm)
+{
+    return stepper_rotate_angle_mode(motor_control, degree, cw, rpm, motor_control->drive_mode);
+}
+
+/* 以指定驱动方式按角度旋转电机，角度取整到角秒后与整数接口共用余量 */
+stepper_move_handle_t stepper_rotate_angle_mode(motor_control_t* motor_control, float degree, bool cw, float rpm,
+                                                stepper_drive_mode_t mode)
+{
+    int steps_per_rev = stepper_steps_per_rev(mode);
+    int32_t arcsec = (int32_t)(degree * 3600.0f + 0.5f);
+    int us_per_step = (int)(60.0f * 1000000 / (rpm * steps_per_rev));
+    return stepper_rotate_arcsec_us(motor_control, arcsec, cw, us_per_step, mode);
+}
+
 /* 按时间旋转电机（毫秒）*/
-void stepper_rotate_time(motor_control_t* motor_control, int duration_ms, bool dir_cw, int speed_us)
+stepper_move_handle_t stepper_rotate_time(motor_control_t* motor_control, int duration_ms, bool dir_cw, int speed_us)
 {
     if (speed_us < MIN_SPEED_US) speed_us = MIN_SPEED_US;
     
@@ -106,14 +1177,15 @@ void stepper_rotate_time(motor_control_t* motor_control, int duration_ms, bool d
         .steps = total_steps,
         .dir_cw = dir_cw,
         .speed_us = speed_us,
+        .mode = motor_control->drive_mode,
     };
-    xQueueSend(motor_control->motor_cmd_queue, &cmd, portMAX_DELAY);
+    return stepper_submit(motor_control, &cmd);
 }
 
 /* 旋转到特定角度 */
-void stepper_rotate_to_angle(motor_control_t* motor_control, float target_angle, float rpm)
+stepper_move_handle_t stepper_rotate_to_angle(motor_control_t* motor_control, float target_angle, float rpm)
 {
-    // 计算当前位置对应的角度
+    // 计算当前位置对应的角度，位置以半步计，与驱动方式无关
     float current_angle = (float)(motor_control->motion.absolute_position % STEPS_PER_REV) * 360.0f / STEPS_PER_REV;
     
     // 计算需要旋转的角度差
@@ -131,95 +1203,215 @@ void stepper_rotate_to_angle(motor_control_t* motor_control, float target_angle,
     float abs_angle_diff = dir_cw ? angle_diff : -angle_diff;
     
     // 调用现有的角度旋转函数
-    stepper_rotate_angle(motor_control, abs_angle_diff, dir_cw, rpm);
+    return stepper_rotate_angle(motor_control, abs_angle_diff, dir_cw, rpm);
 }
 
-/* 初始化驱动 */
-motor_control_t* stepper_driver_init(void)
+/* 创建电机组：一个 1MHz 的 gptimer，组内电机在同一个中断里按截止时间先后服务 */
+esp_err_t stepper_group_new(stepper_group_t** ret_group)
 {
-    const int bundle_gpios[] = {35, 36, 37, 38};
+    ESP_RETURN_ON_FALSE(ret_group, ESP_ERR_INVALID_ARG, MOTOR_TAG, "invalid argument");
+    stepper_group_t* group = pvPortMalloc(sizeof(stepper_group_t));
+    ESP_RETURN_ON_FALSE(group, ESP_ERR_NO_MEM, MOTOR_TAG, "no mem for group");
+    memset(group, 0, sizeof(stepper_group_t));
+    portMUX_INITIALIZE(&group->spinlock);
+
+    group->mutex = xSemaphoreCreateMutex();
+    if (!group->mutex)
+    {
+        free(group);
+        ESP_LOGE(MOTOR_TAG, "Failed to allocate mutex");
+        return ESP_ERR_NO_MEM;
+    }
 
-    ////////////////////////////////////////////////////////////////// GPIO配置
-    gpio_config_t io_conf = {
-        .pin_bit_mask = 0,
-        .mode = GPIO_MODE_OUTPUT,
-        .pull_up_en = GPIO_PULLUP_ENABLE,
-        .pull_down_en = GPIO_PULLDOWN_DISABLE,
-        .intr_type = GPIO_INTR_DISABLE
+    ///////////////////////////////////////////////////////////////// GPTimer配置（1MHz分辨率）
+    // XTAL 时钟不随动态调频变化，运动期间只需持有禁止浅睡眠锁而非 APB 最高频率锁
+    gptimer_config_t timer_config = {
+        .clk_src = GPTIMER_CLK_SRC_XTAL,
+        .direction = GPTIMER_COUNT_UP,
+        .resolution_hz = 1000000,
+    };
+    esp_err_t ret = gptimer_new_timer(&timer_config, &group->timer);
+    if (ret != ESP_OK)
+    {
+        vSemaphoreDelete(group->mutex);
+        free(group);
+        ESP_LOGE(MOTOR_TAG, "Failed to allocate gptimer");
+        return ret;
+    }
+
+    gptimer_event_callbacks_t cbs = {
+        .on_alarm = stepper_group_on_alarm_cb,
     };
+    ESP_ERROR_CHECK(gptimer_register_event_callbacks(group->timer, &cbs, group));
 
-    for (int i = 0; i < sizeof(bundle_gpios) / sizeof(bundle_gpios[0]); i++)
+    *ret_group = group;
+    return ESP_OK;
+}
+
+/* 删除电机组，组内的电机须先全部反初始化 */
+esp_err_t stepper_group_del(stepper_group_t* group)
+{
+    ESP_RETURN_ON_FALSE(group, ESP_ERR_INVALID_ARG, MOTOR_TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(!group->motor_count, ESP_ERR_INVALID_STATE, MOTOR_TAG, "group still has motors");
+    if (group->timer_enabled)
     {
-        io_conf.pin_bit_mask |= 1ULL << bundle_gpios[i];
+        gptimer_stop(group->timer);
+        gptimer_disable(group->timer);
     }
-    ESP_ERROR_CHECK(gpio_config(&io_conf));
+    gptimer_del_timer(group->timer);
+    vSemaphoreDelete(group->mutex);
+    if (group == s_default_group)
+    {
+        s_default_group = NULL;
+    }
+    free(group);
+    return ESP_OK;
+}
 
-    //////////////////////////////////////////////////////////////////////////////封装结构体
-    motor_control_t* motor_control = pvPortMalloc(sizeof(motor_control_t));
-    if (!motor_control)
+/* 在电机组上创建一个电机，按 config 选择逐步输出和整段回放的后端 */
+motor_control_t* stepper_driver_new(stepper_group_t* group, const stepper_config_t* config)
+{
+    ESP_RETURN_ON_FALSE(group && config, NULL, MOTOR_TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(!config->output || config->output->write, NULL, MOTOR_TAG, "output can not write phases");
+    ESP_RETURN_ON_FALSE(!config->playback || (config->playback->play && config->playback->max_items), NULL,
+                        MOTOR_TAG, "playback output can not play");
+
+    ////////////////////////////////////////////////////////////////// 输出后端
+    // 失败时只释放这里创建的资源，调用者传入的 output 和 playback 仍归调用者
+    esp_err_t ret = ESP_OK;
+    motor_control_t* motor_control = NULL;
+    step_output_t* output = config->output;
+    if (!output)
     {
-        ESP_LOGE(MOTOR_TAG, "Failed to allocate motor_control");
-        return NULL;
+        step_dedic_output_config_t dedic_config;
+        memcpy(dedic_config.phase_gpios, config->phase_gpios, sizeof(dedic_config.phase_gpios));
+        ESP_GOTO_ON_ERROR(step_new_dedic_output(&dedic_config, &output), err, MOTOR_TAG, "create output failed");
     }
+
+    //////////////////////////////////////////////////////////////////////////////封装结构体
+    motor_control = pvPortMalloc(sizeof(motor_control_t));
+    ESP_GOTO_ON_FALSE(motor_control, ESP_ERR_NO_MEM, err, MOTOR_TAG, "Failed to allocate motor_control");
     memset(motor_control, 0, sizeof(motor_control_t));
+    motor_control->group = group;
+    motor_control->output = output;
 
     ///////////////////////////////////////////////////////////////// 自旋锁
     motor_control->motor_spinlock = pvPortMalloc(sizeof(portMUX_TYPE));
-    if (!motor_control->motor_spinlock)
-    {
-        ESP_LOGE(MOTOR_TAG, "Failed to allocate spinlock");
-        return NULL;
-    }
+    ESP_GOTO_ON_FALSE(motor_control->motor_spinlock, ESP_ERR_NO_MEM, err, MOTOR_TAG, "Failed to allocate spinlock");
     portMUX_INITIALIZE(motor_control->motor_spinlock);
 
+    motor_control->motor_mutex = xSemaphoreCreateMutex();
+    ESP_GOTO_ON_FALSE(motor_control->motor_mutex, ESP_ERR_NO_MEM, err, MOTOR_TAG, "Failed to allocate mutex");
 
-    ///////////////////////////////////////////////////////////////// 专用GPIO束配置
-    dedic_gpio_bundle_config_t bundle_config = {
-        .gpio_array = bundle_gpios,
-        .array_size = sizeof(bundle_gpios) / sizeof(bundle_gpios[0]),
-        .flags = {.out_en = 1},
+    ///////////////////////////////////////////////////////////////// 加速表
+    const step_ramp_config_t ramp_config = {
+        .start_rate = RAMP_START_RATE,
+        .max_rate = RAMP_MAX_RATE,
+        .accel = RAMP_ACCEL,
+        .shape = STEP_RAMP_SHAPE_S_CURVE,
     };
-    ESP_ERROR_CHECK(dedic_gpio_new_bundle(&bundle_config, &motor_control->motor_dedic_gpio_bundle));
+    ESP_GOTO_ON_ERROR(step_ramp_build(&motor_control->ramp, &ramp_config), err, MOTOR_TAG, "build ramp failed");
 
-    ///////////////////////////////////////////////////////////////// GPTimer配置（1MHz分辨率）
-    gptimer_config_t timer_config = {
-        .clk_src = GPTIMER_CLK_SRC_DEFAULT,
-        .direction = GPTIMER_COUNT_UP,
-        .resolution_hz = 1000000,
-    };
-    ESP_ERROR_CHECK(gptimer_new_timer(&timer_config, &motor_control->motor_gptimer));
+    ///////////////////////////////////////////////////////////////// 整段回放
+    if (config->playback)
+    {
+        motor_control->wave = pvPortMalloc(config->playback->max_items * sizeof(step_wave_item_t));
+        ESP_GOTO_ON_FALSE(motor_control->wave, ESP_ERR_NO_MEM, err, MOTOR_TAG, "Failed to allocate playback wave");
+        motor_control->playback = config->playback;
+        motor_control->playback_min_rate = config->playback_min_rate;
+    }
 
-    gptimer_event_callbacks_t cbs = {
-        .on_alarm = gptimer_on_alarm_cb,
-    };
-    ESP_ERROR_CHECK(gptimer_register_event_callbacks(motor_control->motor_gptimer, &cbs, &motor_control));
-    ESP_ERROR_CHECK(gptimer_enable(motor_control->motor_gptimer));
+    ///////////////////////////////////////////////////////////////// 加入电机组
+    xSemaphoreTake(group->mutex, portMAX_DELAY);
+    bool full = group->motor_count >= STEPPER_GROUP_MAX_MOTORS;
+    if (!full)
+    {
+        group->motor_count++;
+    }
+    xSemaphoreGive(group->mutex);
+    ESP_GOTO_ON_FALSE(!full, ESP_ERR_NO_MEM, err, MOTOR_TAG, "Group already has %d motors", STEPPER_GROUP_MAX_MOTORS);
 
     // 初始状态
     taskENTER_CRITICAL(motor_control->motor_spinlock);
-    dedic_gpio_bundle_write(motor_control->motor_dedic_gpio_bundle, 0x1111, 0x0000);
+    stepper_write_phase(motor_control, 0x0000);
     taskEXIT_CRITICAL(motor_control->motor_spinlock);
 
-    ESP_LOGI(MOTOR_TAG, "Driver initialized @ GPIO%d-%d",
-             bundle_gpios[0], bundle_gpios[3]);
+    ESP_LOGI(MOTOR_TAG, "Driver initialized @ GPIO%d-%d%s",
+             config->phase_gpios[0], config->phase_gpios[3], config->playback ? ", playback enabled" : "");
 
     return motor_control;
+
+err:
+    ESP_LOGE(MOTOR_TAG, "Driver init failed: %s", esp_err_to_name(ret));
+    if (motor_control)
+    {
+        if (motor_control->motor_mutex)
+        {
+            vSemaphoreDelete(motor_control->motor_mutex);
+        }
+        free(motor_control->wave);
+        free(motor_control->motor_spinlock);
+        free(motor_control);
+    }
+    if (output && output != config->output)
+    {
+        output->del(output);
+    }
+    return NULL;
 }
 
-/* 反初始化释放资源 */
+/* 初始化驱动：默认接法，默认电机组 */
+motor_control_t* stepper_driver_init(void)
+{
+    if (!s_default_group && stepper_group_new(&s_default_group) != ESP_OK)
+    {
+        return NULL;
+    }
+    stepper_config_t config = STEPPER_DEFAULT_CONFIG();
+#if CONFIG_STEP_MOTOR_RMT_PLAYBACK
+    // 快速调整交给 RMT 整段回放，分钟跳动仍由步进中断输出
+    step_rmt_output_config_t rmt_config = {
+        .max_items = CONFIG_STEP_MOTOR_PLAYBACK_MAX_STEPS + 1,
+    };
+    memcpy(rmt_config.phase_gpios, config.phase_gpios, sizeof(rmt_config.phase_gpios));
+    if (step_new_rmt_output(&rmt_config, &config.playback) == ESP_OK)
+    {
+        config.playback_min_rate = CONFIG_STEP_MOTOR_PLAYBACK_MIN_RATE;
+    }
+    else
+    {
+        ESP_LOGW(MOTOR_TAG, "RMT playback unavailable, every step goes through the step ISR");
+    }
+#endif
+    motor_control_t* motor_control = stepper_driver_new(s_default_group, &config);
+    if (!motor_control && config.playback)
+    {
+        config.playback->del(config.playback);
+    }
+    return motor_control;
+}
+
+/* 反初始化释放资源，电机组保留，由 stepper_group_del() 删除 */
 void stepper_driver_deinit(motor_control_t* motor_control)
 {
-    taskENTER_CRITICAL_ISR(motor_control->motor_spinlock);
-    dedic_gpio_bundle_write(motor_control->motor_dedic_gpio_bundle, 0x1111, 0x0000);
-    taskEXIT_CRITICAL_ISR(motor_control->motor_spinlock);
+    stepper_stop(motor_control);
 
-    dedic_gpio_del_bundle(motor_control->motor_dedic_gpio_bundle);
-    motor_control->motor_dedic_gpio_bundle = NULL;
+    motor_control->output->del(motor_control->output);
+    motor_control->output = NULL;
+    if (motor_control->playback)
+    {
+        motor_control->playback->del(motor_control->playback);
+        motor_control->playback = NULL;
+    }
+    free(motor_control->wave);
 
-    gptimer_disable(motor_control->motor_gptimer);
-    gptimer_del_timer(motor_control->motor_gptimer);
+    stepper_group_t* group = motor_control->group;
+    xSemaphoreTake(group->mutex, portMAX_DELAY);
+    group->motor_count--;
+    xSemaphoreGive(group->mutex);
 
+    vSemaphoreDelete(motor_control->motor_mutex);
     free(motor_control->motor_spinlock);
     free(motor_control);
     ESP_LOGI(MOTOR_TAG, "Driver deinitialized");
-}
\ No newline at end of file
+}
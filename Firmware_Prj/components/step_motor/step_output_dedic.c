@@ -0,0 +1,79 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include "driver/dedic_gpio.h"
+#include "driver/gpio.h"
+#include "esp_attr.h"
+#include "esp_check.h"
+#include "step_output.h"
+
+static const char *TAG = "step_output";
+
+typedef struct {
+    step_output_t base;
+    dedic_gpio_bundle_handle_t bundle;
+} step_dedic_output_t;
+
+static void IRAM_ATTR step_dedic_output_write(step_output_t *output, uint32_t phase)
+{
+    step_dedic_output_t *dedic = __containerof(output, step_dedic_output_t, base);
+    dedic_gpio_bundle_write(dedic->bundle, STEP_OUTPUT_COIL_MASK, phase);
+}
+
+static esp_err_t step_dedic_output_del(step_output_t *output)
+{
+    step_dedic_output_t *dedic = __containerof(output, step_dedic_output_t, base);
+    dedic_gpio_bundle_write(dedic->bundle, STEP_OUTPUT_COIL_MASK, 0);
+    dedic_gpio_del_bundle(dedic->bundle);
+    free(dedic);
+    return ESP_OK;
+}
+
+esp_err_t step_new_dedic_output(const step_dedic_output_config_t *config, step_output_t **ret_output)
+{
+    ESP_RETURN_ON_FALSE(config && ret_output, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    const int gpio_count = sizeof(config->phase_gpios) / sizeof(config->phase_gpios[0]);
+
+    gpio_config_t io_conf = {
+        .pin_bit_mask = 0,
+        .mode = GPIO_MODE_OUTPUT,
+        .pull_up_en = GPIO_PULLUP_DISABLE, // A pull-up would energize the ULN2003 coils while the pin floats
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_DISABLE,
+    };
+    for (int i = 0; i < gpio_count; i++) {
+        io_conf.pin_bit_mask |= 1ULL << config->phase_gpios[i];
+    }
+    ESP_RETURN_ON_ERROR(gpio_config(&io_conf), TAG, "config GPIO failed");
+    for (int i = 0; i < gpio_count; i++) {
+        // Keep the normal configuration in light sleep so the coil outputs stay low
+        ESP_RETURN_ON_ERROR(gpio_sleep_sel_dis(config->phase_gpios[i]), TAG, "sleep select failed");
+    }
+
+    step_dedic_output_t *dedic = calloc(1, sizeof(step_dedic_output_t));
+    ESP_RETURN_ON_FALSE(dedic, ESP_ERR_NO_MEM, TAG, "no mem for dedic output");
+
+    // Every core has 8 dedicated GPIO outputs, enough for two 4-wire motors
+    dedic_gpio_bundle_config_t bundle_config = {
+        .gpio_array = config->phase_gpios,
+        .array_size = gpio_count,
+        .flags = {.out_en = 1},
+    };
+    esp_err_t ret = dedic_gpio_new_bundle(&bundle_config, &dedic->bundle);
+    if (ret != ESP_OK) {
+        free(dedic);
+        ESP_LOGE(TAG, "no dedicated GPIO channels left for GPIO%d-%d", config->phase_gpios[0],
+                 config->phase_gpios[gpio_count - 1]);
+        return ret;
+    }
+    dedic_gpio_bundle_write(dedic->bundle, STEP_OUTPUT_COIL_MASK, 0);
+
+    dedic->base.write = step_dedic_output_write;
+    dedic->base.del = step_dedic_output_del;
+    *ret_output = &dedic->base;
+    return ESP_OK;
+}
@@ -0,0 +1,288 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include "sdkconfig.h"
+#include "driver/rmt_tx.h"
+#include "esp_attr.h"
+#include "esp_check.h"
+#include "esp_pm.h"
+#include "esp_rom_gpio.h"
+#include "soc/gpio_reg.h"
+#include "soc/soc.h"
+#include "step_output.h"
+
+static const char *TAG = "step_output_rmt";
+
+#define STEP_RMT_COILS 4
+#define STEP_RMT_RESOLUTION_HZ 1000000 // Same 1us tick as the step timer, wave durations map 1:1
+#define STEP_RMT_MAX_DURATION 0x7FFF   // Duration field of an RMT symbol half is 15 bits
+
+typedef struct {
+    step_output_t base;
+    int gpios[STEP_RMT_COILS];
+    rmt_channel_handle_t channels[STEP_RMT_COILS];
+    rmt_encoder_handle_t encoders[STEP_RMT_COILS]; // Copy encoders keep state, one per channel
+    rmt_sync_manager_handle_t sync;                // Starts the four channels on the same clock edge
+    rmt_symbol_word_t *symbols[STEP_RMT_COILS];    // Run length encoded level sequence of each coil
+    size_t symbol_cap;                             // Capacity of each `symbols` buffer
+    uint32_t rmt_signals[STEP_RMT_COILS];          // GPIO matrix signals of the RMT channels
+    uint32_t prev_signals[STEP_RMT_COILS];         // Signals that drove the pins before the playback
+    atomic_int pending;                            // Channels still transmitting
+    atomic_bool playing;                           // Cleared by whoever ends the playback first
+    step_output_done_cb_t done_cb;
+    void *done_arg;
+#if CONFIG_PM_ENABLE
+    esp_pm_lock_handle_t pm_lock; // The XTAL clock of the RMT stops in light sleep
+#endif
+} step_rmt_output_t;
+
+static uint32_t step_rmt_out_signal(int gpio)
+{
+    return REG_GET_FIELD(GPIO_FUNC0_OUT_SEL_CFG_REG + 4 * gpio, GPIO_FUNC0_OUT_SEL);
+}
+
+static void IRAM_ATTR step_rmt_route(const int *gpios, const uint32_t *signals)
+{
+    for (int i = 0; i < STEP_RMT_COILS; i++) {
+        esp_rom_gpio_connect_out_signal(gpios[i], signals[i], false, false);
+    }
+}
+
+/* Append a run of `level` lasting `duration` ticks, splitting it where it overflows a symbol half */
+static bool step_rmt_put_run(rmt_symbol_word_t *out, size_t cap, size_t *halves, uint32_t level, uint64_t duration)
+{
+    while (duration) {
+        uint32_t part = duration > STEP_RMT_MAX_DURATION ? STEP_RMT_MAX_DURATION : (uint32_t)duration;
+        size_t index = *halves / 2;
+        if (index >= cap) {
+            return false;
+        }
+        if (*halves & 1) {
+            out[index].level1 = level;
+            out[index].duration1 = part;
+        } else {
+            out[index].level0 = level;
+            out[index].duration0 = part;
+            out[index].duration1 = 0; // End marker until the second half is filled
+        }
+        (*halves)++;
+        duration -= part;
+    }
+    return true;
+}
+
+/* Run length encode one coil of the wave, returns the number of symbols or 0 if it does not fit */
+static size_t step_rmt_encode_coil(const step_wave_item_t *wave, size_t count, int coil, rmt_symbol_word_t *out,
+                                   size_t cap)
+{
+    size_t halves = 0;
+    uint32_t level = (wave[0].phase >> coil) & 1;
+    uint64_t run = 0;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t item_level = (wave[i].phase >> coil) & 1;
+        if (item_level != level) {
+            if (!step_rmt_put_run(out, cap, &halves, level, run)) {
+                return 0;
+            }
+            level = item_level;
+            run = 0;
+        }
+        run += wave[i].duration_us;
+    }
+    if (!step_rmt_put_run(out, cap, &halves, level, run)) {
+        return 0;
+    }
+    return (halves + 1) / 2;
+}
+
+static bool IRAM_ATTR step_rmt_output_on_done(rmt_channel_handle_t channel, const rmt_tx_done_event_data_t *edata,
+                                              void *user_ctx)
+{
+    step_rmt_output_t *rmt = (step_rmt_output_t *)user_ctx;
+    if (atomic_fetch_sub(&rmt->pending, 1) != 1) {
+        return false;
+    }
+    if (!atomic_exchange(&rmt->playing, false)) {
+        return false;
+    }
+    // All channels ended on a released level, hand the pins back
+    step_rmt_route(rmt->gpios, rmt->prev_signals);
+#if CONFIG_PM_ENABLE
+    esp_pm_lock_release(rmt->pm_lock);
+#endif
+    return rmt->done_cb ? rmt->done_cb(&rmt->base, rmt->done_arg) : false;
+}
+
+/* Undo a playback that failed to start: drop the `queued` channels' transactions and give the pins back */
+static void step_rmt_output_unwind(step_rmt_output_t *rmt, int queued)
+{
+    atomic_store(&rmt->playing, false);
+    for (int c = 0; c < queued; c++) {
+        rmt_disable(rmt->channels[c]);
+        rmt_enable(rmt->channels[c]);
+    }
+    atomic_store(&rmt->pending, 0);
+    step_rmt_route(rmt->gpios, rmt->prev_signals);
+#if CONFIG_PM_ENABLE
+    esp_pm_lock_release(rmt->pm_lock);
+#endif
+}
+
+static esp_err_t step_rmt_output_play(step_output_t *output, const step_wave_item_t *wave, size_t count,
+                                      step_output_done_cb_t done_cb, void *arg)
+{
+    step_rmt_output_t *rmt = __containerof(output, step_rmt_output_t, base);
+    ESP_RETURN_ON_FALSE(wave && count && count <= output->max_items, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(!atomic_load(&rmt->playing), ESP_ERR_INVALID_STATE, TAG, "playback in progress");
+
+    size_t lens[STEP_RMT_COILS];
+    for (int c = 0; c < STEP_RMT_COILS; c++) {
+        lens[c] = step_rmt_encode_coil(wave, count, c, rmt->symbols[c], rmt->symbol_cap);
+        ESP_RETURN_ON_FALSE(lens[c], ESP_ERR_INVALID_SIZE, TAG, "wave does not fit");
+    }
+
+    rmt->done_cb = done_cb;
+    rmt->done_arg = arg;
+    atomic_store(&rmt->pending, STEP_RMT_COILS);
+    atomic_store(&rmt->playing, true);
+#if CONFIG_PM_ENABLE
+    esp_pm_lock_acquire(rmt->pm_lock);
+#endif
+    // The channels idle low like the released coils, so switching the pins over is glitch free
+    for (int i = 0; i < STEP_RMT_COILS; i++) {
+        rmt->prev_signals[i] = step_rmt_out_signal(rmt->gpios[i]);
+    }
+    step_rmt_route(rmt->gpios, rmt->rmt_signals);
+
+    rmt_transmit_config_t tx_config = {
+        .loop_count = 0,
+        .flags.eot_level = 0,
+    };
+    // The synchronized channels only start once all four are queued, so a failure leaves the coils untouched
+    esp_err_t ret = rmt_sync_reset(rmt->sync);
+    int queued = 0;
+    while (ret == ESP_OK && queued < STEP_RMT_COILS) {
+        ret = rmt_transmit(rmt->channels[queued], rmt->encoders[queued], rmt->symbols[queued],
+                           lens[queued] * sizeof(rmt_symbol_word_t), &tx_config);
+        queued += ret == ESP_OK;
+    }
+    if (ret != ESP_OK) {
+        step_rmt_output_unwind(rmt, queued);
+        ESP_LOGW(TAG, "start playback failed: %s", esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+static esp_err_t step_rmt_output_stop(step_output_t *output)
+{
+    step_rmt_output_t *rmt = __containerof(output, step_rmt_output_t, base);
+    if (!atomic_exchange(&rmt->playing, false)) {
+        return ESP_OK;
+    }
+    // Disabling a channel drops its pending transactions
+    for (int c = 0; c < STEP_RMT_COILS; c++) {
+        rmt_disable(rmt->channels[c]);
+        rmt_enable(rmt->channels[c]);
+    }
+    step_rmt_route(rmt->gpios, rmt->prev_signals);
+#if CONFIG_PM_ENABLE
+    esp_pm_lock_release(rmt->pm_lock);
+#endif
+    return ESP_OK;
+}
+
+static esp_err_t step_rmt_output_del(step_output_t *output)
+{
+    step_rmt_output_t *rmt = __containerof(output, step_rmt_output_t, base);
+    step_rmt_output_stop(output);
+    if (rmt->sync) {
+        rmt_del_sync_manager(rmt->sync);
+    }
+    for (int c = 0; c < STEP_RMT_COILS; c++) {
+        if (rmt->channels[c]) {
+            rmt_disable(rmt->channels[c]);
+            rmt_del_channel(rmt->channels[c]);
+        }
+        if (rmt->encoders[c]) {
+            rmt_del_encoder(rmt->encoders[c]);
+        }
+        free(rmt->symbols[c]);
+    }
+#if CONFIG_PM_ENABLE
+    if (rmt->pm_lock) {
+        esp_pm_lock_delete(rmt->pm_lock);
+    }
+#endif
+    free(rmt);
+    return ESP_OK;
+}
+
+esp_err_t step_new_rmt_output(const step_rmt_output_config_t *config, step_output_t **ret_output)
+{
+    esp_err_t ret = ESP_OK;
+    ESP_RETURN_ON_FALSE(config && ret_output && config->max_items, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    step_rmt_output_t *rmt = calloc(1, sizeof(step_rmt_output_t));
+    ESP_RETURN_ON_FALSE(rmt, ESP_ERR_NO_MEM, TAG, "no mem for rmt output");
+
+    // Creating a channel routes its pin to it, give the pins back to their owner afterwards
+    uint32_t owner_signals[STEP_RMT_COILS];
+    for (int c = 0; c < STEP_RMT_COILS; c++) {
+        rmt->gpios[c] = config->phase_gpios[c];
+        owner_signals[c] = step_rmt_out_signal(rmt->gpios[c]);
+    }
+
+    // A coil changes level at most every other step, two runs fit in one symbol
+    rmt->symbol_cap = config->max_items / 2 + 8;
+    for (int c = 0; c < STEP_RMT_COILS; c++) {
+        rmt->symbols[c] = calloc(rmt->symbol_cap, sizeof(rmt_symbol_word_t));
+        ESP_GOTO_ON_FALSE(rmt->symbols[c], ESP_ERR_NO_MEM, err, TAG, "no mem for symbols");
+    }
+    rmt_tx_event_callbacks_t cbs = {
+        .on_trans_done = step_rmt_output_on_done,
+    };
+    for (int c = 0; c < STEP_RMT_COILS; c++) {
+        rmt_tx_channel_config_t channel_config = {
+            .gpio_num = rmt->gpios[c],
+            .clk_src = RMT_CLK_SRC_XTAL, // Not affected by dynamic frequency scaling
+            .resolution_hz = STEP_RMT_RESOLUTION_HZ,
+            .mem_block_symbols = SOC_RMT_MEM_WORDS_PER_CHANNEL,
+            .trans_queue_depth = 1,
+        };
+        ESP_GOTO_ON_ERROR(rmt_new_tx_channel(&channel_config, &rmt->channels[c]), err, TAG, "create channel failed");
+        rmt->rmt_signals[c] = step_rmt_out_signal(rmt->gpios[c]);
+        rmt_copy_encoder_config_t encoder_config = {};
+        ESP_GOTO_ON_ERROR(rmt_new_copy_encoder(&encoder_config, &rmt->encoders[c]), err, TAG, "create encoder failed");
+        ESP_GOTO_ON_ERROR(rmt_tx_register_event_callbacks(rmt->channels[c], &cbs, rmt), err, TAG,
+                          "register callbacks failed");
+    }
+    rmt_sync_manager_config_t sync_config = {
+        .tx_channel_array = rmt->channels,
+        .array_size = STEP_RMT_COILS,
+    };
+    ESP_GOTO_ON_ERROR(rmt_new_sync_manager(&sync_config, &rmt->sync), err, TAG, "create sync manager failed");
+    for (int c = 0; c < STEP_RMT_COILS; c++) {
+        ESP_GOTO_ON_ERROR(rmt_enable(rmt->channels[c]), err, TAG, "enable channel failed");
+    }
+#if CONFIG_PM_ENABLE
+    ESP_GOTO_ON_ERROR(esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "step_rmt", &rmt->pm_lock), err, TAG,
+                      "create pm lock failed");
+#endif
+    step_rmt_route(rmt->gpios, owner_signals);
+
+    rmt->base.play = step_rmt_output_play;
+    rmt->base.stop = step_rmt_output_stop;
+    rmt->base.del = step_rmt_output_del;
+    rmt->base.max_items = config->max_items;
+    *ret_output = &rmt->base;
+    return ESP_OK;
+
+err:
+    step_rmt_output_del(&rmt->base);
+    step_rmt_route(config->phase_gpios, owner_signals);
+    return ret;
+}
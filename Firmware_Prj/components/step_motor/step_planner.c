@@ -0,0 +1,14 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "step_planner.h"
+
+void step_planner_reset(step_planner_t *planner)
+{
+    /* The consumer is stopped, so it is safe to move its index as well */
+    unsigned tail = atomic_load_explicit(&planner->tail, memory_order_relaxed);
+    atomic_store_explicit(&planner->head, tail, memory_order_release);
+}
@@ -0,0 +1,134 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <inttypes.h>
+#include <math.h>
+#include <string.h>
+#include <sys/param.h>
+#include "esp_check.h"
+#include "step_profile.h"
+
+static const char *TAG = "step_profile";
+
+#define US_PER_S 1000000.0f
+#define S_CURVE_BISECT_ITER 32
+
+/* Distance covered after t seconds of a raised cosine velocity ramp lasting T seconds */
+/* v(t) = v0 + (v1-v0)*(1-cos(pi*t/T))/2 */
+static float s_curve_distance(float t, float v0, float v1, float T)
+{
+    const float pi = (float)M_PI;
+    return v0 * t + (v1 - v0) * 0.5f * (t - T / pi * sinf(pi * t / T));
+}
+
+/* Time at which the S-curve ramp has covered `steps`, the distance is monotonic in t */
+static float s_curve_time_at(float steps, float v0, float v1, float T)
+{
+    float lo = 0;
+    float hi = T;
+    for (int i = 0; i < S_CURVE_BISECT_ITER; i++) {
+        float mid = 0.5f * (lo + hi);
+        if (s_curve_distance(mid, v0, v1, T) < steps) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    return 0.5f * (lo + hi);
+}
+
+esp_err_t step_ramp_build(step_ramp_t *ramp, const step_ramp_config_t *config)
+{
+    ESP_RETURN_ON_FALSE(ramp && config, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(config->start_rate >= 16 && config->max_rate >= config->start_rate && config->accel,
+                        ESP_ERR_INVALID_ARG, TAG, "invalid ramp rates");
+    ESP_RETURN_ON_FALSE(config->shape == STEP_RAMP_SHAPE_TRAPEZOIDAL || config->shape == STEP_RAMP_SHAPE_S_CURVE,
+                        ESP_ERR_INVALID_ARG, TAG, "invalid ramp shape:%d", config->shape);
+
+    const float v0 = (float)config->start_rate;
+    const float v1 = (float)config->max_rate;
+    const float a = (float)config->accel;
+    const float min_interval = US_PER_S / v1;
+
+    /* Steps needed to get from the start rate to the top rate */
+    float ramp_steps;
+    float T = 0;
+    if (config->shape == STEP_RAMP_SHAPE_TRAPEZOIDAL) {
+        ramp_steps = (v1 * v1 - v0 * v0) / (2 * a);
+    } else {
+        /* Peak acceleration of the raised cosine is (v1-v0)*pi/(2T) */
+        T = (float)M_PI * (v1 - v0) / (2 * a);
+        ramp_steps = s_curve_distance(T, v0, v1, T);
+    }
+
+    uint32_t len = (uint32_t)ramp_steps + 1;
+    if (len > STEP_RAMP_MAX_LEN) {
+        ESP_LOGW(TAG, "ramp needs %"PRIu32" levels, truncated to %d", len, STEP_RAMP_MAX_LEN);
+        len = STEP_RAMP_MAX_LEN;
+    }
+
+    memset(ramp, 0, sizeof(step_ramp_t));
+    float t_prev = 0;
+    for (uint32_t i = 0; i < len; i++) {
+        float t_next;
+        if (config->shape == STEP_RAMP_SHAPE_TRAPEZOIDAL) {
+            /* s(t) = v0*t + a*t^2/2 */
+            t_next = (sqrtf(v0 * v0 + 2 * a * (float)(i + 1)) - v0) / a;
+        } else if ((float)(i + 1) < ramp_steps) {
+            t_next = s_curve_time_at((float)(i + 1), v0, v1, T);
+        } else {
+            t_next = t_prev + 1.0f / v1;
+        }
+        float interval = (t_next - t_prev) * US_PER_S;
+        if (interval < min_interval) {
+            interval = min_interval;
+        }
+        ramp->interval_us[i] = (uint16_t)MIN(interval + 0.5f, (float)UINT16_MAX);
+        t_prev = t_next;
+    }
+    ramp->len = (uint16_t)len;
+    ramp->config = *config;
+    return ESP_OK;
+}
+
+uint16_t step_ramp_level_for_interval(const step_ramp_t *ramp, uint32_t interval_us)
+{
+    /* Intervals shrink as the level grows, find the last one not shorter than interval_us */
+    uint16_t lo = 0;
+    uint16_t hi = ramp->len;
+    while (hi - lo > 1) {
+        uint16_t mid = (lo + hi) / 2;
+        if (ramp->interval_us[mid] >= interval_us) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+void step_profile_init(const step_ramp_t *ramp, uint32_t steps, uint32_t cruise_us, uint8_t interval_shift,
+                       step_profile_t *profile)
+{
+    profile->total_steps = steps;
+    profile->cruise_us = cruise_us;
+    /* Rounded down, so the ramp index of every profile level stays within the ramp */
+    profile->cruise_level = step_ramp_level_for_interval(ramp, cruise_us) >> interval_shift;
+    profile->exit_level = 0;
+    profile->interval_shift = interval_shift;
+}
+
+uint64_t step_profile_duration_us(const step_ramp_t *ramp, const step_profile_t *profile, uint16_t entry_level)
+{
+    uint64_t duration = 0;
+    uint16_t level = entry_level;
+    for (uint32_t executed = 1; executed <= profile->total_steps; executed++) {
+        duration += step_profile_interval(ramp, profile, level);
+        level = step_ramp_next_level(level, profile->total_steps - executed,
+                                     profile->cruise_level, profile->exit_level);
+    }
+    return duration;
+}
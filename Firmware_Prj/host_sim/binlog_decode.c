@@ -0,0 +1,74 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "binlog.h"
+
+// 主机侧 binlog 解码：逐行读入串口输出，把 "BL <hex>" 行还原成文本，其余行原样输出
+// 事件表直接取自固件的 binlog_events.h，解码器必须与被解码的固件来自同一版本
+//   idf.py monitor | ./build_sim/binlog_decode
+//   ./build_sim/hollow_clock_sim --binlog log.txt && ./build_sim/binlog_decode log.txt
+
+static bool parse_entry(const char* hex, binlog_entry_t* entry)
+{
+    uint8_t* bytes = (uint8_t*)entry;
+    for (size_t i = 0; i < sizeof(*entry); i++)
+    {
+        unsigned value;
+        if (sscanf(&hex[2 * i], "%2x", &value) != 1)
+        {
+            return false;
+        }
+        bytes[i] = (uint8_t)value;
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    FILE* in = stdin;
+    if (argc > 2)
+    {
+        fprintf(stderr, "usage: %s [FILE]\n", argv[0]);
+        return 2;
+    }
+    if (argc == 2)
+    {
+        in = fopen(argv[1], "r");
+        if (!in)
+        {
+            perror(argv[1]);
+            return 1;
+        }
+    }
+
+    char line[512];
+    unsigned long decoded = 0;
+    unsigned long bad = 0;
+    while (fgets(line, sizeof(line), in))
+    {
+        // 监视器可能在行首加颜色或前缀，在行内查找标记
+        const char* mark = strstr(line, "BL ");
+        binlog_entry_t entry;
+        if (!mark || strlen(mark + 3) < 2 * sizeof(entry) || !parse_entry(mark + 3, &entry))
+        {
+            fputs(line, stdout);
+            bad += mark != NULL;
+            continue;
+        }
+        char text[128];
+        const char* tag = binlog_format(&entry, text, sizeof(text));
+        printf("B (%u) %s: %s\n", (unsigned)(entry.time_us / 1000), tag, text);
+        decoded++;
+    }
+    if (in != stdin)
+    {
+        fclose(in);
+    }
+    fprintf(stderr, "%lu entries decoded, %lu malformed\n", decoded, bad);
+    return 0;
+}
@@ -0,0 +1,92 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdio.h>
+#include <time.h>
+#include "esp_err.h"
+#include "hot_bench.h"
+#include "sim.h"
+
+// 在主机上运行固件的热路径微基准（main/hot_bench.c），单位纳秒。
+// 步进中断在仿真的组定时器里执行，由闹钟回调观察者按主机时间计时
+
+typedef struct
+{
+    uint32_t samples[HOT_BENCH_SAMPLES];
+    size_t count;
+} host_alarm_t;
+
+static host_alarm_t s_alarm;
+
+static uint32_t host_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+}
+
+static void host_alarm_observer(uint64_t elapsed_ns, void* ctx)
+{
+    host_alarm_t* alarm = (host_alarm_t*)ctx;
+    if (alarm->count < HOT_BENCH_SAMPLES)
+    {
+        alarm->samples[alarm->count++] = (uint32_t)elapsed_ns;
+    }
+}
+
+static void host_alarm_begin(motor_control_t* motor_control)
+{
+    (void)motor_control;
+    s_alarm.count = 0;
+    sim_set_alarm_observer(host_alarm_observer, &s_alarm);
+}
+
+static size_t host_alarm_end(motor_control_t* motor_control, uint32_t* samples, size_t capacity)
+{
+    (void)motor_control;
+    sim_set_alarm_observer(NULL, NULL);
+    size_t count = s_alarm.count < capacity ? s_alarm.count : capacity;
+    for (size_t i = 0; i < count; i++)
+    {
+        samples[i] = s_alarm.samples[i];
+    }
+    return count;
+}
+
+static const hot_bench_port_t host_port = {
+    .platform = "host",
+    .unit = "ns",
+    .now = host_now,
+    .alarm_begin = host_alarm_begin,
+    .alarm_end = host_alarm_end,
+};
+
+int main(void)
+{
+    // 与 app_main 相同的驱动，输出换成只能逐步写入的仿真后端，所有运动都走步进中断
+    stepper_group_t* group = NULL;
+    ESP_ERROR_CHECK(stepper_group_new(&group));
+    stepper_config_t config = {
+        .phase_gpios = {0, 1, 2, 3},
+    };
+    ESP_ERROR_CHECK(sim_new_step_output(0, 0, &config.output));
+    motor_control_t* motor_control = stepper_driver_new(group, &config);
+    if (!motor_control)
+    {
+        return 1;
+    }
+
+    int32_t home = stepper_get_position(motor_control);
+    esp_err_t err = hot_bench_run(motor_control, &host_port);
+    int32_t end = stepper_get_position(motor_control);
+    if (err != ESP_OK || end != home)
+    {
+        fprintf(stderr, "hot_bench: %s, position %d -> %d\n", esp_err_to_name(err), (int)home, (int)end);
+        return 1;
+    }
+    stepper_driver_deinit(motor_control);
+    stepper_group_del(group);
+    return 0;
+}
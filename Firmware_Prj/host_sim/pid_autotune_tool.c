@@ -0,0 +1,206 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pid_autotune.h"
+#include "pid_ctrl.h"
+#include "plant_28byj48.h"
+
+// 在 28BYJ-48 模型上做继电反馈自整定，再以阶跃响应搜索无超调下调节时间最短的增益
+// 控制量为发步速率（半步/秒），被控量为指针位置（半步）
+// 位置是速率的积分，且速率受驱动加速度限制：继电实验测得的振荡由加速度限制主导而非线性环节，
+// Ziegler-Nichols 规则假设的是自平衡对象，它的积分项在这个对象上必然超调，只能作为搜索起点
+
+#define CONTROL_PERIOD_S 0.005f
+#define TORQUE_MARGIN 1.5f      // 可靠转速要求的力矩余量
+#define DRIVER_ACCEL 6000.0f    // 与步进驱动加速表一致的速度变化率上限（步/秒^2）
+#define STEP_SIZE 256.0f        // 漂移校正的阶跃幅度（半步，约 22.5 度）
+#define SETTLE_BAND 0.5f        // 调节完成的误差带（半步）
+#define RESPONSE_S 4.0f         // 阶跃响应仿真时长
+
+typedef struct
+{
+    float settling_s;  // 最后一次离开误差带的时间，未收敛为 INFINITY
+    float overshoot;   // 越过目标的最大值（半步）
+    uint32_t stalls;   // 失步次数
+} step_metrics_t;
+
+/* 驱动侧的速度斜坡：静止附近可直接到启动转速，其余按加速度限制 */
+static float driver_slew(float current, float target, float start_rate, float dt)
+{
+    float allowed = fmaxf(start_rate - fabsf(current), 0.0f) + DRIVER_ACCEL * dt;
+    float delta = target - current;
+    if (delta > allowed)
+    {
+        delta = allowed;
+    }
+    else if (delta < -allowed)
+    {
+        delta = -allowed;
+    }
+    return current + delta;
+}
+
+static step_metrics_t run_step_response(const plant_28byj48_params_t* plant_params, const pid_ctrl_parameter_t* params)
+{
+    pid_ctrl_config_t config = {.init_param = *params};
+    pid_ctrl_block_handle_t pid;
+    step_metrics_t metrics = {.settling_s = INFINITY};
+    if (pid_new_control_block(&config, &pid) != ESP_OK)
+    {
+        return metrics;
+    }
+
+    plant_28byj48_t plant;
+    plant_28byj48_init(&plant, plant_params);
+    float command = 0;
+    float last_outside = 0;
+    int samples = (int)(RESPONSE_S / CONTROL_PERIOD_S);
+    for (int i = 0; i < samples; i++)
+    {
+        float error = STEP_SIZE - plant.position;
+        if (fabsf(error) > SETTLE_BAND)
+        {
+            last_outside = (i + 1) * CONTROL_PERIOD_S;
+        }
+        metrics.overshoot = fmaxf(metrics.overshoot, -error);
+        float output;
+        pid_compute(pid, error, &output);
+        command = driver_slew(command, output, plant_params->start_rate, CONTROL_PERIOD_S);
+        plant_28byj48_step(&plant, command, CONTROL_PERIOD_S);
+    }
+    metrics.stalls = plant.stalls;
+    if (last_outside < RESPONSE_S - 0.5f)
+    {
+        metrics.settling_s = last_outside;
+    }
+    pid_del_control_block(pid);
+    return metrics;
+}
+
+static void fill_limits(pid_ctrl_parameter_t* params, float max_rate)
+{
+    params->max_output = max_rate;
+    params->min_output = -max_rate;
+    // 积分限幅到单独即可输出满速
+    float limit = params->ki > 0 ? max_rate / params->ki : 0;
+    params->max_integral = limit;
+    params->min_integral = -limit;
+}
+
+static bool settles_without_overshoot(const step_metrics_t* metrics)
+{
+    return metrics->overshoot <= SETTLE_BAND && !metrics->stalls && isfinite(metrics->settling_s);
+}
+
+static void print_gains(const char* name, const pid_ctrl_parameter_t* params, const step_metrics_t* metrics)
+{
+    printf("%s_kp: %.4f\n", name, params->kp);
+    printf("%s_ki: %.5f\n", name, params->ki);
+    printf("%s_kd: %.4f\n", name, params->kd);
+    printf("%s_settling_ms: %.1f\n", name, metrics->settling_s * 1000);
+    printf("%s_overshoot_steps: %.3f\n", name, metrics->overshoot);
+    printf("%s_stalls: %u\n", name, metrics->stalls);
+}
+
+int main(void)
+{
+    const plant_28byj48_params_t* plant_params = &plant_28byj48_default;
+    float max_rate = plant_28byj48_max_reliable_rate(plant_params, TORQUE_MARGIN);
+    printf("max_reliable_rate_steps_per_s: %.1f\n", max_rate);
+    printf("max_reliable_rpm: %.2f\n", max_rate * 60.0f / 4096.0f);
+
+    // 继电反馈实验：以 ±半个可靠转速在目标附近振荡
+    pid_autotune_config_t tune_config = {
+        .setpoint = STEP_SIZE,
+        .relay_amplitude = max_rate / 2,
+        .hysteresis = 1.0f,
+        .sample_period_s = CONTROL_PERIOD_S,
+        .settle_cycles = 2,
+        .cycles = 5,
+        .max_samples = 20000,
+    };
+    pid_autotune_handle_t tuner;
+    if (pid_new_autotune(&tune_config, &tuner) != ESP_OK)
+    {
+        return 1;
+    }
+    plant_28byj48_t plant;
+    plant_28byj48_init(&plant, plant_params);
+    plant.position = STEP_SIZE;
+    float command = 0;
+    bool done = false;
+    while (!done)
+    {
+        float output;
+        if (pid_autotune_update(tuner, plant.position, &output, &done) != ESP_OK)
+        {
+            fprintf(stderr, "relay experiment did not converge\n");
+            return 1;
+        }
+        command = driver_slew(command, output, plant_params->start_rate, CONTROL_PERIOD_S);
+        plant_28byj48_step(&plant, command, CONTROL_PERIOD_S);
+    }
+    pid_autotune_result_t result;
+    pid_autotune_get_result(tuner, &result);
+    pid_del_autotune(tuner);
+    printf("relay_stalls: %u\n", plant.stalls);
+    printf("ultimate_gain: %.4f\n", result.ultimate_gain);
+    printf("ultimate_period_ms: %.1f\n", result.ultimate_period_s * 1000);
+    printf("relay_amplitude_steps: %.2f\n", result.amplitude);
+
+    // 经验公式原样给出的增益，只作参考：积分项会让它超调且不收敛
+    pid_ctrl_parameter_t rule = {0};
+    pid_autotune_compute_parameters(&result, CONTROL_PERIOD_S, PID_TUNE_RULE_NO_OVERSHOOT, &rule);
+    fill_limits(&rule, max_rate);
+    step_metrics_t rule_metrics = run_step_response(plant_params, &rule);
+    print_gains("rule", &rule, &rule_metrics);
+    printf("rule_applies: %s\n", settles_without_overshoot(&rule_metrics) ? "yes" : "no");
+
+    // 对象本身就是积分环节，稳态不需要积分项；去掉 Ki 的规则增益作为搜索起点
+    pid_ctrl_parameter_t base = rule;
+    base.ki = 0;
+    fill_limits(&base, max_rate);
+    step_metrics_t base_metrics = run_step_response(plant_params, &base);
+    print_gains("rule_pd", &base, &base_metrics);
+
+    // 在起点附近搜索：Kp 缩放与微分时间倍率
+    static const float kd_scales[] = {0.0f, 0.25f, 0.5f, 1.0f, 2.0f};
+    pid_ctrl_parameter_t best = base;
+    step_metrics_t best_metrics = base_metrics;
+    bool best_valid = settles_without_overshoot(&base_metrics);
+    for (float kp_scale = 0.25f; kp_scale <= 8.0f; kp_scale *= 1.1f)
+    {
+        for (size_t d = 0; d < sizeof(kd_scales) / sizeof(kd_scales[0]); d++)
+        {
+            pid_ctrl_parameter_t candidate = base;
+            candidate.kp = base.kp * kp_scale;
+            candidate.kd = base.kd * kp_scale * kd_scales[d];
+            fill_limits(&candidate, max_rate);
+            step_metrics_t metrics = run_step_response(plant_params, &candidate);
+            if (!settles_without_overshoot(&metrics))
+            {
+                continue;
+            }
+            if (!best_valid || metrics.settling_s < best_metrics.settling_s)
+            {
+                best = candidate;
+                best_metrics = metrics;
+                best_valid = true;
+            }
+        }
+    }
+    if (!best_valid)
+    {
+        fprintf(stderr, "no gains without overshoot found\n");
+        return 1;
+    }
+    print_gains("tuned", &best, &best_metrics);
+
+    return 0;
+}
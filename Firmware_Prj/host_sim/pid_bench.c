@@ -0,0 +1,200 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "pid_ctrl.h"
+#include "pid_ctrl_batch.h"
+
+// 批量定点 PID 与浮点 pid_compute() 的性能对比，并校验批量路径与标量参考逐位一致
+
+#define BENCH_ITERATIONS 20000
+#define BENCH_FRAMES 256
+#define VERIFY_ITERATIONS 2000
+#define GAIN_SHIFT 4          // 增益范围 [-16, 16)
+#define SIGNAL_SCALE 65536.0f // 定点信号为 Q16
+
+static uint32_t s_seed = 12345;
+
+static uint32_t bench_rand(void)
+{
+    s_seed = s_seed * 1664525u + 1013904223u;
+    return s_seed;
+}
+
+static float rand_range(float lo, float hi)
+{
+    return lo + (hi - lo) * (float)(bench_rand() >> 8) / (float)(1u << 24);
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void random_params(pid_ctrl_parameter_t* params, pid_calculate_type_t cal_type, float scale)
+{
+    params->kp = rand_range(-4.0f, 12.0f);
+    params->ki = rand_range(0.0f, 2.0f);
+    params->kd = rand_range(0.0f, 8.0f);
+    params->max_output = rand_range(0.2f, 1.0f) * scale;
+    params->min_output = -rand_range(0.2f, 1.0f) * scale;
+    params->max_integral = rand_range(0.5f, 4.0f) * scale;
+    params->min_integral = -rand_range(0.5f, 4.0f) * scale;
+    params->cal_type = cal_type;
+}
+
+/* 随机参数与输入（含饱和与 int32 边界值）下批量路径与参考路径逐位比较 */
+static int verify(pid_calculate_type_t cal_type, size_t count)
+{
+    pid_batch_config_t config = {.count = count, .gain_shift = GAIN_SHIFT, .cal_type = cal_type};
+    pid_batch_handle_t batch;
+    pid_batch_handle_t reference;
+    if (pid_new_batch(&config, &batch) != ESP_OK || pid_new_batch(&config, &reference) != ESP_OK)
+    {
+        return -1;
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        pid_ctrl_parameter_t params;
+        // 一半的块使用超出 int32 的限幅，检验饱和
+        random_params(&params, cal_type, (i & 1) ? 1e10f : 1e9f);
+        pid_batch_update_parameters(batch, i, &params);
+        pid_batch_update_parameters(reference, i, &params);
+    }
+
+    int32_t* errors = malloc(count * sizeof(int32_t));
+    int32_t* out_batch = malloc(count * sizeof(int32_t));
+    int32_t* out_reference = malloc(count * sizeof(int32_t));
+    int mismatches = 0;
+    for (int it = 0; it < VERIFY_ITERATIONS; it++)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            uint32_t r = bench_rand();
+            errors[i] = (r & 0xF) == 0 ? ((r & 0x10) ? INT32_MAX : INT32_MIN) : (int32_t)r >> (r & 0x7);
+        }
+        pid_batch_compute(batch, errors, out_batch);
+        pid_batch_compute_reference(reference, errors, out_reference);
+        if (memcmp(out_batch, out_reference, count * sizeof(int32_t)))
+        {
+            mismatches++;
+        }
+    }
+    free(errors);
+    free(out_batch);
+    free(out_reference);
+    pid_del_batch(batch);
+    pid_del_batch(reference);
+    return mismatches;
+}
+
+static void bench(pid_calculate_type_t cal_type, size_t count)
+{
+    pid_ctrl_block_handle_t* blocks = malloc(count * sizeof(pid_ctrl_block_handle_t));
+    pid_batch_config_t config = {.count = count, .gain_shift = GAIN_SHIFT, .cal_type = cal_type};
+    pid_batch_handle_t batch;
+    pid_new_batch(&config, &batch);
+    for (size_t i = 0; i < count; i++)
+    {
+        pid_ctrl_config_t block_config;
+        random_params(&block_config.init_param, cal_type, 1.0f);
+        pid_new_control_block(&block_config, &blocks[i]);
+        pid_ctrl_parameter_t fixed = block_config.init_param;
+        fixed.max_output *= SIGNAL_SCALE;
+        fixed.min_output *= SIGNAL_SCALE;
+        fixed.max_integral *= SIGNAL_SCALE;
+        fixed.min_integral *= SIGNAL_SCALE;
+        pid_batch_update_parameters(batch, i, &fixed);
+    }
+
+    // 预先生成输入帧，计时只包含 PID 计算
+    float* errors_f = malloc(BENCH_FRAMES * count * sizeof(float));
+    int32_t* errors_q = malloc(BENCH_FRAMES * count * sizeof(int32_t));
+    float* outputs_f = malloc(count * sizeof(float));
+    int32_t* outputs_q = malloc(count * sizeof(int32_t));
+    for (size_t i = 0; i < BENCH_FRAMES * count; i++)
+    {
+        errors_f[i] = rand_range(-0.05f, 0.05f);
+        errors_q[i] = (int32_t)lroundf(errors_f[i] * SIGNAL_SCALE);
+    }
+
+    double t0 = now_ns();
+    for (int it = 0; it < BENCH_ITERATIONS; it++)
+    {
+        const float* frame = &errors_f[(it % BENCH_FRAMES) * count];
+        for (size_t i = 0; i < count; i++)
+        {
+            pid_compute(blocks[i], frame[i], &outputs_f[i]);
+        }
+    }
+    double t1 = now_ns();
+    for (int it = 0; it < BENCH_ITERATIONS; it++)
+    {
+        pid_batch_compute(batch, &errors_q[(it % BENCH_FRAMES) * count], outputs_q);
+    }
+    double t2 = now_ns();
+    double float_ns = t1 - t0;
+    double batch_ns = t2 - t1;
+
+    // 两条路径从同一状态出发走完相同输入，比较最终输出
+    double max_diff = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        double diff = fabs(outputs_f[i] - outputs_q[i] / (double)SIGNAL_SCALE);
+        if (diff > max_diff)
+        {
+            max_diff = diff;
+        }
+    }
+
+    const char* name = cal_type == PID_CAL_TYPE_POSITIONAL ? "positional" : "incremental";
+    double updates = (double)BENCH_ITERATIONS * count;
+    printf("%s_%zu_float_ns_per_update: %.2f\n", name, count, float_ns / updates);
+    printf("%s_%zu_batch_ns_per_update: %.2f\n", name, count, batch_ns / updates);
+    printf("%s_%zu_speedup: %.2f\n", name, count, batch_ns > 0 ? float_ns / batch_ns : 0.0);
+    printf("%s_%zu_max_abs_diff_vs_float: %.6f\n", name, count, max_diff);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        pid_del_control_block(blocks[i]);
+    }
+    free(blocks);
+    free(errors_f);
+    free(outputs_f);
+    free(errors_q);
+    free(outputs_q);
+    pid_del_batch(batch);
+}
+
+int main(void)
+{
+    static const size_t counts[] = {1, 4, 16, 64};
+    static const pid_calculate_type_t types[] = {PID_CAL_TYPE_POSITIONAL, PID_CAL_TYPE_INCREMENTAL};
+    int failures = 0;
+    for (size_t t = 0; t < 2; t++)
+    {
+        for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++)
+        {
+            int mismatches = verify(types[t], counts[c]);
+            printf("%s_%zu_bit_exact_mismatches: %d\n",
+                   types[t] == PID_CAL_TYPE_POSITIONAL ? "positional" : "incremental", counts[c], mismatches);
+            failures += mismatches != 0;
+        }
+    }
+    for (size_t t = 0; t < 2; t++)
+    {
+        for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++)
+        {
+            bench(types[t], counts[c]);
+        }
+    }
+    return failures ? 1 : 0;
+}
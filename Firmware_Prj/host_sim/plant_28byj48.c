@@ -0,0 +1,69 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <math.h>
+#include "plant_28byj48.h"
+
+// 数据手册：牵入力矩 >= 34.3 mNm @ 100 PPS；空载牵出转速、指针负载与惯量按实测估计（半步，5V）
+const plant_28byj48_params_t plant_28byj48_default = {
+    .holding_torque_mnm = 34.3f,
+    .max_rate = 3000.0f,
+    .start_rate = 600.0f,
+    .load_torque_mnm = 4.0f,
+    .accel_per_mnm = 2500.0f,
+    .lag_s = 0.004f,
+};
+
+void plant_28byj48_init(plant_28byj48_t* plant, const plant_28byj48_params_t* params)
+{
+    plant->params = *params;
+    plant->rate = 0;
+    plant->position = 0;
+    plant->stalls = 0;
+}
+
+float plant_28byj48_torque(const plant_28byj48_params_t* params, float rate)
+{
+    float ratio = fabsf(rate) / params->max_rate;
+    return ratio >= 1.0f ? 0.0f : params->holding_torque_mnm * (1.0f - ratio);
+}
+
+float plant_28byj48_max_reliable_rate(const plant_28byj48_params_t* params, float margin)
+{
+    float ratio = 1.0f - margin * params->load_torque_mnm / params->holding_torque_mnm;
+    return ratio > 0 ? params->max_rate * ratio : 0.0f;
+}
+
+bool plant_28byj48_step(plant_28byj48_t* plant, float commanded_rate, float dt)
+{
+    const plant_28byj48_params_t* params = &plant->params;
+
+    // 失步转速：力矩不足以拖动负载
+    bool stall = plant_28byj48_torque(params, commanded_rate) <= params->load_torque_mnm;
+
+    // 静止附近可以直接跳到启动转速，其余的速度变化受剩余力矩提供的加速度限制
+    if (!stall)
+    {
+        float surplus = plant_28byj48_torque(params, fmaxf(fabsf(commanded_rate), fabsf(plant->rate))) -
+                        params->load_torque_mnm;
+        float allowed = fmaxf(params->start_rate - fabsf(plant->rate), 0.0f) + surplus * params->accel_per_mnm * dt;
+        stall = fabsf(commanded_rate - plant->rate) > allowed;
+    }
+
+    if (stall)
+    {
+        // 失步后转子停在原地抖动，下一周期从静止重新开始
+        plant->stalls++;
+        plant->rate = 0;
+        return true;
+    }
+
+    // 转子以一阶滞后跟随步进序列
+    float alpha = dt / (params->lag_s + dt);
+    float new_rate = plant->rate + (commanded_rate - plant->rate) * alpha;
+    plant->position += (plant->rate + new_rate) / 2 * dt;
+    plant->rate = new_rate;
+    return false;
+}
@@ -0,0 +1,48 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef PLANT_28BYJ48_H
+#define PLANT_28BYJ48_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// 28BYJ-48 + ULN2003 在输出轴上的简化模型，速度与位置以半步计
+// 驱动开环发步，转子在力矩足够时跟随步进序列（带一阶滞后），
+// 要求的加速度超过剩余力矩能提供的值或转速超过失步转速时失步
+
+typedef struct
+{
+    float holding_torque_mnm; // 低速时的牵出力矩
+    float max_rate;           // 力矩降为零的转速（步/秒），力矩随转速线性下降
+    float start_rate;         // 无需加速即可从静止直接启动的转速（步/秒）
+    float load_torque_mnm;    // 减速箱摩擦与指针负载
+    float accel_per_mnm;      // 每 mNm 剩余力矩提供的角加速度（步/秒^2）
+    float lag_s;              // 转子跟随步进序列的时间常数
+} plant_28byj48_params_t;
+
+typedef struct
+{
+    plant_28byj48_params_t params;
+    float rate;         // 转子实际转速
+    float position;     // 转子实际位置
+    uint32_t stalls;    // 失步次数
+} plant_28byj48_t;
+
+// 5V 供电、带时针负载的默认参数
+extern const plant_28byj48_params_t plant_28byj48_default;
+
+void plant_28byj48_init(plant_28byj48_t* plant, const plant_28byj48_params_t* params);
+
+// 转速 rate 下可用的牵出力矩
+float plant_28byj48_torque(const plant_28byj48_params_t* params, float rate);
+
+// 力矩留有 margin 倍负载余量时的最高可靠转速
+float plant_28byj48_max_reliable_rate(const plant_28byj48_params_t* params, float margin);
+
+// 以 commanded_rate 发步 dt 秒，返回本周期是否失步
+bool plant_28byj48_step(plant_28byj48_t* plant, float commanded_rate, float dt);
+
+#endif //PLANT_28BYJ48_H
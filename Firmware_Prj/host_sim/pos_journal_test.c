@@ -0,0 +1,211 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "esp_err.h"
+#include "nvs.h"
+#include "pos_journal.h"
+#include "sim.h"
+
+// 位置日志在 NVS 替身上的性质检查，任何一项不满足时返回非零：
+// 记录轮流写入各个键；最新的键被写坏或写了一半时，重启后退回上一条记录；
+// 序号越过 UINT32_MAX 后仍以回绕后的记录为最新；最短提交间隔内的追加合并成一条，
+// 由截止定时器在间隔结束时提交，间隔内断电只丢掉这一条
+
+#define TEST_SLOTS 4
+#define TEST_INTERVAL_MS 30000
+#define US_PER_MS 1000ULL
+
+static int s_failures;
+
+static void expect(bool ok, const char* what)
+{
+    if (!ok)
+    {
+        printf("FAIL %s\n", what);
+        s_failures++;
+    }
+}
+
+static pos_journal_handle_t open_journal(const char* ns)
+{
+    const pos_journal_config_t config = {
+        .nvs_namespace = ns,
+        .slots = TEST_SLOTS,
+        .min_interval_ms = TEST_INTERVAL_MS,
+    };
+    pos_journal_handle_t journal = NULL;
+    ESP_ERROR_CHECK(pos_journal_new(&config, &journal));
+    return journal;
+}
+
+/* 断电重启：旧句柄随内存丢失，没提交的记录和它的截止定时器都不再写出 */
+static pos_journal_handle_t power_cycle(const char* ns)
+{
+    sim_esp_timers_power_off();
+    return open_journal(ns);
+}
+
+static void slot_key(char* key, size_t size, uint32_t slot)
+{
+    snprintf(key, size, "pos%u", (unsigned)slot);
+}
+
+static bool read_slot(const char* ns, uint32_t slot, pos_journal_record_t* record)
+{
+    char key[8];
+    slot_key(key, sizeof(key), slot);
+    nvs_handle_t nvs;
+    ESP_ERROR_CHECK(nvs_open(ns, NVS_READWRITE, &nvs));
+    size_t len = sizeof(*record);
+    bool found = nvs_get_blob(nvs, key, record, &len) == ESP_OK && len == sizeof(*record);
+    nvs_close(nvs);
+    return found;
+}
+
+static void write_slot(const char* ns, uint32_t slot, const void* data, size_t len)
+{
+    char key[8];
+    slot_key(key, sizeof(key), slot);
+    nvs_handle_t nvs;
+    ESP_ERROR_CHECK(nvs_open(ns, NVS_READWRITE, &nvs));
+    ESP_ERROR_CHECK(nvs_set_blob(nvs, key, data, len));
+    nvs_close(nvs);
+}
+
+static bool recovers(pos_journal_handle_t journal, uint32_t seq, int32_t position)
+{
+    pos_journal_record_t record;
+    if (pos_journal_recover(journal, &record) != ESP_OK)
+    {
+        printf("     no record recovered, expected #%u at %d\n", (unsigned)seq, (int)position);
+        return false;
+    }
+    if (record.seq != seq || record.position != position)
+    {
+        printf("     recovered #%u at %d, expected #%u at %d\n", (unsigned)record.seq, (int)record.position,
+               (unsigned)seq, (int)position);
+        return false;
+    }
+    return true;
+}
+
+static void wait_past_interval(void)
+{
+    sim_run_until(sim_now_us() + (TEST_INTERVAL_MS + 1) * US_PER_MS);
+}
+
+/* 每次提交写下一个键，第 n 条记录在第 n % slots 个键里 */
+static void test_rotation(void)
+{
+    const char* ns = "pj_rotate";
+    pos_journal_handle_t journal = open_journal(ns);
+    expect(pos_journal_recover(journal, &(pos_journal_record_t){0}) == ESP_ERR_NOT_FOUND, "rotation: empty journal");
+    for (int32_t i = 0; i < 6; i++)
+    {
+        ESP_ERROR_CHECK(pos_journal_append(journal, 100 * i, (uint8_t)(i & 7), 1000 + i));
+        wait_past_interval();
+    }
+    for (uint32_t seq = 2; seq < 6; seq++)
+    {
+        pos_journal_record_t record;
+        expect(read_slot(ns, seq % TEST_SLOTS, &record) && record.seq == seq && record.position == 100 * (int32_t)seq,
+               "rotation: slot holds the record of its sequence number");
+    }
+    journal = power_cycle(ns);
+    expect(recovers(journal, 5, 500), "rotation: newest record recovered");
+    ESP_ERROR_CHECK(pos_journal_del(journal));
+}
+
+/* 最新的键写坏（CRC 不符）或只写了一半（长度不符）时退回上一条，之后的提交接着上一条的序号 */
+static void test_torn_slot(void)
+{
+    const char* ns = "pj_rotate";
+    pos_journal_record_t record;
+    ESP_ERROR_CHECK(read_slot(ns, 5 % TEST_SLOTS, &record) ? ESP_OK : ESP_FAIL);
+    record.position ^= 0x40;
+    write_slot(ns, 5 % TEST_SLOTS, &record, sizeof(record));
+    pos_journal_handle_t journal = power_cycle(ns);
+    expect(recovers(journal, 4, 400), "torn slot: corrupted newest record falls back to the previous one");
+
+    ESP_ERROR_CHECK(pos_journal_append(journal, 4321, 3, 2000));
+    journal = power_cycle(ns);
+    expect(recovers(journal, 5, 4321), "torn slot: next commit reuses the torn sequence number");
+
+    write_slot(ns, 5 % TEST_SLOTS, &record, sizeof(record) / 2);
+    journal = power_cycle(ns);
+    expect(recovers(journal, 4, 400), "torn slot: truncated newest record falls back to the previous one");
+    ESP_ERROR_CHECK(pos_journal_del(journal));
+}
+
+/* 序号回绕：UINT32_MAX 之后的 0 仍是最新的记录 */
+static void test_seq_wrap(void)
+{
+    const char* ns = "pj_wrap";
+    for (uint32_t seq = UINT32_MAX - 1; seq != 0; seq++)
+    {
+        pos_journal_record_t record = {
+            .seq = seq,
+            .position = -(int32_t)(UINT32_MAX - seq) - 1,
+            .timestamp = 3000,
+            .step_index = 1,
+            .version = POS_JOURNAL_VERSION,
+        };
+        record.crc = pos_journal_crc16(&record, offsetof(pos_journal_record_t, crc));
+        write_slot(ns, seq % TEST_SLOTS, &record, sizeof(record));
+    }
+    pos_journal_handle_t journal = open_journal(ns);
+    expect(recovers(journal, UINT32_MAX, -1), "seq wrap: highest sequence number before the wrap recovered");
+    ESP_ERROR_CHECK(pos_journal_append(journal, 77, 5, 3001));
+    wait_past_interval();
+    ESP_ERROR_CHECK(pos_journal_append(journal, 78, 6, 3002));
+    journal = power_cycle(ns);
+    expect(recovers(journal, 1, 78), "seq wrap: records after the wrap are newer");
+    ESP_ERROR_CHECK(pos_journal_del(journal));
+}
+
+/* 间隔内的追加只留最后一条，由截止定时器在上次提交后 min_interval_ms 时提交，不等下一次追加 */
+static void test_deadline(void)
+{
+    const char* ns = "pj_deadline";
+    pos_journal_handle_t journal = open_journal(ns);
+    uint64_t start_us = sim_now_us();
+    ESP_ERROR_CHECK(pos_journal_append(journal, 10, 0, 4000));
+    sim_run_until(start_us + 1000 * US_PER_MS);
+    ESP_ERROR_CHECK(pos_journal_append(journal, 20, 1, 4001));
+    sim_run_until(start_us + 2000 * US_PER_MS);
+    ESP_ERROR_CHECK(pos_journal_append(journal, 30, 2, 4002));
+
+    pos_journal_stats_t stats;
+    sim_run_until(start_us + (TEST_INTERVAL_MS - 1) * US_PER_MS);
+    ESP_ERROR_CHECK(pos_journal_get_stats(journal, &stats));
+    expect(stats.commits == 1 && stats.coalesced == 1, "deadline: appends within the interval held back");
+
+    sim_run_until(start_us + TEST_INTERVAL_MS * US_PER_MS);
+    ESP_ERROR_CHECK(pos_journal_get_stats(journal, &stats));
+    pos_journal_record_t record;
+    expect(stats.commits == 2 && read_slot(ns, 1, &record) && record.position == 30 && record.timestamp == 4002,
+           "deadline: last append committed by the timer when the interval ends");
+
+    // 间隔内断电：只丢掉还没到截止时间的那一条
+    sim_run_until(start_us + (TEST_INTERVAL_MS + 5000) * US_PER_MS);
+    ESP_ERROR_CHECK(pos_journal_append(journal, 40, 3, 4040));
+    journal = power_cycle(ns);
+    expect(recovers(journal, 1, 30), "deadline: power cut within the interval loses only the pending record");
+    ESP_ERROR_CHECK(pos_journal_del(journal));
+}
+
+int main(void)
+{
+    test_rotation();
+    test_torn_slot();
+    test_seq_wrap();
+    test_deadline();
+    printf("pos_journal_failures: %d\n", s_failures);
+    return s_failures ? 1 : 0;
+}
@@ -0,0 +1,83 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "step_output.h"
+
+#define SIM_NOTIFY_ENTRIES 4
+#define SIM_MAX_TASKS 8
+#define SIM_US_PER_TICK (1000000ULL / configTICK_RATE_HZ)
+#define SIM_WAIT_FOREVER UINT64_MAX
+
+// 仿真任务：收到通知时在虚拟时间里运行一次 on_notify，相当于任务阻塞在通知上的循环体
+typedef void (*sim_task_fn_t)(void* arg);
+
+struct sim_task
+{
+    const char* name;
+    uint32_t value[SIM_NOTIFY_ENTRIES];
+    bool pending[SIM_NOTIFY_ENTRIES];
+    sim_task_fn_t on_notify;
+    void* arg;
+};
+
+// 相位输出观察者，仿真输出后端每次输出相位时调用，motor 为创建后端时给的电机序号
+typedef void (*sim_phase_observer_t)(uint64_t now_us, int motor, uint32_t value, void* ctx);
+
+// 虚拟时钟
+uint64_t sim_now_us(void);
+void sim_run_until(uint64_t t_us);
+bool sim_block_until(bool (*ready)(void* ctx), void* ctx, uint64_t deadline_us);
+
+// 仿真任务
+TaskHandle_t sim_task_create(const char* name, sim_task_fn_t on_notify, void* arg);
+TaskHandle_t sim_set_current_task(TaskHandle_t task);
+void sim_run_ready_tasks(void);
+
+// 外设
+bool sim_timers_next_event(uint64_t* when_us);
+void sim_timers_fire(uint64_t now_us);
+void sim_set_alarm_jitter(uint32_t max_us);
+void sim_set_timer_ppm(int32_t ppm);
+
+// 断电：停下所有 esp_timer，到期前的回调不再执行
+void sim_esp_timers_power_off(void);
+
+// 闹钟回调观察者：每次 gptimer 闹钟回调返回后调用，elapsed_ns 为回调在主机上实际执行的时间。
+// esp_timer 借用的定时器不计
+typedef void (*sim_alarm_observer_t)(uint64_t elapsed_ns, void* ctx);
+void sim_set_alarm_observer(sim_alarm_observer_t observer, void* ctx);
+
+// 仿真输出后端：max_items 为 0 时只能逐步写入，否则还能按虚拟时间整段回放
+esp_err_t sim_new_step_output(int motor, size_t max_items, step_output_t** ret_output);
+void sim_set_phase_observer(sim_phase_observer_t observer, void* ctx);
+
+// NVS 替身累计的写入次数
+uint32_t sim_nvs_get_writes(void);
+
+// Wi-Fi 驱动替身的统计
+typedef struct
+{
+    uint32_t connects;              // esp_wifi_connect 的调用次数
+    uint32_t channel_scans;         // 其中只扫一个信道的次数
+    uint32_t events;                // 分发的事件数
+    uint32_t sntp_syncs;
+    uint64_t handler_max_block_us;  // 一次事件处理中推进的最长虚拟时间
+} sim_wifi_stats_t;
+
+// 模拟 AP：关闭、换信道或换 BSSID 会断开已关联的站点；bssid 为 NULL 时不变
+void sim_wifi_set_ap(bool up, const uint8_t bssid[6], uint8_t channel);
+// 信标丢失之类的短暂断开，AP 本身不变
+void sim_wifi_drop(void);
+bool sim_wifi_has_ip(void);
+void sim_wifi_get_stats(sim_wifi_stats_t* stats);
+
+#endif //SIM_H
@@ -0,0 +1,497 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/event_groups.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/timers.h"
+#include "sim.h"
+
+// 单线程离散事件内核：定时器闹钟是唯一的事件源，任务阻塞即推进虚拟时间
+
+int sim_log_verbose = 0;
+
+static uint64_t s_now_us;
+static struct sim_task s_main_task = {.name = "main"};
+static TaskHandle_t s_current = &s_main_task;
+static TaskHandle_t s_tasks[SIM_MAX_TASKS];
+static int s_task_count;
+
+#define SIM_PENDED_CALLS 8
+
+struct sim_mutex
+{
+    bool taken;
+};
+
+struct sim_event_group
+{
+    EventBits_t bits;
+};
+
+typedef struct
+{
+    PendedFunction_t function;
+    void* param1;
+    uint32_t param2;
+} sim_pended_call_t;
+
+static TaskHandle_t s_timer_task;
+static sim_pended_call_t s_pended[SIM_PENDED_CALLS];
+static int s_pended_count;
+
+struct sim_queue
+{
+    uint8_t* storage;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+};
+
+uint64_t sim_now_us(void)
+{
+    return s_now_us;
+}
+
+static bool sim_step(uint64_t deadline_us)
+{
+    uint64_t when;
+    if (!sim_timers_next_event(&when) || when > deadline_us)
+    {
+        return false;
+    }
+    if (when > s_now_us)
+    {
+        s_now_us = when;
+    }
+    sim_timers_fire(s_now_us);
+    sim_run_ready_tasks();
+    return true;
+}
+
+void sim_run_until(uint64_t t_us)
+{
+    while (sim_step(t_us))
+    {
+    }
+    if (t_us > s_now_us)
+    {
+        s_now_us = t_us;
+    }
+}
+
+bool sim_block_until(bool (*ready)(void* ctx), void* ctx, uint64_t deadline_us)
+{
+    while (!ready(ctx))
+    {
+        if (!sim_step(deadline_us))
+        {
+            if (deadline_us == SIM_WAIT_FOREVER)
+            {
+                fprintf(stderr, "sim: task '%s' blocked forever with no pending events\n", s_current->name);
+                abort();
+            }
+            if (deadline_us > s_now_us)
+            {
+                s_now_us = deadline_us;
+            }
+            return ready(ctx);
+        }
+    }
+    return true;
+}
+
+static uint64_t sim_deadline(TickType_t ticks)
+{
+    return ticks == portMAX_DELAY ? SIM_WAIT_FOREVER : s_now_us + (uint64_t)ticks * SIM_US_PER_TICK;
+}
+
+TaskHandle_t sim_task_create(const char* name, sim_task_fn_t on_notify, void* arg)
+{
+    if (s_task_count >= SIM_MAX_TASKS)
+    {
+        fprintf(stderr, "sim: too many tasks\n");
+        abort();
+    }
+    struct sim_task* task = calloc(1, sizeof(struct sim_task));
+    s_tasks[s_task_count++] = task;
+    task->name = name;
+    task->on_notify = on_notify;
+    task->arg = arg;
+    return task;
+}
+
+TaskHandle_t sim_set_current_task(TaskHandle_t task)
+{
+    TaskHandle_t previous = s_current;
+    s_current = task;
+    return previous;
+}
+
+void sim_run_ready_tasks(void)
+{
+    bool ran;
+    do
+    {
+        ran = false;
+        // 事件驱动的任务在这里被“调度”，主任务只在阻塞调用里前进
+        for (int i = 0; i < s_task_count; i++)
+        {
+            struct sim_task* task = s_tasks[i];
+            bool pending = false;
+            for (int n = 0; n < SIM_NOTIFY_ENTRIES; n++)
+            {
+                pending |= task->pending[n];
+            }
+            if (!pending || task == s_current || !task->on_notify)
+            {
+                continue;
+            }
+            memset(task->pending, 0, sizeof(task->pending));
+            memset(task->value, 0, sizeof(task->value));
+            TaskHandle_t previous = sim_set_current_task(task);
+            task->on_notify(task->arg);
+            sim_set_current_task(previous);
+            ran = true;
+        }
+    }
+    while (ran);
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stack_depth, void* arg, UBaseType_t priority,
+                       TaskHandle_t* ret_task)
+{
+    (void)fn;
+    (void)stack_depth;
+    (void)arg;
+    (void)priority;
+    fprintf(stderr, "sim: blocking task '%s' cannot run in the simulator\n", name);
+    if (ret_task)
+    {
+        *ret_task = NULL;
+    }
+    return pdFAIL;
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    (void)task;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return s_current;
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)(s_now_us / SIM_US_PER_TICK);
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    sim_run_until(s_now_us + (uint64_t)ticks * SIM_US_PER_TICK);
+}
+
+void vTaskSetTimeOutState(TimeOut_t* timeout)
+{
+    timeout->start = xTaskGetTickCount();
+}
+
+BaseType_t xTaskCheckForTimeOut(TimeOut_t* timeout, TickType_t* ticks_to_wait)
+{
+    if (*ticks_to_wait == portMAX_DELAY)
+    {
+        return pdFALSE;
+    }
+    TickType_t now = xTaskGetTickCount();
+    TickType_t elapsed = now - timeout->start;
+    if (elapsed >= *ticks_to_wait)
+    {
+        *ticks_to_wait = 0;
+        return pdTRUE;
+    }
+    *ticks_to_wait -= elapsed;
+    timeout->start = now;
+    return pdFALSE;
+}
+
+static void sim_notify(TaskHandle_t task, UBaseType_t index, uint32_t value, eNotifyAction action)
+{
+    switch (action)
+    {
+    case eSetBits:
+        task->value[index] |= value;
+        break;
+    case eIncrement:
+        task->value[index]++;
+        break;
+    case eSetValueWithOverwrite:
+        task->value[index] = value;
+        break;
+    case eSetValueWithoutOverwrite:
+        if (!task->pending[index])
+        {
+            task->value[index] = value;
+        }
+        break;
+    default:
+        break;
+    }
+    task->pending[index] = true;
+}
+
+BaseType_t xTaskGenericNotify(TaskHandle_t task, UBaseType_t index, uint32_t value, eNotifyAction action)
+{
+    sim_notify(task, index, value, action);
+    sim_run_ready_tasks();
+    return pdPASS;
+}
+
+BaseType_t xTaskGenericNotifyFromISR(TaskHandle_t task, UBaseType_t index, uint32_t value, eNotifyAction action,
+                                     BaseType_t* task_woken)
+{
+    sim_notify(task, index, value, action);
+    if (task_woken)
+    {
+        *task_woken = pdTRUE;
+    }
+    return pdPASS;
+}
+
+typedef struct
+{
+    TaskHandle_t task;
+    UBaseType_t index;
+} sim_notify_wait_t;
+
+static bool sim_notify_ready(void* ctx)
+{
+    sim_notify_wait_t* wait = ctx;
+    return wait->task->pending[wait->index];
+}
+
+BaseType_t xTaskGenericNotifyWait(UBaseType_t index, uint32_t clear_on_entry, uint32_t clear_on_exit,
+                                  uint32_t* value, TickType_t ticks_to_wait)
+{
+    TaskHandle_t task = s_current;
+    if (!task->pending[index])
+    {
+        task->value[index] &= ~clear_on_entry;
+    }
+    sim_notify_wait_t wait = {.task = task, .index = index};
+    if (!sim_block_until(sim_notify_ready, &wait, sim_deadline(ticks_to_wait)))
+    {
+        return pdFALSE;
+    }
+    if (value)
+    {
+        *value = task->value[index];
+    }
+    task->value[index] &= ~clear_on_exit;
+    task->pending[index] = false;
+    return pdTRUE;
+}
+
+uint32_t ulTaskGenericNotifyTake(UBaseType_t index, BaseType_t clear_on_exit, TickType_t ticks_to_wait)
+{
+    TaskHandle_t task = s_current;
+    sim_notify_wait_t wait = {.task = task, .index = index};
+    if (!task->value[index] && !sim_block_until(sim_notify_ready, &wait, sim_deadline(ticks_to_wait)))
+    {
+        return 0;
+    }
+    uint32_t value = task->value[index];
+    task->value[index] = clear_on_exit ? 0 : value - 1;
+    task->pending[index] = false;
+    return value;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    struct sim_queue* queue = calloc(1, sizeof(struct sim_queue));
+    queue->storage = calloc(length, item_size);
+    queue->length = length;
+    queue->item_size = item_size;
+    return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue)
+{
+    free(queue->storage);
+    free(queue);
+}
+
+static bool sim_queue_has_space(void* ctx)
+{
+    QueueHandle_t queue = ctx;
+    return queue->count < queue->length;
+}
+
+static bool sim_queue_has_item(void* ctx)
+{
+    QueueHandle_t queue = ctx;
+    return queue->count > 0;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticks_to_wait)
+{
+    if (!sim_block_until(sim_queue_has_space, queue, sim_deadline(ticks_to_wait)))
+    {
+        return pdFALSE;
+    }
+    UBaseType_t index = (queue->head + queue->count) % queue->length;
+    memcpy(queue->storage + index * queue->item_size, item, queue->item_size);
+    queue->count++;
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticks_to_wait)
+{
+    if (!sim_block_until(sim_queue_has_item, queue, sim_deadline(ticks_to_wait)))
+    {
+        return pdFALSE;
+    }
+    memcpy(item, queue->storage + queue->head * queue->item_size, queue->item_size);
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count--;
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+    return queue->count;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return calloc(1, sizeof(struct sim_mutex));
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t mutex)
+{
+    free(mutex);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t mutex, TickType_t ticks_to_wait)
+{
+    // 单线程下不会有别的持有者释放它
+    if (mutex->taken)
+    {
+        fprintf(stderr, "sim: task '%s' takes a mutex it already holds\n", s_current->name);
+        abort();
+    }
+    mutex->taken = true;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t mutex)
+{
+    if (!mutex->taken)
+    {
+        return pdFALSE;
+    }
+    mutex->taken = false;
+    return pdTRUE;
+}
+
+EventGroupHandle_t xEventGroupCreate(void)
+{
+    return calloc(1, sizeof(struct sim_event_group));
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits)
+{
+    group->bits |= bits;
+    return group->bits;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits)
+{
+    EventBits_t previous = group->bits;
+    group->bits &= ~bits;
+    return previous;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group)
+{
+    return group->bits;
+}
+
+typedef struct
+{
+    EventGroupHandle_t group;
+    EventBits_t bits;
+    bool all;
+} sim_event_wait_t;
+
+static bool sim_event_ready(void* ctx)
+{
+    sim_event_wait_t* wait = ctx;
+    EventBits_t set = wait->group->bits & wait->bits;
+    return wait->all ? set == wait->bits : set != 0;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits, BaseType_t clear_on_exit,
+                                BaseType_t wait_for_all, TickType_t ticks_to_wait)
+{
+    sim_event_wait_t wait = {.group = group, .bits = bits, .all = wait_for_all};
+    bool ready = sim_block_until(sim_event_ready, &wait, sim_deadline(ticks_to_wait));
+    EventBits_t value = group->bits;
+    if (ready && clear_on_exit)
+    {
+        group->bits &= ~bits;
+    }
+    return value;
+}
+
+/* 定时器服务任务：按顺序执行推迟的函数 */
+static void sim_timer_task(void* arg)
+{
+    (void)arg;
+    for (int i = 0; i < s_pended_count; i++)
+    {
+        sim_pended_call_t call = s_pended[i];
+        call.function(call.param1, call.param2);
+    }
+    s_pended_count = 0;
+}
+
+static BaseType_t sim_pend_call(PendedFunction_t function, void* param1, uint32_t param2)
+{
+    if (!s_timer_task)
+    {
+        s_timer_task = sim_task_create("Tmr Svc", sim_timer_task, NULL);
+    }
+    if (s_pended_count >= SIM_PENDED_CALLS)
+    {
+        return pdFAIL;
+    }
+    s_pended[s_pended_count++] = (sim_pended_call_t){.function = function, .param1 = param1, .param2 = param2};
+    sim_notify(s_timer_task, 0, 0, eNoAction);
+    return pdPASS;
+}
+
+BaseType_t xTimerPendFunctionCallFromISR(PendedFunction_t function, void* param1, uint32_t param2,
+                                         BaseType_t* task_woken)
+{
+    if (task_woken)
+    {
+        *task_woken = pdTRUE;
+    }
+    return sim_pend_call(function, param1, param2);
+}
+
+BaseType_t xTimerPendFunctionCall(PendedFunction_t function, void* param1, uint32_t param2, TickType_t ticks_to_wait)
+{
+    (void)ticks_to_wait;
+    BaseType_t ret = sim_pend_call(function, param1, param2);
+    sim_run_ready_tasks();
+    return ret;
+}
@@ -0,0 +1,929 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "binlog.h"
+#include "clock_logic.h"
+#include "clock_sweep.h"
+#include "esp_log.h"
+#include "pos_journal.h"
+#include "sdkconfig.h"
+#include "sim.h"
+#include "step_motor.h"
+#include "time_source.h"
+
+// 虚拟时间回放：按 clock_control_task 的节奏在整分钟和时间跳变时检查墙上时间，
+// 分钟跳变、SNTP 跳变和手动调整都通过真实的驱动与规划器执行
+
+#define US_PER_S 1000000ULL
+#define STEPS_PER_REV 4096
+#define MAX_SIM_HOURS (24 * 31)
+#define MINUTE_TICK_MARGIN_US 1000
+#define SIM_PLAYBACK_MAX_STEPS 1024  // 与 CONFIG_STEP_MOTOR_PLAYBACK_MAX_STEPS 的默认值相同
+#define SIM_POWER_CUT_AT_S (7 * 3600 + 12 * 60 + 30)  // --power-cut 的断电时刻，落在两次分钟跳动之间
+#define SIM_POWER_SNTP_DELAY_S 45   // 重启后多久 SNTP 同步成功
+#define SIM_WINDOW_JUMP_LEAD_S 40   // --journal-window 的 SNTP 跳变比断电早多久
+#define SIM_WINDOW_JUMP_S (5 * 60)  // --journal-window 的 SNTP 跳变幅度，足以触发追赶
+#define SIM_MAX_EVENTS 8
+
+typedef enum
+{
+    SIM_EVENT_SNTP_JUMP,  // 墙上时间跳变 arg 秒
+    SIM_EVENT_ADJUST,     // 调用 set_clock_target_time(arg / 60, arg % 60)
+    SIM_EVENT_POWER_CUT,  // 断电 arg 秒后重启，RTC 时间丢失
+    SIM_EVENT_SNTP_SYNC,  // 重启后 SNTP 同步，墙上时间回到真实时间
+    SIM_EVENT_RESET,      // 软件复位 arg 秒后重启，RTC 内存、RTC 定时器和系统时间都保留
+} sim_event_type_t;
+
+typedef struct
+{
+    uint64_t at_s;        // 仿真开始后的秒数
+    sim_event_type_t type;
+    int64_t arg;
+} sim_event_t;
+
+// 默认场景：一次大幅 SNTP 同步、一次小幅回拨和一次手动调整
+static const sim_event_t s_default_events[] = {
+    {.at_s = 2 * 3600 + 17, .type = SIM_EVENT_SNTP_JUMP, .arg = 3 * 3600 + 27 * 60},
+    {.at_s = 13 * 3600 + 5, .type = SIM_EVENT_SNTP_JUMP, .arg = -90},
+    {.at_s = 18 * 3600 + 30, .type = SIM_EVENT_ADJUST, .arg = 10 * 60 + 30},
+};
+
+typedef struct
+{
+    FILE* trace;
+    uint32_t last_phase;
+    int phase_index;          // 上一个非零相位在八拍表中的下标
+    int64_t observed_position; // 由相位序列还原的位置
+    uint64_t steps;
+    uint64_t invalid_transitions;
+    uint64_t last_step_us;
+    uint64_t min_interval_us;
+    uint64_t phase_histogram[16];
+} sim_recorder_t;
+
+typedef struct
+{
+    motor_control_t* motor_control; // 主电机，断电重启后换成新建的驱动
+    clock_logic_t logic;            // 与 clock_control_task 共用的判定，回调在下面
+    uint64_t move_start_us;         // 当前这次运动开始的仿真时间
+    int64_t wall_offset_s;   // 墙上时间相对仿真时间的偏移（含 SNTP 跳变）
+    clock_time_t current_time;
+    clock_time_t target_time;
+    bool adjust_requested;
+    uint64_t moves;
+    uint64_t move_time_us;
+    uint64_t longest_move_us;
+    uint64_t catch_ups;
+    uint64_t catch_up_longest_us;
+    int32_t catch_up_max_miss;   // 追赶结束时指针与墙上时间的最大偏差（步）
+    clock_sweep_t sweep;         // 扫动模式的锁相环
+    uint64_t sweep_starts;
+    uint64_t sweep_locked_since_us; // 最近一次开始扫动的时间，之后一小时内视为入锁过程
+    int32_t sweep_max_error_us;     // 入锁后的最大相位误差
+    motor_control_t* followers[STEPPER_GROUP_MAX_MOTORS - 1]; // --motors 时与主电机共用组定时器的电机
+    int follower_count;
+    pos_journal_handle_t journal;   // 指针位置日志，NVS 替身跨越断电保留
+    pos_journal_stats_t journal_stats; // 断电前已丢弃的日志句柄的统计
+    int64_t true_offset_s;          // 断电期间 RTC 丢失，真实的墙上时间偏移留给 SNTP 同步恢复
+    uint64_t power_cuts;
+    int restore_mismatches;         // 恢复的位置或相位与转子实际停下的不一致
+    int32_t restore_lost_steps;     // 转子实际位置减去恢复的位置
+    time_source_t time_source;      // 与 clock_control_task 相同的时间来源分级
+    time_source_rtc_record_t rtc_record; // RTC 内存，复位后保留，断电后丢失
+    uint64_t boot_us;               // 最近一次启动的仿真时间，esp_timer 从这里开始计数
+    uint64_t rtc_base_us;           // 最近一次上电的仿真时间，RTC 定时器从这里开始计数
+    bool time_trusted;
+    uint64_t untrusted_wakeups;     // 时间不可信、指针停住不动的醒来次数
+    int64_t boot_to_trusted_us;     // 最近一次启动到时间可信，-1 表示还没有
+    uint64_t boot_catch_ups;        // 最近一次启动时的追赶次数，之后的差值即重启后的追赶次数
+    time_source_id_t boot_source;   // 最近一次启动时最好的时间来源
+} sim_clock_t;
+
+static const uint8_t s_phase_order[8] = {0x08, 0x0C, 0x04, 0x06, 0x02, 0x03, 0x01, 0x09};
+
+static int phase_to_index(uint32_t phase)
+{
+    for (int i = 0; i < 8; i++)
+    {
+        if (s_phase_order[i] == phase)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void record_phase(uint64_t now_us, int motor, uint32_t value, void* ctx)
+{
+    if (motor < 0 || motor >= STEPPER_GROUP_MAX_MOTORS)
+    {
+        return;
+    }
+    sim_recorder_t* rec = (sim_recorder_t*)ctx + motor;
+    if (value == rec->last_phase)
+    {
+        return;
+    }
+    rec->last_phase = value;
+    if (!value)
+    {
+        return;
+    }
+    rec->phase_histogram[value & 0x0F]++;
+    int index = phase_to_index(value);
+    if (index < 0)
+    {
+        rec->invalid_transitions++;
+    }
+    else if (rec->phase_index >= 0)
+    {
+        int delta = (index - rec->phase_index + 8) % 8;
+        if (delta == 1 || delta == 2)
+        {
+            rec->observed_position += delta;
+        }
+        else if (delta == 7 || delta == 6)
+        {
+            rec->observed_position -= 8 - delta;
+        }
+        else
+        {
+            rec->invalid_transitions++;
+        }
+    }
+    if (index >= 0)
+    {
+        rec->phase_index = index;
+    }
+    if (rec->steps && now_us - rec->last_step_us < rec->min_interval_us)
+    {
+        rec->min_interval_us = now_us - rec->last_step_us;
+    }
+    rec->last_step_us = now_us;
+    rec->steps++;
+    if (rec->trace)
+    {
+        fprintf(rec->trace, "%llu,0x%X,%lld\n", (unsigned long long)now_us, value,
+                (long long)rec->observed_position);
+    }
+}
+
+static void sim_wall_time(const sim_clock_t* sim_clock, clock_time_t* out)
+{
+    int64_t wall_s = (int64_t)(sim_now_us() / US_PER_S) + sim_clock->wall_offset_s;
+    int64_t seconds_of_day = ((wall_s % 86400) + 86400) % 86400;
+    out->hour = (int)(seconds_of_day / 3600);
+    out->minute = (int)(seconds_of_day / 60 % 60);
+    out->second = (int)(seconds_of_day % 60);
+}
+
+static int64_t sim_wall_us(const sim_clock_t* sim_clock)
+{
+    return (int64_t)sim_now_us() + sim_clock->wall_offset_s * (int64_t)US_PER_S;
+}
+
+/* 与 clock_time_update 相同：按当前墙上时间重新锚定一个来源，esp_timer 从启动时开始计数 */
+static void sim_time_update(sim_clock_t* sim_clock, time_source_id_t source, int64_t epoch_us,
+                            uint32_t uncertainty_ms)
+{
+    time_source_update(&sim_clock->time_source, source, epoch_us, uncertainty_ms,
+                       (int64_t)(sim_now_us() - sim_clock->boot_us));
+}
+
+/* 与 clock_time_save、clock_time_check_trusted 相同：每次醒来存一次 RTC 记录，返回时间是否可信 */
+static bool sim_time_check_trusted(sim_clock_t* sim_clock)
+{
+    int64_t mono_us = (int64_t)(sim_now_us() - sim_clock->boot_us);
+    time_source_save(&sim_clock->time_source, mono_us, sim_now_us() - sim_clock->rtc_base_us,
+                     &sim_clock->rtc_record);
+    time_estimate_t best = time_source_best(&sim_clock->time_source, mono_us);
+    sim_clock->time_trusted = best.trusted;
+    if (best.trusted && sim_clock->boot_to_trusted_us < 0)
+    {
+        sim_clock->boot_to_trusted_us = mono_us;
+    }
+    return best.trusted;
+}
+
+static uint32_t sim_wall_seconds(const sim_clock_t* sim_clock)
+{
+    return (uint32_t)((int64_t)(sim_now_us() / US_PER_S) + sim_clock->wall_offset_s);
+}
+
+/* 与 clock_journal_position 相同：指针停下后记入位置日志，force 时立即提交 */
+static void sim_journal_position(void* ctx, bool force)
+{
+    sim_clock_t* sim_clock = ctx;
+    int position;
+    int step_index;
+    stepper_get_position_phase(sim_clock->motor_control, &position, &step_index);
+    ESP_ERROR_CHECK(pos_journal_append(sim_clock->journal, position, (uint8_t)step_index,
+                                       sim_wall_seconds(sim_clock)));
+    if (force)
+    {
+        ESP_ERROR_CHECK(pos_journal_flush(sim_clock->journal));
+    }
+}
+
+/* 跟随的电机与主电机同时开始走向同一目标，截止时间相同，由同一次中断一起服务 */
+static void sim_followers_move(const sim_clock_t* sim_clock, int32_t target, uint32_t rpm, stepper_drive_mode_t mode,
+                               stepper_move_handle_t* moves)
+{
+    for (int i = 0; i < sim_clock->follower_count; i++)
+    {
+        moves[i] = stepper_move_to(sim_clock->followers[i], target, rpm, mode);
+    }
+}
+
+static void sim_followers_wait(const sim_clock_t* sim_clock, const stepper_move_handle_t* moves)
+{
+    for (int i = 0; i < sim_clock->follower_count; i++)
+    {
+        ESP_ERROR_CHECK(stepper_wait_move(sim_clock->followers[i], moves[i], portMAX_DELAY));
+    }
+}
+
+/* 时钟任务下一次醒来的时间：墙上时间的下一个整分钟（同固件的定时器余量），
+ * 或下一次 SNTP 跳变、调整请求，后者在固件里由同步回调和事件位唤醒 */
+static uint64_t sim_next_wake_us(const sim_clock_t* sim_clock, const sim_event_t* next_event)
+{
+    uint64_t now = sim_now_us();
+    int64_t wall_us = (int64_t)now + sim_clock->wall_offset_s * (int64_t)US_PER_S;
+    int64_t minute_us = 60 * (int64_t)US_PER_S;
+    uint64_t wake = now + (uint64_t)(minute_us - ((wall_us % minute_us) + minute_us) % minute_us) + MINUTE_TICK_MARGIN_US;
+    if (next_event && next_event->at_s * US_PER_S < wake)
+    {
+        wake = next_event->at_s * US_PER_S;
+    }
+    return wake > now ? wake : now;
+}
+
+static int64_t sim_wall_us_of_day(const sim_clock_t* sim_clock)
+{
+    int64_t wall_us = (int64_t)sim_now_us() + sim_clock->wall_offset_s * (int64_t)US_PER_S;
+    int64_t day_us = 86400 * (int64_t)US_PER_S;
+    return ((wall_us % day_us) + day_us) % day_us;
+}
+
+static uint64_t sim_catch_up_move_time(int32_t from, int32_t to, void* ctx)
+{
+    motor_control_t* motor_control = ((sim_clock_t*)ctx)->motor_control;
+    int32_t distance = clock_step_distance(from, to, STEPS_PER_REV);
+    return stepper_move_duration_us(motor_control, distance < 0 ? -distance : distance, stepper_max_rpm(motor_control),
+                                    STEPPER_DRIVE_FULL);
+}
+
+// clock_logic 的回调：与 clock_control_task 的回调做同样的运动，另外记下仿真的统计；
+// 跟随的电机与主电机同时走向同一目标
+static int64_t sim_ops_wall_us_of_day(void* ctx)
+{
+    return sim_wall_us_of_day((const sim_clock_t*)ctx);
+}
+
+static int32_t sim_ops_get_position(void* ctx)
+{
+    return stepper_get_position(((sim_clock_t*)ctx)->motor_control);
+}
+
+static void sim_ops_move_begin(void* ctx, clock_move_kind_t kind, int32_t from, int32_t target)
+{
+    ((sim_clock_t*)ctx)->move_start_us = sim_now_us();
+}
+
+/* 与 clock_control_task 相同的转速和驱动方式 */
+static int sim_ops_move_to(void* ctx, clock_move_kind_t kind, int32_t target, uint64_t predicted_us)
+{
+    sim_clock_t* sim_clock = ctx;
+    motor_control_t* motor_control = sim_clock->motor_control;
+    uint32_t rpm = CLOCK_MINUTE_RPM;
+    stepper_drive_mode_t mode = motor_control->drive_mode;
+    if (kind == CLOCK_MOVE_CATCH_UP)
+    {
+        rpm = stepper_max_rpm(motor_control);
+        mode = STEPPER_DRIVE_FULL;
+    }
+    else if (kind == CLOCK_MOVE_ADJUST)
+    {
+        rpm = CLOCK_ADJUST_RPM;
+        mode = STEPPER_DRIVE_FULL;
+    }
+    stepper_move_handle_t follower_moves[STEPPER_GROUP_MAX_MOTORS - 1];
+    stepper_move_handle_t move = stepper_move_to(motor_control, target, rpm, mode);
+    sim_followers_move(sim_clock, target, rpm, mode, follower_moves);
+    esp_err_t err = stepper_wait_move(motor_control, move, portMAX_DELAY);
+    sim_followers_wait(sim_clock, follower_moves);
+    return err;
+}
+
+static void sim_ops_move_end(void* ctx, clock_move_kind_t kind, int32_t from, int32_t target, int err)
+{
+    sim_clock_t* sim_clock = ctx;
+    ESP_ERROR_CHECK(err);
+    uint64_t elapsed = sim_now_us() - sim_clock->move_start_us;
+    if (kind == CLOCK_MOVE_ADJUST)
+    {
+        sim_clock->current_time = sim_clock->target_time;
+    }
+    if (kind != CLOCK_MOVE_CATCH_UP)
+    {
+        sim_clock->moves++;
+        sim_clock->move_time_us += elapsed;
+        if (elapsed > sim_clock->longest_move_us)
+        {
+            sim_clock->longest_move_us = elapsed;
+        }
+        return;
+    }
+
+    sim_clock->catch_ups++;
+    if (elapsed > sim_clock->catch_up_longest_us)
+    {
+        sim_clock->catch_up_longest_us = elapsed;
+    }
+    sim_wall_time(sim_clock, &sim_clock->current_time);
+    int32_t miss = clock_step_distance(stepper_get_position(sim_clock->motor_control),
+                                       clock_time_to_step(sim_clock->current_time.hour,
+                                                          sim_clock->current_time.minute, STEPS_PER_REV),
+                                       STEPS_PER_REV);
+    miss = miss < 0 ? -miss : miss;
+    if (miss > sim_clock->catch_up_max_miss)
+    {
+        sim_clock->catch_up_max_miss = miss;
+    }
+}
+
+static bool sim_ops_is_sweeping(void* ctx)
+{
+    return stepper_is_sweeping(((sim_clock_t*)ctx)->motor_control);
+}
+
+static void sim_ops_stop(void* ctx)
+{
+    stepper_stop(((sim_clock_t*)ctx)->motor_control);
+}
+
+/* 入锁一小时后的相位误差计入最大误差 */
+static bool sim_ops_sweep_update(void* ctx, int64_t us_of_day)
+{
+    sim_clock_t* sim_clock = ctx;
+    int32_t error_us = clock_sweep_update(&sim_clock->sweep, sim_clock->motor_control, us_of_day);
+    if (error_us > CLOCK_SWEEP_LOCK_RANGE_US || error_us < -CLOCK_SWEEP_LOCK_RANGE_US)
+    {
+        return false;
+    }
+    int32_t abs_error = error_us < 0 ? -error_us : error_us;
+    if (sim_now_us() - sim_clock->sweep_locked_since_us >= 3600 * US_PER_S && abs_error > sim_clock->sweep_max_error_us)
+    {
+        sim_clock->sweep_max_error_us = abs_error;
+    }
+    return true;
+}
+
+static void sim_ops_sweep_start(void* ctx, int64_t us_of_day)
+{
+    sim_clock_t* sim_clock = ctx;
+    ESP_ERROR_CHECK(clock_sweep_start(&sim_clock->sweep, sim_clock->motor_control, us_of_day));
+    sim_clock->sweep_starts++;
+    sim_clock->sweep_locked_since_us = sim_now_us();
+}
+
+static const clock_logic_ops_t s_sim_logic_ops = {
+    .wall_us_of_day = sim_ops_wall_us_of_day,
+    .get_position = sim_ops_get_position,
+    .move_begin = sim_ops_move_begin,
+    .move_end = sim_ops_move_end,
+    .move_to = sim_ops_move_to,
+    .catch_up_time = sim_catch_up_move_time,
+    .journal = sim_journal_position,
+    .is_sweeping = sim_ops_is_sweeping,
+    .stop = sim_ops_stop,
+    .sweep_update = sim_ops_sweep_update,
+    .sweep_start = sim_ops_sweep_start,
+};
+
+/* 与 app_main 相同的驱动，输出换成仿真后端；playback_rate 非零时加上仿真的回放后端 */
+static motor_control_t* sim_motor_new(stepper_group_t* group, int index, uint32_t playback_rate)
+{
+    stepper_config_t config = {
+        .phase_gpios = {4 * index, 4 * index + 1, 4 * index + 2, 4 * index + 3},
+        .playback_min_rate = playback_rate,
+    };
+    ESP_ERROR_CHECK(sim_new_step_output(index, 0, &config.output));
+    if (playback_rate)
+    {
+        ESP_ERROR_CHECK(sim_new_step_output(index, SIM_PLAYBACK_MAX_STEPS + 1, &config.playback));
+    }
+    return stepper_driver_new(group, &config);
+}
+
+static void sim_journal_open(sim_clock_t* sim_clock)
+{
+    const pos_journal_config_t config = POS_JOURNAL_DEFAULT_CONFIG();
+    ESP_ERROR_CHECK(pos_journal_new(&config, &sim_clock->journal));
+}
+
+/* 断电：驱动和日志句柄随内存一起丢失，还没提交的记录和它的提交定时器也不会写出，转子停在最后通电的相位上。
+ * 停电 outage_s 秒后重启，RTC 和 RTC 内存都从头开始；与 clock_control_task 一样从日志恢复位置和相位，
+ * 日志时间只是下限，指针停在原处，SNTP 同步后只追赶一次。soft 时是软件复位，RTC 内存里的估计
+ * 加上 RTC 定时器走过的时间立即可信，重启时就补上复位期间的分钟 */
+static motor_control_t* sim_power_cycle(motor_control_t* motor_control, stepper_group_t* group,
+                                        uint32_t playback_rate, sim_clock_t* sim_clock,
+                                        const sim_recorder_t* rec, bool sweep, int64_t outage_s, bool soft)
+{
+    pos_journal_stats_t stats;
+    ESP_ERROR_CHECK(pos_journal_get_stats(sim_clock->journal, &stats));
+    sim_clock->journal_stats.commits += stats.commits;
+    sim_clock->journal_stats.coalesced += stats.coalesced;
+    sim_clock->journal = NULL;
+    sim_esp_timers_power_off();
+    stepper_driver_deinit(motor_control);
+    sim_clock->power_cuts++;
+    sim_clock->true_offset_s = sim_clock->wall_offset_s;
+    sim_run_until(sim_now_us() + (uint64_t)outage_s * US_PER_S);
+    if (!soft)
+    {
+        sim_clock->wall_offset_s = -(int64_t)(sim_now_us() / US_PER_S);
+        sim_clock->rtc_base_us = sim_now_us();
+        memset(&sim_clock->rtc_record, 0xA5, sizeof(sim_clock->rtc_record));
+    }
+    sim_clock->boot_us = sim_now_us();
+    sim_clock->boot_to_trusted_us = -1;
+    sim_clock->boot_catch_ups = sim_clock->catch_ups;
+    time_source_init(&sim_clock->time_source, CONFIG_HOLLOW_CLOCK_TIME_DRIFT_PPM, CONFIG_HOLLOW_CLOCK_TIME_TRUST_MS);
+    time_source_restore(&sim_clock->time_source, &sim_clock->rtc_record, sim_now_us() - sim_clock->rtc_base_us,
+                        CONFIG_HOLLOW_CLOCK_RTC_DRIFT_PPM, 0);
+
+    motor_control = sim_motor_new(group, 0, playback_rate);
+    if (!motor_control)
+    {
+        abort();
+    }
+    sim_clock->motor_control = motor_control;
+    sim_journal_open(sim_clock);
+    pos_journal_record_t record;
+    if (pos_journal_recover(sim_clock->journal, &record) != ESP_OK ||
+        stepper_restore_position(motor_control, record.position, record.step_index) != ESP_OK)
+    {
+        sim_clock->restore_mismatches++;
+        return motor_control;
+    }
+    // 分钟跳动模式在两次跳动之间断电，日志应与转子完全一致；扫动模式最多丢掉上次记录后走的几步，
+    // 只要不到半个八拍周期，下一步通电时转子会被拉回驱动认为的位置
+    int32_t lost = (int32_t)(rec->observed_position - record.position);
+    sim_clock->restore_lost_steps = lost;
+    if ((!sweep && (lost || record.step_index != rec->phase_index)) || lost >= 4 || lost <= -4)
+    {
+        sim_clock->restore_mismatches++;
+    }
+    sim_time_update(sim_clock, TIME_SOURCE_JOURNAL, (int64_t)record.timestamp * (int64_t)US_PER_S,
+                    TIME_SOURCE_UNBOUNDED);
+    sim_clock->boot_source = time_source_best(&sim_clock->time_source, 0).source;
+    if (sim_clock->boot_source == TIME_SOURCE_JOURNAL && sim_wall_seconds(sim_clock) < record.timestamp)
+    {
+        sim_clock->wall_offset_s = (int64_t)record.timestamp - (int64_t)(sim_now_us() / US_PER_S);
+    }
+    sim_wall_time(sim_clock, &sim_clock->current_time);
+    if (sweep)
+    {
+        ESP_ERROR_CHECK(clock_sweep_init(&sim_clock->sweep, STEPS_PER_REV));
+    }
+    clock_logic_boot(&sim_clock->logic, &sim_clock->current_time, sim_time_check_trusted(sim_clock), true);
+    return motor_control;
+}
+
+// 相当于 binlog 的排空任务：--verbose 时格式化输出，--binlog 时按原始格式写给 binlog_decode
+typedef struct
+{
+    uint64_t entries;
+    FILE* raw;
+} sim_binlog_t;
+
+static void sim_binlog_sink(const binlog_entry_t* entry, void* ctx)
+{
+    sim_binlog_t* log = (sim_binlog_t*)ctx;
+    log->entries++;
+    if (log->raw)
+    {
+        const uint8_t* bytes = (const uint8_t*)entry;
+        fprintf(log->raw, "BL ");
+        for (size_t i = 0; i < sizeof(*entry); i++)
+        {
+            fprintf(log->raw, "%02x", bytes[i]);
+        }
+        fprintf(log->raw, "\n");
+    }
+    if (sim_log_verbose)
+    {
+        char text[128];
+        const char* tag = binlog_format(entry, text, sizeof(text));
+        fprintf(stderr, "B (%u) %s: %s\n", (unsigned)(entry->time_us / 1000), tag, text);
+    }
+}
+
+static void usage(const char* prog)
+{
+    fprintf(stderr, "usage: %s [--hours N] [--isr-jitter US] [--quiet-events] [--trace FILE] [--binlog FILE] "
+                    "[--sweep] [--timer-ppm PPM] [--motors N] [--playback RATE] [--power-cut S | --reset S] "
+                    "[--journal-window] [--verbose]\n",
+            prog);
+}
+
+int main(int argc, char** argv)
+{
+    int hours = 24;
+    int motors = 1;
+    uint32_t playback_rate = 0;
+    uint32_t isr_jitter_us = 0;
+    int64_t power_cut_s = 0;
+    bool soft_reset = false;
+    bool journal_window = false;
+    bool with_events = true;
+    bool sweep = false;
+    const char* trace_path = NULL;
+    const char* binlog_path = NULL;
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--hours") && i + 1 < argc)
+        {
+            hours = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--isr-jitter") && i + 1 < argc)
+        {
+            isr_jitter_us = (uint32_t)atoi(argv[++i]);
+            sim_set_alarm_jitter(isr_jitter_us);
+        }
+        else if (!strcmp(argv[i], "--quiet-events"))
+        {
+            with_events = false;
+        }
+        else if (!strcmp(argv[i], "--trace") && i + 1 < argc)
+        {
+            trace_path = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--binlog") && i + 1 < argc)
+        {
+            binlog_path = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--sweep"))
+        {
+            sweep = true;
+        }
+        else if (!strcmp(argv[i], "--timer-ppm") && i + 1 < argc)
+        {
+            sim_set_timer_ppm(atoi(argv[++i]));
+        }
+        else if (!strcmp(argv[i], "--motors") && i + 1 < argc)
+        {
+            motors = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--playback") && i + 1 < argc)
+        {
+            playback_rate = (uint32_t)atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--power-cut") && i + 1 < argc)
+        {
+            power_cut_s = atoll(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--reset") && i + 1 < argc)
+        {
+            power_cut_s = atoll(argv[++i]);
+            soft_reset = true;
+        }
+        else if (!strcmp(argv[i], "--journal-window"))
+        {
+            journal_window = true;
+        }
+        else if (!strcmp(argv[i], "--verbose"))
+        {
+            sim_log_verbose = 1;
+        }
+        else
+        {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    // 扫动和断电只针对主电机，跟随的电机只在分钟跳动模式下回放；停电须在下一次默认事件之前结束
+    if (hours <= 0 || hours > MAX_SIM_HOURS || motors < 1 || motors > STEPPER_GROUP_MAX_MOTORS ||
+        ((sweep || power_cut_s) && motors > 1) || power_cut_s < 0 || power_cut_s > 5 * 3600 ||
+        (journal_window && !power_cut_s))
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    // 驱动的相位下标与位置同步前进，位置 0 对应第 0 拍
+    sim_recorder_t recs[STEPPER_GROUP_MAX_MOTORS];
+    for (int i = 0; i < STEPPER_GROUP_MAX_MOTORS; i++)
+    {
+        recs[i] = (sim_recorder_t){.phase_index = 0, .min_interval_us = UINT64_MAX};
+    }
+    sim_recorder_t* rec = &recs[0];
+    if (trace_path)
+    {
+        rec->trace = fopen(trace_path, "w");
+        if (!rec->trace)
+        {
+            perror(trace_path);
+            return 1;
+        }
+        fprintf(rec->trace, "t_us,phase,position\n");
+    }
+    sim_set_phase_observer(record_phase, recs);
+
+    sim_binlog_t binlog = {0};
+    if (binlog_path)
+    {
+        binlog.raw = fopen(binlog_path, "w");
+        if (!binlog.raw)
+        {
+            perror(binlog_path);
+            return 1;
+        }
+    }
+
+    // 命令由仿真的步进中断直接取出；--playback 时静止起步且不低于该频率的运动交给仿真的回放后端。
+    // 其余电机接在同一个组定时器上
+    stepper_group_t* group = NULL;
+    ESP_ERROR_CHECK(stepper_group_new(&group));
+    motor_control_t* motor_controls[STEPPER_GROUP_MAX_MOTORS];
+    for (int i = 0; i < motors; i++)
+    {
+        motor_controls[i] = sim_motor_new(group, i, playback_rate);
+        if (!motor_controls[i])
+        {
+            return 1;
+        }
+    }
+    motor_control_t* motor_control = motor_controls[0];
+    sim_clock_t sim_clock = {
+        .motor_control = motor_control,
+        .logic = {
+            .ops = &s_sim_logic_ops,
+            .steps_per_rev = STEPS_PER_REV,
+            .sweep = sweep,
+        },
+    };
+    sim_clock.logic.ctx = &sim_clock;
+    for (int i = 1; i < motors; i++)
+    {
+        sim_clock.followers[sim_clock.follower_count++] = motor_controls[i];
+    }
+
+    // 指针从 00:00 开始，与墙上时间对齐；位置日志一开始是空的，时间已经由 SNTP 同步
+    sim_journal_open(&sim_clock);
+    time_source_init(&sim_clock.time_source, CONFIG_HOLLOW_CLOCK_TIME_DRIFT_PPM, CONFIG_HOLLOW_CLOCK_TIME_TRUST_MS);
+    sim_time_update(&sim_clock, TIME_SOURCE_SNTP, sim_wall_us(&sim_clock), TIME_SOURCE_SNTP_UNCERTAINTY_MS);
+    sim_clock.boot_to_trusted_us = -1;
+    sim_time_check_trusted(&sim_clock);
+    sim_wall_time(&sim_clock, &sim_clock.current_time);
+    if (sweep)
+    {
+        ESP_ERROR_CHECK(clock_sweep_init(&sim_clock.sweep, STEPS_PER_REV));
+    }
+    clock_logic_boot(&sim_clock.logic, &sim_clock.current_time, sim_clock.time_trusted, false);
+
+    // 默认场景按时间顺序插入 --power-cut 的断电和重启后的 SNTP 同步。--journal-window 时断电前 40 秒
+    // 先跳变 5 分钟：追赶后立即提交，10 秒后的分钟跳动落在最短提交间隔内暂不提交，
+    // 断电落在提交截止之后、下一次分钟跳动之前
+    sim_event_t events[SIM_MAX_EVENTS];
+    size_t event_count = 0;
+    size_t default_count = with_events ? sizeof(s_default_events) / sizeof(s_default_events[0]) : 0;
+    bool cut_pending = power_cut_s > 0;
+    for (size_t i = 0; i <= default_count; i++)
+    {
+        if (cut_pending && (i == default_count || s_default_events[i].at_s > SIM_POWER_CUT_AT_S))
+        {
+            if (journal_window)
+            {
+                events[event_count++] = (sim_event_t){.at_s = SIM_POWER_CUT_AT_S - SIM_WINDOW_JUMP_LEAD_S,
+                                                      .type = SIM_EVENT_SNTP_JUMP,
+                                                      .arg = SIM_WINDOW_JUMP_S};
+            }
+            events[event_count++] = (sim_event_t){.at_s = SIM_POWER_CUT_AT_S,
+                                                  .type = soft_reset ? SIM_EVENT_RESET : SIM_EVENT_POWER_CUT,
+                                                  .arg = power_cut_s};
+            events[event_count++] = (sim_event_t){.at_s = SIM_POWER_CUT_AT_S + power_cut_s + SIM_POWER_SNTP_DELAY_S,
+                                                  .type = SIM_EVENT_SNTP_SYNC};
+            cut_pending = false;
+        }
+        if (i < default_count)
+        {
+            events[event_count++] = s_default_events[i];
+        }
+    }
+    size_t next_event = 0;
+    double cpu_per_hour[MAX_SIM_HOURS] = {0};
+    clock_t cpu_hour_start = clock();
+    int hour_index = 0;
+
+    const uint64_t end_us = (uint64_t)hours * 3600 * US_PER_S;
+    uint64_t wakeups = 0;
+    uint64_t next_check_us = sim_next_wake_us(&sim_clock, event_count ? &events[0] : NULL);
+    while (next_check_us <= end_us)
+    {
+        sim_run_until(next_check_us);
+        wakeups++;
+
+        while (next_event < event_count && events[next_event].at_s * US_PER_S <= sim_now_us())
+        {
+            const sim_event_t* event = &events[next_event++];
+            if (event->type == SIM_EVENT_SNTP_JUMP)
+            {
+                sim_clock.wall_offset_s += event->arg;
+                sim_time_update(&sim_clock, TIME_SOURCE_SNTP, sim_wall_us(&sim_clock), TIME_SOURCE_SNTP_UNCERTAINTY_MS);
+            }
+            else if (event->type == SIM_EVENT_POWER_CUT || event->type == SIM_EVENT_RESET)
+            {
+                motor_control = sim_power_cycle(motor_control, group, playback_rate, &sim_clock, rec, sweep,
+                                                event->arg, event->type == SIM_EVENT_RESET);
+            }
+            else if (event->type == SIM_EVENT_SNTP_SYNC)
+            {
+                sim_clock.wall_offset_s = sim_clock.true_offset_s;
+                sim_time_update(&sim_clock, TIME_SOURCE_SNTP, sim_wall_us(&sim_clock), TIME_SOURCE_SNTP_UNCERTAINTY_MS);
+            }
+            else
+            {
+                // 与 set_clock_target_time 相同，记为手动来源；SNTP 更好时不改变墙上时间
+                sim_clock.target_time.hour = (int)(event->arg / 60);
+                sim_clock.target_time.minute = (int)(event->arg % 60);
+                sim_clock.adjust_requested = true;
+                int64_t manual_us = sim_wall_us(&sim_clock) - sim_wall_us_of_day(&sim_clock) +
+                                    event->arg * 60 * (int64_t)US_PER_S;
+                sim_time_update(&sim_clock, TIME_SOURCE_MANUAL, manual_us, TIME_SOURCE_MANUAL_UNCERTAINTY_MS);
+            }
+        }
+
+        // 与 clock_control_task 相同：在整分钟、SNTP 同步或调整请求时醒来，分钟变化或时间刚变为可信时
+        // 转动指针；时间不可信时指针不动
+        clock_time_t old_time = sim_clock.current_time;
+        sim_wall_time(&sim_clock, &sim_clock.current_time);
+        bool was_trusted = sim_clock.time_trusted;
+        bool trusted = sim_time_check_trusted(&sim_clock);
+        if (!trusted)
+        {
+            sim_clock.untrusted_wakeups++;
+        }
+        clock_logic_wake(&sim_clock.logic, &old_time, &sim_clock.current_time, was_trusted, trusted);
+        if (sim_clock.adjust_requested)
+        {
+            sim_clock.adjust_requested = false;
+            clock_logic_adjust(&sim_clock.logic, &sim_clock.target_time);
+        }
+
+        while ((uint64_t)(hour_index + 1) * 3600 * US_PER_S <= sim_now_us() && hour_index < hours)
+        {
+            clock_t now = clock();
+            cpu_per_hour[hour_index++] = (double)(now - cpu_hour_start) / CLOCKS_PER_SEC;
+            cpu_hour_start = now;
+        }
+        binlog_drain(sim_binlog_sink, &binlog);
+        next_check_us = sim_next_wake_us(&sim_clock, next_event < event_count ? &events[next_event] : NULL);
+    }
+    sim_run_until(sim_now_us() + US_PER_S);
+    binlog_drain(sim_binlog_sink, &binlog);
+    if (hour_index < hours)
+    {
+        cpu_per_hour[hour_index++] = (double)(clock() - cpu_hour_start) / CLOCKS_PER_SEC;
+    }
+
+    // 结果：理想位置按墙上时间的精确分数步计算
+    clock_time_t wall;
+    sim_wall_time(&sim_clock, &wall);
+    double ideal = ((wall.hour % 12) * 60 + wall.minute) * (double)STEPS_PER_REV / 720.0;
+    int position = stepper_get_position(motor_control);
+    double error = ((position % STEPS_PER_REV) + STEPS_PER_REV) % STEPS_PER_REV - ideal;
+    if (sweep)
+    {
+        // 扫动模式的理想位置随时间连续变化，指针位置也取连续值
+        error = clock_sweep_distance_q16(clock_sweep_ideal_q16(sim_wall_us_of_day(&sim_clock), STEPS_PER_REV),
+                                         stepper_sweep_position_q16(motor_control), STEPS_PER_REV) / 65536.0;
+    }
+    if (error > STEPS_PER_REV / 2)
+    {
+        error -= STEPS_PER_REV;
+    }
+    else if (error < -STEPS_PER_REV / 2)
+    {
+        error += STEPS_PER_REV;
+    }
+
+    printf("simulated_hours: %d\n", hours);
+    printf("wall_time_end: %02d:%02d:%02d\n", wall.hour, wall.minute, wall.second);
+    printf("moves: %llu\n", (unsigned long long)sim_clock.moves);
+    printf("move_time_total_ms: %.3f\n", sim_clock.move_time_us / 1000.0);
+    printf("move_time_longest_ms: %.3f\n", sim_clock.longest_move_us / 1000.0);
+    printf("clock_task_wakeups: %llu\n", (unsigned long long)wakeups);
+    printf("catch_ups: %llu\n", (unsigned long long)sim_clock.catch_ups);
+    printf("catch_up_longest_ms: %.3f\n", sim_clock.catch_up_longest_us / 1000.0);
+    printf("catch_up_max_miss_steps: %d\n", (int)sim_clock.catch_up_max_miss);
+    if (sweep)
+    {
+        printf("sweep_starts: %llu\n", (unsigned long long)sim_clock.sweep_starts);
+        printf("sweep_max_locked_error_ms: %.3f\n", sim_clock.sweep_max_error_us / 1000.0);
+        printf("sweep_last_error_ms: %.3f\n", sim_clock.sweep.error_us / 1000.0);
+        printf("sweep_trim_ppm: %.3f\n", sim_clock.sweep.trim_ppb / 1000.0);
+    }
+    if (playback_rate)
+    {
+        printf("playback_moves: %u\n", (unsigned)stepper_get_playback_moves(motor_control));
+    }
+    pos_journal_stats_t journal_stats;
+    ESP_ERROR_CHECK(pos_journal_get_stats(sim_clock.journal, &journal_stats));
+    printf("journal_commits: %u\n", (unsigned)(sim_clock.journal_stats.commits + journal_stats.commits));
+    printf("journal_coalesced: %u\n", (unsigned)(sim_clock.journal_stats.coalesced + journal_stats.coalesced));
+    printf("nvs_writes: %u\n", (unsigned)sim_nvs_get_writes());
+    if (sim_clock.power_cuts)
+    {
+        printf("power_cuts: %llu\n", (unsigned long long)sim_clock.power_cuts);
+        printf("restore_lost_steps: %d\n", (int)sim_clock.restore_lost_steps);
+        printf("restore_mismatches: %d\n", sim_clock.restore_mismatches);
+        printf("boot_time_source: %s\n", time_source_name(sim_clock.boot_source));
+        printf("boot_to_trusted_ms: %.3f\n", sim_clock.boot_to_trusted_us / 1000.0);
+        printf("untrusted_wakeups: %llu\n", (unsigned long long)sim_clock.untrusted_wakeups);
+        printf("boot_catch_ups: %llu\n", (unsigned long long)(sim_clock.catch_ups - sim_clock.boot_catch_ups));
+    }
+    printf("binlog_entries: %llu\n", (unsigned long long)binlog.entries);
+    printf("binlog_dropped: %u\n", (unsigned)binlog_get_dropped());
+    uint64_t invalid_transitions = rec->invalid_transitions;
+    int mismatches = 0;
+    if (motors > 1)
+    {
+        // 跟随的电机应与主电机走出完全相同的位置与相位序列
+        for (int i = 0; i < sim_clock.follower_count; i++)
+        {
+            invalid_transitions += recs[i + 1].invalid_transitions;
+            if (stepper_get_position(sim_clock.followers[i]) != position ||
+                recs[i + 1].observed_position != rec->observed_position)
+            {
+                mismatches++;
+            }
+        }
+        printf("motors: %d\n", motors);
+        printf("follower_mismatches: %d\n", mismatches);
+    }
+    printf("steps_emitted: %llu\n", (unsigned long long)rec->steps);
+    // 驱动的遥测计数：输出的半步数（整步方式一步计两个）与环形缓冲的最高占用，断电重启后重新计数
+    printf("driver_half_steps: %u\n", (unsigned)stepper_get_emitted_steps(motor_control));
+    printf("queue_peak: %u\n", (unsigned)stepper_take_queue_peak(motor_control));
+    // 相邻两次相位写入不应比最高步频更密，闹钟晚到最多吃掉 isr_jitter 的余量；
+    // 晚了的电机若在同一次中断里补走错过的步，间隔会接近 0，转子跟不上而丢步
+    uint64_t step_floor_us = 60 * US_PER_S / ((uint64_t)stepper_max_rpm(motor_control) * STEPS_PER_REV);
+    step_floor_us = step_floor_us > isr_jitter_us ? step_floor_us - isr_jitter_us : 1;
+    int crowded_motors = 0;
+    for (int i = 0; i < motors; i++)
+    {
+        crowded_motors += recs[i].steps > 1 && recs[i].min_interval_us < step_floor_us;
+    }
+    printf("min_step_interval_us: %llu\n", (unsigned long long)(rec->steps > 1 ? rec->min_interval_us : 0));
+    printf("min_step_interval_floor_us: %llu\n", (unsigned long long)step_floor_us);
+    printf("crowded_motors: %d\n", crowded_motors);
+    printf("invalid_phase_transitions: %llu\n", (unsigned long long)invalid_transitions);
+    printf("phase_histogram:");
+    for (int i = 0; i < 8; i++)
+    {
+        printf(" 0x%X=%llu", s_phase_order[i], (unsigned long long)rec->phase_histogram[s_phase_order[i]]);
+    }
+    printf("\n");
+    printf("absolute_position: %d\n", position);
+    printf("observed_position: %lld\n", (long long)rec->observed_position);
+    printf("ideal_position: %.3f\n", ideal);
+    printf("position_error_steps: %.3f\n", error);
+    stepper_isr_stats_t isr_stats;
+    if (stepper_get_isr_stats(motor_control, &isr_stats) == ESP_OK)
+    {
+        printf("isr_count: %u\n", isr_stats.isr_count);
+        printf("isr_late_alarms: %u\n", isr_stats.late_alarms);
+        printf("isr_missed_alarms: %u\n", isr_stats.missed_alarms);
+        printf("isr_max_latency_us: %u\n", isr_stats.max_latency_us);
+        printf("isr_latency_histogram:");
+        for (int i = 0; i < STEPPER_ISR_HIST_BUCKETS; i++)
+        {
+            printf(" %u", isr_stats.latency_hist[i]);
+        }
+        printf("\n");
+    }
+    printf("cpu_ms_per_sim_hour:");
+    for (int i = 0; i < hour_index; i++)
+    {
+        printf(" %.3f", cpu_per_hour[i] * 1000.0);
+    }
+    printf("\n");
+
+    if (rec->trace)
+    {
+        fclose(rec->trace);
+    }
+    if (binlog.raw)
+    {
+        fclose(binlog.raw);
+    }
+    return invalid_transitions || mismatches || crowded_motors || sim_clock.restore_mismatches ? 1 : 0;
+}
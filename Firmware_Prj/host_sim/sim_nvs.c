@@ -0,0 +1,121 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <string.h>
+#include "nvs.h"
+#include "sim.h"
+
+// NVS 的内存替身：命名空间和键值在仿真的断电重启之间保留，相当于 flash；
+// 写入次数用来核对位置日志的合并效果
+
+#define SIM_NVS_MAX_NAMESPACES 4
+#define SIM_NVS_MAX_ENTRIES 32
+#define SIM_NVS_MAX_KEY 16
+#define SIM_NVS_MAX_BLOB 128
+
+typedef struct
+{
+    nvs_handle_t ns;
+    char key[SIM_NVS_MAX_KEY];
+    uint8_t data[SIM_NVS_MAX_BLOB];
+    size_t length;
+} sim_nvs_entry_t;
+
+static char s_namespaces[SIM_NVS_MAX_NAMESPACES][SIM_NVS_MAX_KEY];
+static sim_nvs_entry_t s_entries[SIM_NVS_MAX_ENTRIES];
+static size_t s_entry_count;
+static uint32_t s_writes;
+
+static sim_nvs_entry_t* sim_nvs_find(nvs_handle_t handle, const char* key)
+{
+    for (size_t i = 0; i < s_entry_count; i++)
+    {
+        if (s_entries[i].ns == handle && !strcmp(s_entries[i].key, key))
+        {
+            return &s_entries[i];
+        }
+    }
+    return NULL;
+}
+
+esp_err_t nvs_open(const char* name, nvs_open_mode_t open_mode, nvs_handle_t* out_handle)
+{
+    (void)open_mode;
+    if (!name || !out_handle || strlen(name) >= SIM_NVS_MAX_KEY)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (int i = 0; i < SIM_NVS_MAX_NAMESPACES; i++)
+    {
+        if (!s_namespaces[i][0])
+        {
+            strcpy(s_namespaces[i], name);
+        }
+        if (!strcmp(s_namespaces[i], name))
+        {
+            *out_handle = (nvs_handle_t)i + 1;
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NO_MEM;
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char* key, void* out_value, size_t* length)
+{
+    const sim_nvs_entry_t* entry = sim_nvs_find(handle, key);
+    if (!entry)
+    {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    if (out_value)
+    {
+        if (*length < entry->length)
+        {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        memcpy(out_value, entry->data, entry->length);
+    }
+    *length = entry->length;
+    return ESP_OK;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char* key, const void* value, size_t length)
+{
+    if (!key || strlen(key) >= SIM_NVS_MAX_KEY || length > SIM_NVS_MAX_BLOB)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    sim_nvs_entry_t* entry = sim_nvs_find(handle, key);
+    if (!entry)
+    {
+        if (s_entry_count >= SIM_NVS_MAX_ENTRIES)
+        {
+            return ESP_ERR_NO_MEM;
+        }
+        entry = &s_entries[s_entry_count++];
+        entry->ns = handle;
+        strcpy(entry->key, key);
+    }
+    memcpy(entry->data, value, length);
+    entry->length = length;
+    s_writes++;
+    return ESP_OK;
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle)
+{
+    (void)handle;
+    return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t handle)
+{
+    (void)handle;
+}
+
+uint32_t sim_nvs_get_writes(void)
+{
+    return s_writes;
+}
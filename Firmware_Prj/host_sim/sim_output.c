@@ -0,0 +1,160 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdlib.h>
+#include "driver/gptimer.h"
+#include "esp_attr.h"
+#include "sim.h"
+
+// 仿真输出后端：逐步写入直接交给相位观察者；回放用一个自己的虚拟 gptimer 按波形逐项输出，
+// 相当于 RMT 的硬件计时，不经过步进中断，也不计入其统计
+
+typedef struct
+{
+    step_output_t base;
+    int motor;                     // 观察者看到的电机序号，同一电机的两个后端相同
+    gptimer_handle_t timer;        // 回放计时，没有回放能力时为 NULL
+    const step_wave_item_t* wave;
+    size_t count;
+    size_t pos;
+    bool playing;
+    step_output_done_cb_t done_cb;
+    void* done_arg;
+} sim_output_t;
+
+static sim_phase_observer_t s_phase_observer;
+static void* s_phase_observer_ctx;
+
+static void sim_output_apply(sim_output_t* sim, uint32_t phase)
+{
+    if (s_phase_observer)
+    {
+        s_phase_observer(sim_now_us(), sim->motor, phase & STEP_OUTPUT_COIL_MASK, s_phase_observer_ctx);
+    }
+}
+
+static void sim_output_write(step_output_t* output, uint32_t phase)
+{
+    sim_output_apply(__containerof(output, sim_output_t, base), phase);
+}
+
+static void sim_output_halt(sim_output_t* sim)
+{
+    sim->playing = false;
+    gptimer_stop(sim->timer);
+    gptimer_disable(sim->timer);
+}
+
+static bool sim_output_on_alarm(gptimer_handle_t timer, const gptimer_alarm_event_data_t* edata, void* user_data)
+{
+    sim_output_t* sim = user_data;
+    if (!sim->playing)
+    {
+        return false;
+    }
+    if (++sim->pos < sim->count)
+    {
+        sim_output_apply(sim, sim->wave[sim->pos].phase);
+        gptimer_alarm_config_t alarm_config = {
+            .alarm_count = edata->alarm_value + sim->wave[sim->pos].duration_us,
+        };
+        gptimer_set_alarm_action(timer, &alarm_config);
+        return false;
+    }
+    sim_output_halt(sim);
+    return sim->done_cb ? sim->done_cb(&sim->base, sim->done_arg) : false;
+}
+
+static esp_err_t sim_output_play(step_output_t* output, const step_wave_item_t* wave, size_t count,
+                                 step_output_done_cb_t done_cb, void* arg)
+{
+    sim_output_t* sim = __containerof(output, sim_output_t, base);
+    if (!wave || !count || count > output->max_items)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (sim->playing)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    sim->wave = wave;
+    sim->count = count;
+    sim->pos = 0;
+    sim->done_cb = done_cb;
+    sim->done_arg = arg;
+    sim->playing = true;
+    sim_output_apply(sim, wave[0].phase);
+
+    gptimer_alarm_config_t alarm_config = {
+        .alarm_count = wave[0].duration_us,
+    };
+    gptimer_enable(sim->timer);
+    gptimer_set_raw_count(sim->timer, 0);
+    gptimer_set_alarm_action(sim->timer, &alarm_config);
+    gptimer_start(sim->timer);
+    return ESP_OK;
+}
+
+static esp_err_t sim_output_stop(step_output_t* output)
+{
+    sim_output_t* sim = __containerof(output, sim_output_t, base);
+    if (sim->playing)
+    {
+        sim_output_halt(sim);
+        sim_output_apply(sim, 0);
+    }
+    return ESP_OK;
+}
+
+static esp_err_t sim_output_del(step_output_t* output)
+{
+    sim_output_t* sim = __containerof(output, sim_output_t, base);
+    if (sim->timer)
+    {
+        sim_output_stop(output);
+        gptimer_del_timer(sim->timer);
+    }
+    free(sim);
+    return ESP_OK;
+}
+
+esp_err_t sim_new_step_output(int motor, size_t max_items, step_output_t** ret_output)
+{
+    sim_output_t* sim = calloc(1, sizeof(sim_output_t));
+    if (!sim || !ret_output)
+    {
+        free(sim);
+        return ESP_ERR_INVALID_ARG;
+    }
+    sim->motor = motor;
+    sim->base.write = sim_output_write;
+    sim->base.stop = sim_output_stop;
+    sim->base.del = sim_output_del;
+    if (max_items)
+    {
+        gptimer_config_t timer_config = {
+            .resolution_hz = 1000000,
+        };
+        gptimer_event_callbacks_t cbs = {
+            .on_alarm = sim_output_on_alarm,
+        };
+        if (gptimer_new_timer(&timer_config, &sim->timer) != ESP_OK)
+        {
+            free(sim);
+            return ESP_ERR_NOT_FOUND;
+        }
+        gptimer_register_event_callbacks(sim->timer, &cbs, sim);
+        sim->base.play = sim_output_play;
+        sim->base.max_items = max_items;
+    }
+    *ret_output = &sim->base;
+    return ESP_OK;
+}
+
+void sim_set_phase_observer(sim_phase_observer_t observer, void* ctx)
+{
+    s_phase_observer = observer;
+    s_phase_observer_ctx = ctx;
+}
@@ -0,0 +1,418 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "driver/dedic_gpio.h"
+#include "driver/gpio.h"
+#include "driver/gptimer.h"
+#include "esp_timer.h"
+#include "sim.h"
+
+// gptimer、esp_timer、专用 GPIO 束与普通 GPIO 的虚拟时间替身，计数分辨率固定为 1us；
+// 相位输出由 sim_output.c 的仿真后端观察，专用 GPIO 束只保存写入的值
+
+#define SIM_MAX_TIMERS 20  // 电机组一个，每个回放输出一个，每个 esp_timer 一个
+
+struct sim_gptimer
+{
+    bool enabled;
+    bool running;
+    bool alarm_armed;
+    uint64_t count_base;   // 上次启动或改写计数时的计数值
+    uint64_t start_us;     // 上次启动时的虚拟时间
+    gptimer_alarm_config_t alarm;
+    uint32_t alarm_delay_us; // 注入的中断响应延迟
+    gptimer_alarm_cb_t on_alarm;
+    void* user_data;
+};
+
+// esp_timer 借用一个 gptimer 计时，到期回调在仿真的定时器事件里直接运行
+struct sim_esp_timer
+{
+    gptimer_handle_t timer;
+    bool armed;
+    esp_timer_cb_t callback;
+    void* arg;
+};
+
+struct sim_dedic_bundle
+{
+    size_t width;
+    uint32_t value;
+};
+
+static struct sim_gptimer* s_timers[SIM_MAX_TIMERS];
+static uint32_t s_alarm_jitter_us;
+static uint32_t s_jitter_seed = 1;
+static int32_t s_timer_ppm;
+static sim_alarm_observer_t s_alarm_observer;
+static void* s_alarm_observer_ctx;
+
+static bool sim_esp_timer_on_alarm(gptimer_handle_t timer, const gptimer_alarm_event_data_t* edata,
+                                   void* user_data);
+
+/* 计数按注入的晶振误差快慢，与墙上时间之间的偏差由扫动的锁相环吸收 */
+static uint64_t sim_gptimer_elapsed(uint64_t us)
+{
+    return us + (uint64_t)((int64_t)us * s_timer_ppm / 1000000);
+}
+
+static uint64_t sim_gptimer_count(const struct sim_gptimer* timer, uint64_t now_us)
+{
+    return timer->running ? timer->count_base + sim_gptimer_elapsed(now_us - timer->start_us) : timer->count_base;
+}
+
+/* 计数达到 count 的最早虚拟时间 */
+static uint64_t sim_gptimer_when(const struct sim_gptimer* timer, uint64_t count, uint64_t now_us)
+{
+    uint64_t current = sim_gptimer_count(timer, now_us);
+    if (count <= current)
+    {
+        return now_us;
+    }
+    uint64_t when = now_us + (count - current) * 1000000 / (uint64_t)(1000000 + s_timer_ppm);
+    while (sim_gptimer_count(timer, when) < count)
+    {
+        when++;
+    }
+    return when;
+}
+
+esp_err_t gptimer_new_timer(const gptimer_config_t* config, gptimer_handle_t* ret_timer)
+{
+    if (!config || !ret_timer || config->resolution_hz != 1000000)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (int i = 0; i < SIM_MAX_TIMERS; i++)
+    {
+        if (!s_timers[i])
+        {
+            s_timers[i] = calloc(1, sizeof(struct sim_gptimer));
+            *ret_timer = s_timers[i];
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t gptimer_del_timer(gptimer_handle_t timer)
+{
+    for (int i = 0; i < SIM_MAX_TIMERS; i++)
+    {
+        if (s_timers[i] == timer)
+        {
+            s_timers[i] = NULL;
+        }
+    }
+    free(timer);
+    return ESP_OK;
+}
+
+esp_err_t gptimer_set_raw_count(gptimer_handle_t timer, uint64_t value)
+{
+    timer->count_base = value;
+    timer->start_us = sim_now_us();
+    return ESP_OK;
+}
+
+esp_err_t gptimer_get_raw_count(gptimer_handle_t timer, uint64_t* value)
+{
+    *value = sim_gptimer_count(timer, sim_now_us());
+    return ESP_OK;
+}
+
+esp_err_t gptimer_register_event_callbacks(gptimer_handle_t timer, const gptimer_event_callbacks_t* cbs,
+                                           void* user_data)
+{
+    if (timer->enabled)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->on_alarm = cbs->on_alarm;
+    timer->user_data = user_data;
+    return ESP_OK;
+}
+
+/* 固定种子的伪随机延迟，保证每次仿真结果可重复 */
+static uint32_t sim_next_jitter(void)
+{
+    if (!s_alarm_jitter_us)
+    {
+        return 0;
+    }
+    s_jitter_seed = s_jitter_seed * 1103515245u + 12345u;
+    return (s_jitter_seed >> 16) % (s_alarm_jitter_us + 1);
+}
+
+esp_err_t gptimer_set_alarm_action(gptimer_handle_t timer, const gptimer_alarm_config_t* config)
+{
+    if (config)
+    {
+        timer->alarm = *config;
+        timer->alarm_armed = true;
+        timer->alarm_delay_us = sim_next_jitter();
+    }
+    else
+    {
+        timer->alarm_armed = false;
+    }
+    return ESP_OK;
+}
+
+esp_err_t gptimer_enable(gptimer_handle_t timer)
+{
+    if (timer->enabled)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->enabled = true;
+    return ESP_OK;
+}
+
+esp_err_t gptimer_disable(gptimer_handle_t timer)
+{
+    if (!timer->enabled || timer->running)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->enabled = false;
+    return ESP_OK;
+}
+
+esp_err_t gptimer_start(gptimer_handle_t timer)
+{
+    if (!timer->enabled)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!timer->running)
+    {
+        timer->start_us = sim_now_us();
+        timer->running = true;
+    }
+    return ESP_OK;
+}
+
+esp_err_t gptimer_stop(gptimer_handle_t timer)
+{
+    if (timer->running)
+    {
+        timer->count_base = sim_gptimer_count(timer, sim_now_us());
+        timer->running = false;
+    }
+    return ESP_OK;
+}
+
+bool sim_timers_next_event(uint64_t* when_us)
+{
+    bool found = false;
+    uint64_t now = sim_now_us();
+    for (int i = 0; i < SIM_MAX_TIMERS; i++)
+    {
+        struct sim_gptimer* timer = s_timers[i];
+        if (!timer || !timer->running || !timer->alarm_armed)
+        {
+            continue;
+        }
+        // 闹钟值已经过去时硬件会立即触发
+        uint64_t when = sim_gptimer_when(timer, timer->alarm.alarm_count, now) + timer->alarm_delay_us;
+        if (!found || when < *when_us)
+        {
+            *when_us = when;
+            found = true;
+        }
+    }
+    return found;
+}
+
+void sim_timers_fire(uint64_t now_us)
+{
+    for (int i = 0; i < SIM_MAX_TIMERS; i++)
+    {
+        struct sim_gptimer* timer = s_timers[i];
+        if (!timer || !timer->running || !timer->alarm_armed ||
+            sim_gptimer_when(timer, timer->alarm.alarm_count, timer->start_us) + timer->alarm_delay_us > now_us)
+        {
+            continue;
+        }
+        gptimer_alarm_event_data_t edata = {
+            .count_value = sim_gptimer_count(timer, now_us),
+            .alarm_value = timer->alarm.alarm_count,
+        };
+        if (timer->alarm.flags.auto_reload_on_alarm)
+        {
+            timer->count_base = timer->alarm.reload_count;
+            timer->start_us = now_us;
+        }
+        else
+        {
+            // 非自动重装时闹钟触发一次后关闭，需要回调重新设置
+            timer->alarm_armed = false;
+        }
+        if (timer->on_alarm)
+        {
+            bool observed = s_alarm_observer && timer->on_alarm != sim_esp_timer_on_alarm;
+            struct timespec start;
+            struct timespec end;
+            if (observed)
+            {
+                clock_gettime(CLOCK_MONOTONIC, &start);
+            }
+            TaskHandle_t previous = sim_set_current_task(NULL);
+            timer->on_alarm(timer, &edata, timer->user_data);
+            sim_set_current_task(previous);
+            if (observed)
+            {
+                clock_gettime(CLOCK_MONOTONIC, &end);
+                s_alarm_observer((uint64_t)((end.tv_sec - start.tv_sec) * 1000000000LL + end.tv_nsec - start.tv_nsec),
+                                 s_alarm_observer_ctx);
+            }
+        }
+    }
+}
+
+static bool sim_esp_timer_on_alarm(gptimer_handle_t timer, const gptimer_alarm_event_data_t* edata,
+                                   void* user_data)
+{
+    struct sim_esp_timer* esp_timer = user_data;
+    esp_timer_stop(esp_timer);
+    esp_timer->callback(esp_timer->arg);
+    return false;
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* create_args, esp_timer_handle_t* out_handle)
+{
+    if (!create_args || !create_args->callback || !out_handle)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    struct sim_esp_timer* esp_timer = calloc(1, sizeof(struct sim_esp_timer));
+    gptimer_config_t timer_config = {
+        .resolution_hz = 1000000,
+    };
+    if (gptimer_new_timer(&timer_config, &esp_timer->timer) != ESP_OK)
+    {
+        free(esp_timer);
+        return ESP_ERR_NO_MEM;
+    }
+    gptimer_event_callbacks_t cbs = {
+        .on_alarm = sim_esp_timer_on_alarm,
+    };
+    gptimer_register_event_callbacks(esp_timer->timer, &cbs, esp_timer);
+    esp_timer->callback = create_args->callback;
+    esp_timer->arg = create_args->arg;
+    *out_handle = esp_timer;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t esp_timer, uint64_t timeout_us)
+{
+    if (esp_timer->armed)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    gptimer_alarm_config_t alarm_config = {
+        .alarm_count = timeout_us,
+    };
+    gptimer_enable(esp_timer->timer);
+    gptimer_set_raw_count(esp_timer->timer, 0);
+    gptimer_set_alarm_action(esp_timer->timer, &alarm_config);
+    gptimer_start(esp_timer->timer);
+    esp_timer->armed = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t esp_timer)
+{
+    if (!esp_timer->armed)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    gptimer_stop(esp_timer->timer);
+    gptimer_disable(esp_timer->timer);
+    esp_timer->armed = false;
+    return ESP_OK;
+}
+
+/* 断电：所有 esp_timer 停下，还没到期的回调随内存一起丢失 */
+void sim_esp_timers_power_off(void)
+{
+    for (int i = 0; i < SIM_MAX_TIMERS; i++)
+    {
+        if (s_timers[i] && s_timers[i]->on_alarm == sim_esp_timer_on_alarm)
+        {
+            struct sim_esp_timer* esp_timer = s_timers[i]->user_data;
+            if (esp_timer->armed)
+            {
+                esp_timer_stop(esp_timer);
+            }
+        }
+    }
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t esp_timer)
+{
+    if (esp_timer->armed)
+    {
+        esp_timer_stop(esp_timer);
+    }
+    gptimer_del_timer(esp_timer->timer);
+    free(esp_timer);
+    return ESP_OK;
+}
+
+esp_err_t dedic_gpio_new_bundle(const dedic_gpio_bundle_config_t* config, dedic_gpio_bundle_handle_t* ret_bundle)
+{
+    if (!config || !ret_bundle || !config->array_size || config->array_size > 8)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    struct sim_dedic_bundle* bundle = calloc(1, sizeof(struct sim_dedic_bundle));
+    bundle->width = config->array_size;
+    *ret_bundle = bundle;
+    return ESP_OK;
+}
+
+esp_err_t dedic_gpio_del_bundle(dedic_gpio_bundle_handle_t bundle)
+{
+    free(bundle);
+    return ESP_OK;
+}
+
+void dedic_gpio_bundle_write(dedic_gpio_bundle_handle_t bundle, uint32_t mask, uint32_t value)
+{
+    uint32_t width_mask = (1u << bundle->width) - 1;
+    mask &= width_mask;
+    bundle->value = (bundle->value & ~mask) | (value & mask);
+}
+
+void sim_set_alarm_jitter(uint32_t max_us)
+{
+    s_alarm_jitter_us = max_us;
+}
+
+void sim_set_timer_ppm(int32_t ppm)
+{
+    s_timer_ppm = ppm;
+}
+
+void sim_set_alarm_observer(sim_alarm_observer_t observer, void* ctx)
+{
+    s_alarm_observer = observer;
+    s_alarm_observer_ctx = ctx;
+}
+
+esp_err_t gpio_config(const gpio_config_t* config)
+{
+    return config ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t gpio_sleep_sel_dis(gpio_num_t gpio_num)
+{
+    return gpio_num >= 0 ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
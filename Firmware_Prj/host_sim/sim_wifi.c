@@ -0,0 +1,338 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <string.h>
+#include "esp_event.h"
+#include "esp_netif.h"
+#include "esp_smartconfig.h"
+#include "esp_sntp.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+#include "sim.h"
+
+// esp_wifi、默认事件循环、esp_netif 与 SNTP 的虚拟时间替身。驱动按一个模拟 AP 走完
+// 扫描、关联和 DHCP，耗时取典型值：只扫一个信道远快于全信道扫描。事件同步分发，
+// 处理函数里推进的虚拟时间即事件循环被阻塞的时间
+
+#define SIM_WIFI_CHANNELS 13
+#define SIM_WIFI_SCAN_CHANNEL_US 120000  // 主动扫描每个信道的驻留时间
+#define SIM_WIFI_ASSOC_US 80000          // 认证、关联和四次握手
+#define SIM_WIFI_DHCP_US 300000
+#define SIM_SNTP_FIRST_SYNC_US 700000    // 获取 IP 后第一次 SNTP 应答
+#define SIM_SNTP_RETRY_US 15000000
+#define SIM_EVENT_MAX_HANDLERS 8
+
+ESP_EVENT_DEFINE_BASE(WIFI_EVENT);
+ESP_EVENT_DEFINE_BASE(IP_EVENT);
+ESP_EVENT_DEFINE_BASE(SC_EVENT);
+
+typedef enum
+{
+    SIM_WIFI_IDLE,
+    SIM_WIFI_SCANNING,
+    SIM_WIFI_ASSOCIATING,
+    SIM_WIFI_DHCP,
+    SIM_WIFI_GOT_IP,
+} sim_wifi_state_t;
+
+typedef struct
+{
+    esp_event_base_t base;
+    int32_t id;
+    esp_event_handler_t handler;
+    void* arg;
+} sim_event_handler_t;
+
+struct sim_netif
+{
+    int dummy;
+};
+
+static sim_event_handler_t s_handlers[SIM_EVENT_MAX_HANDLERS];
+static int s_handler_count;
+
+static sim_wifi_state_t s_state;
+static wifi_config_t s_sta_config;
+static esp_timer_handle_t s_op_timer;   // 扫描、关联和 DHCP 的完成时刻
+static bool s_ap_up = true;
+static uint8_t s_ap_bssid[6] = {0x24, 0x0a, 0xc4, 0x12, 0x34, 0x56};
+static uint8_t s_ap_channel = 6;
+static sim_wifi_stats_t s_stats;
+
+static esp_timer_handle_t s_sntp_timer;
+static sntp_sync_time_cb_t s_sntp_cb;
+
+esp_err_t esp_event_loop_create_default(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_event_handler_register(esp_event_base_t event_base, int32_t event_id,
+                                     esp_event_handler_t event_handler, void* event_handler_arg)
+{
+    if (s_handler_count >= SIM_EVENT_MAX_HANDLERS)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    s_handlers[s_handler_count++] = (sim_event_handler_t){
+        .base = event_base,
+        .id = event_id,
+        .handler = event_handler,
+        .arg = event_handler_arg,
+    };
+    return ESP_OK;
+}
+
+esp_err_t esp_event_post(esp_event_base_t event_base, int32_t event_id, const void* event_data,
+                         size_t event_data_size, TickType_t ticks_to_wait)
+{
+    (void)event_data_size;
+    (void)ticks_to_wait;
+    s_stats.events++;
+    for (int i = 0; i < s_handler_count; i++)
+    {
+        const sim_event_handler_t* entry = &s_handlers[i];
+        if (entry->base != event_base || (entry->id != ESP_EVENT_ANY_ID && entry->id != event_id))
+        {
+            continue;
+        }
+        uint64_t start = sim_now_us();
+        entry->handler(entry->arg, event_base, event_id, (void*)event_data);
+        uint64_t blocked = sim_now_us() - start;
+        if (blocked > s_stats.handler_max_block_us)
+        {
+            s_stats.handler_max_block_us = blocked;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_netif_init(void)
+{
+    return ESP_OK;
+}
+
+esp_netif_t* esp_netif_create_default_wifi_sta(void)
+{
+    static esp_netif_t netif;
+    return &netif;
+}
+
+static void sim_wifi_disconnected(uint8_t reason)
+{
+    s_state = SIM_WIFI_IDLE;
+    wifi_event_sta_disconnected_t evt = {.reason = reason};
+    memcpy(evt.bssid, s_ap_bssid, sizeof(evt.bssid));
+    esp_event_post(WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, &evt, sizeof(evt), 0);
+}
+
+/* 扫描结束时 AP 是否能被找到：锁定信道或 BSSID 时必须与 AP 当前的一致 */
+static bool sim_wifi_ap_found(void)
+{
+    if (!s_ap_up)
+    {
+        return false;
+    }
+    if (s_sta_config.sta.channel && s_sta_config.sta.channel != s_ap_channel)
+    {
+        return false;
+    }
+    return !s_sta_config.sta.bssid_set || !memcmp(s_sta_config.sta.bssid, s_ap_bssid, sizeof(s_ap_bssid));
+}
+
+static void sim_wifi_op_done(void* arg)
+{
+    switch (s_state)
+    {
+    case SIM_WIFI_SCANNING:
+        if (!sim_wifi_ap_found())
+        {
+            sim_wifi_disconnected(WIFI_REASON_NO_AP_FOUND);
+            return;
+        }
+        s_state = SIM_WIFI_ASSOCIATING;
+        esp_timer_start_once(s_op_timer, SIM_WIFI_ASSOC_US);
+        break;
+    case SIM_WIFI_ASSOCIATING:
+    {
+        s_state = SIM_WIFI_DHCP;
+        wifi_event_sta_connected_t evt = {.channel = s_ap_channel};
+        memcpy(evt.bssid, s_ap_bssid, sizeof(evt.bssid));
+        esp_timer_start_once(s_op_timer, SIM_WIFI_DHCP_US);
+        esp_event_post(WIFI_EVENT, WIFI_EVENT_STA_CONNECTED, &evt, sizeof(evt), 0);
+        break;
+    }
+    case SIM_WIFI_DHCP:
+        s_state = SIM_WIFI_GOT_IP;
+        esp_event_post(IP_EVENT, IP_EVENT_STA_GOT_IP, NULL, 0, 0);
+        break;
+    default:
+        break;
+    }
+}
+
+esp_err_t esp_wifi_init(const wifi_init_config_t* config)
+{
+    (void)config;
+    const esp_timer_create_args_t args = {
+        .callback = sim_wifi_op_done,
+        .name = "sim_wifi",
+    };
+    return esp_timer_create(&args, &s_op_timer);
+}
+
+esp_err_t esp_wifi_set_mode(wifi_mode_t mode)
+{
+    return mode == WIFI_MODE_STA ? ESP_OK : ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t esp_wifi_set_config(wifi_interface_t interface, wifi_config_t* conf)
+{
+    if (interface != WIFI_IF_STA || !conf)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_sta_config = *conf;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_start(void)
+{
+    esp_event_post(WIFI_EVENT, WIFI_EVENT_STA_START, NULL, 0, 0);
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_connect(void)
+{
+    if (s_state != SIM_WIFI_IDLE)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    // 指定信道时只扫这一个信道，否则逐个扫完所有信道再按信号强度选 AP
+    bool one_channel = s_sta_config.sta.channel != 0;
+    s_stats.connects++;
+    if (one_channel)
+    {
+        s_stats.channel_scans++;
+    }
+    s_state = SIM_WIFI_SCANNING;
+    esp_timer_start_once(s_op_timer, SIM_WIFI_SCAN_CHANNEL_US * (one_channel ? 1 : SIM_WIFI_CHANNELS));
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_disconnect(void)
+{
+    if (s_state == SIM_WIFI_IDLE)
+    {
+        return ESP_OK;
+    }
+    esp_timer_stop(s_op_timer);
+    sim_wifi_disconnected(WIFI_REASON_ASSOC_LEAVE);
+    return ESP_OK;
+}
+
+esp_err_t esp_smartconfig_set_type(smartconfig_type_t type)
+{
+    (void)type;
+    return ESP_OK;
+}
+
+esp_err_t esp_smartconfig_start(const smartconfig_start_config_t* config)
+{
+    (void)config;
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t esp_smartconfig_stop(void)
+{
+    return ESP_OK;
+}
+
+static void sim_sntp_poll(void* arg)
+{
+    if (s_state != SIM_WIFI_GOT_IP)
+    {
+        esp_timer_start_once(s_sntp_timer, SIM_SNTP_RETRY_US);
+        return;
+    }
+    s_stats.sntp_syncs++;
+    if (s_sntp_cb)
+    {
+        struct timeval tv = {
+            .tv_sec = (time_t)(sim_now_us() / 1000000),
+            .tv_usec = (suseconds_t)(sim_now_us() % 1000000),
+        };
+        s_sntp_cb(&tv);
+    }
+}
+
+void esp_sntp_setoperatingmode(sntp_operatingmode_t operating_mode)
+{
+    (void)operating_mode;
+}
+
+void sntp_set_sync_mode(sntp_sync_mode_t sync_mode)
+{
+    (void)sync_mode;
+}
+
+void sntp_set_time_sync_notification_cb(sntp_sync_time_cb_t callback)
+{
+    s_sntp_cb = callback;
+}
+
+void esp_sntp_setservername(unsigned char idx, const char* server)
+{
+    (void)idx;
+    (void)server;
+}
+
+void esp_sntp_init(void)
+{
+    const esp_timer_create_args_t args = {
+        .callback = sim_sntp_poll,
+        .name = "sim_sntp",
+    };
+    if (!s_sntp_timer && esp_timer_create(&args, &s_sntp_timer) == ESP_OK)
+    {
+        esp_timer_start_once(s_sntp_timer, SIM_SNTP_FIRST_SYNC_US);
+    }
+}
+
+/* AP 消失、换信道或换 BSSID 时已关联的站点收不到信标而断开 */
+void sim_wifi_set_ap(bool up, const uint8_t bssid[6], uint8_t channel)
+{
+    bool moved = channel != s_ap_channel || (bssid && memcmp(bssid, s_ap_bssid, sizeof(s_ap_bssid)));
+    bool was_up = s_ap_up;
+    s_ap_up = up;
+    s_ap_channel = channel;
+    if (bssid)
+    {
+        memcpy(s_ap_bssid, bssid, sizeof(s_ap_bssid));
+    }
+    if ((was_up && !up) || moved)
+    {
+        sim_wifi_drop();
+    }
+}
+
+void sim_wifi_drop(void)
+{
+    if (s_state == SIM_WIFI_DHCP || s_state == SIM_WIFI_GOT_IP)
+    {
+        esp_timer_stop(s_op_timer);
+        sim_wifi_disconnected(WIFI_REASON_BEACON_TIMEOUT);
+    }
+}
+
+bool sim_wifi_has_ip(void)
+{
+    return s_state == SIM_WIFI_GOT_IP;
+}
+
+void sim_wifi_get_stats(sim_wifi_stats_t* stats)
+{
+    *stats = s_stats;
+}
@@ -0,0 +1,216 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdbool.h>
+#include <stdio.h>
+#include "step_profile.h"
+
+// 加速表与运动曲线的性质检查，两种曲线形状、半步与整步各跑一遍，任何一项不满足时返回非零：
+// 步进间隔先不增后不减，且在巡航间隔与起步频率之间；加速段与减速段对称；
+// 放不下完整加减速的短运动是三角形，没有巡航段；step_profile_duration_us 等于逐步间隔之和；
+// 整步运动加速时每一步的速度与半步运动走到同一位置时相同，角加速度不因驱动方式减半
+
+#define MAX_MOVE_STEPS 4096
+
+typedef struct
+{
+    uint32_t start_rate;
+    uint32_t max_rate;
+    uint32_t accel;
+} ramp_rates_t;
+
+// 第一组与 stepper_driver_new 的加速表相同，第三组的加速表超过 STEP_RAMP_MAX_LEN 被截断
+static const ramp_rates_t s_rates[] = {
+    {.start_rate = 600, .max_rate = 2400, .accel = 6000},
+    {.start_rate = 100, .max_rate = 1000, .accel = 2000},
+    {.start_rate = 16, .max_rate = 5000, .accel = 10000},
+};
+
+static const uint32_t s_steps[] = {1, 2, 3, 4, 7, 12, 40, 85, 200, 512, 1000, 2048, MAX_MOVE_STEPS};
+
+static uint32_t s_intervals[MAX_MOVE_STEPS];
+static uint16_t s_levels[MAX_MOVE_STEPS];
+static uint32_t s_half_intervals[MAX_MOVE_STEPS];
+static uint16_t s_half_levels[MAX_MOVE_STEPS];
+
+static const char* shape_name(step_ramp_shape_t shape)
+{
+    return shape == STEP_RAMP_SHAPE_S_CURVE ? "s_curve" : "trapezoidal";
+}
+
+/* 与 step_profile_duration_us 和步进中断相同，从第 0 级起步，每一步先取间隔再升降级别 */
+static uint64_t walk_move(const step_ramp_t* ramp, const step_profile_t* profile)
+{
+    uint64_t sum = 0;
+    uint16_t level = 0;
+    for (uint32_t executed = 1; executed <= profile->total_steps; executed++)
+    {
+        s_levels[executed - 1] = level;
+        s_intervals[executed - 1] = step_profile_interval(ramp, profile, level);
+        sum += s_intervals[executed - 1];
+        level = step_ramp_next_level(level, profile->total_steps - executed, profile->cruise_level,
+                                     profile->exit_level);
+    }
+    return sum;
+}
+
+/* cruise_us 是每个加速表步（半步）的间隔，shift 为 1 时每步走两个半步 */
+static int check_move(const step_ramp_t* ramp, uint32_t steps, uint32_t cruise_us, uint8_t shift)
+{
+    step_profile_t profile;
+    step_profile_init(ramp, steps, cruise_us, shift, &profile);
+    uint64_t sum = walk_move(ramp, &profile);
+    int failures = 0;
+    const char* shape = shape_name(ramp->config.shape);
+
+    // 间隔的上下界：不快于巡航间隔和最高频率，不慢于起步频率，整步时按每步的半步数缩放
+    uint32_t fastest = 1000000 / ramp->config.max_rate;
+    uint32_t slowest = (1000000 + ramp->config.start_rate - 1) / ramp->config.start_rate;
+    fastest = (cruise_us > fastest ? cruise_us : fastest) << shift;
+    slowest = (cruise_us > slowest ? cruise_us : slowest) << shift;
+
+    // 先不增后不减：一旦开始变长就不能再变短
+    bool slowing = false;
+    uint16_t peak = 0;
+    uint32_t peak_steps = 0;
+    for (uint32_t i = 0; i < steps; i++)
+    {
+        if (s_intervals[i] < fastest || s_intervals[i] > slowest)
+        {
+            printf("FAIL %s %u steps @ %u us: interval %u at step %u outside [%u, %u]\n", shape, (unsigned)steps,
+                   (unsigned)cruise_us, (unsigned)s_intervals[i], (unsigned)i, (unsigned)fastest,
+                   (unsigned)slowest);
+            failures++;
+            break;
+        }
+        if (i && s_intervals[i] > s_intervals[i - 1])
+        {
+            slowing = true;
+        }
+        else if (i && s_intervals[i] < s_intervals[i - 1] && slowing)
+        {
+            printf("FAIL %s %u steps @ %u us: interval shrinks again at step %u\n", shape, (unsigned)steps,
+                   (unsigned)cruise_us, (unsigned)i);
+            failures++;
+            break;
+        }
+        if (s_levels[i] > peak)
+        {
+            peak = s_levels[i];
+            peak_steps = 0;
+        }
+        peak_steps += s_levels[i] == peak;
+    }
+
+    // 对称：第 i 步与倒数第 i 步的级别相同，第一步和最后一步都在起步级别
+    for (uint32_t i = 0; i < steps; i++)
+    {
+        uint16_t mirrored = s_levels[steps - 1 - i];
+        if (s_levels[i] != mirrored)
+        {
+            printf("FAIL %s %u steps @ %u us: level %u at step %u, %u at the mirrored step\n", shape,
+                   (unsigned)steps, (unsigned)cruise_us, s_levels[i], (unsigned)i, mirrored);
+            failures++;
+            break;
+        }
+    }
+
+    // 短运动：到不了巡航级别，峰值只停留一步或两步
+    if (steps < 2 * (uint32_t)profile.cruise_level && (peak >= profile.cruise_level || peak_steps > 2))
+    {
+        printf("FAIL %s %u steps @ %u us: peak level %u for %u steps, expected a triangle below %u\n", shape,
+               (unsigned)steps, (unsigned)cruise_us, peak, (unsigned)peak_steps, profile.cruise_level);
+        failures++;
+    }
+
+    uint64_t duration = step_profile_duration_us(ramp, &profile, 0);
+    if (duration != sum)
+    {
+        printf("FAIL %s %u steps @ %u us: duration %llu us, intervals sum to %llu us\n", shape, (unsigned)steps,
+               (unsigned)cruise_us, (unsigned long long)duration, (unsigned long long)sum);
+        failures++;
+    }
+    return failures;
+}
+
+/* 整步运动加速时的第 i 步与同样距离的半步运动的第 (i << shift) 步速度相同，
+ * 半步运动在那一步的级别正好是 (i << shift)；整步运动开始巡航或减速后不再比较 */
+static int check_stride(const step_ramp_t* ramp, uint32_t steps, uint32_t cruise_us, uint8_t shift)
+{
+    uint32_t half_steps = steps << shift;
+    if (half_steps > MAX_MOVE_STEPS)
+    {
+        return 0;
+    }
+    step_profile_t half;
+    step_profile_init(ramp, half_steps, cruise_us, 0, &half);
+    walk_move(ramp, &half);
+    for (uint32_t i = 0; i < half_steps; i++)
+    {
+        s_half_intervals[i] = s_intervals[i];
+        s_half_levels[i] = s_levels[i];
+    }
+    step_profile_t full;
+    step_profile_init(ramp, steps, cruise_us, shift, &full);
+    walk_move(ramp, &full);
+
+    for (uint32_t i = 0; i < steps && s_levels[i] == i && s_levels[i] < full.cruise_level; i++)
+    {
+        uint32_t expected = s_half_intervals[i << shift] << shift;
+        if (s_half_levels[i << shift] != i << shift || s_intervals[i] != expected)
+        {
+            printf("FAIL %s %u steps << %u @ %u us: interval %u at step %u, half step move has %u at level %u\n",
+                   shape_name(ramp->config.shape), (unsigned)steps, (unsigned)shift, (unsigned)cruise_us,
+                   (unsigned)s_intervals[i], (unsigned)i, (unsigned)expected, s_half_levels[i << shift]);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main(void)
+{
+    static const step_ramp_shape_t shapes[] = {STEP_RAMP_SHAPE_TRAPEZOIDAL, STEP_RAMP_SHAPE_S_CURVE};
+    static step_ramp_t ramp;
+    int failures = 0;
+    for (size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); s++)
+    {
+        for (size_t r = 0; r < sizeof(s_rates) / sizeof(s_rates[0]); r++)
+        {
+            const step_ramp_config_t config = {
+                .start_rate = s_rates[r].start_rate,
+                .max_rate = s_rates[r].max_rate,
+                .accel = s_rates[r].accel,
+                .shape = shapes[s],
+            };
+            if (step_ramp_build(&ramp, &config) != ESP_OK)
+            {
+                printf("FAIL %s: ramp %u-%u steps/s build failed\n", shape_name(shapes[s]),
+                       (unsigned)config.start_rate, (unsigned)config.max_rate);
+                failures++;
+                continue;
+            }
+            // 全速、半速和低于起步频率三种巡航间隔
+            const uint32_t cruise[] = {1000000 / config.max_rate, 2000000 / config.max_rate,
+                                       2000000 / config.start_rate};
+            int ramp_failures = 0;
+            for (size_t c = 0; c < sizeof(cruise) / sizeof(cruise[0]); c++)
+            {
+                for (size_t n = 0; n < sizeof(s_steps) / sizeof(s_steps[0]); n++)
+                {
+                    for (uint8_t shift = 0; shift <= 1; shift++)
+                    {
+                        ramp_failures += check_move(&ramp, s_steps[n], cruise[c], shift);
+                    }
+                    ramp_failures += check_stride(&ramp, s_steps[n], cruise[c], 1);
+                }
+            }
+            printf("%s_%u_%u_%u_levels: %u, failures: %d\n", shape_name(shapes[s]), (unsigned)config.start_rate,
+                   (unsigned)config.max_rate, (unsigned)config.accel, ramp.len, ramp_failures);
+            failures += ramp_failures;
+        }
+    }
+    return failures ? 1 : 0;
+}
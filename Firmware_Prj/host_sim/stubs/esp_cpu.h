@@ -0,0 +1,24 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdint.h>
+
+// 主机仿真用的 esp_cpu 替身，周期计数按 240MHz 由虚拟时间换算
+
+#define SIM_CPU_MHZ 240
+
+uint64_t sim_now_us(void);
+
+static inline uint32_t esp_cpu_get_cycle_count(void)
+{
+    return (uint32_t)(sim_now_us() * SIM_CPU_MHZ);
+}
+
+static inline int esp_cpu_get_core_id(void)
+{
+    return 0;
+}
@@ -0,0 +1,43 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_event.h"
+
+// 主机仿真用的 SmartConfig 替身，仿真中总是预先存好凭据，配网流程不会运行
+
+ESP_EVENT_DECLARE_BASE(SC_EVENT);
+
+typedef enum {
+    SC_EVENT_SCAN_DONE,
+    SC_EVENT_FOUND_CHANNEL,
+    SC_EVENT_GOT_SSID_PSWD,
+    SC_EVENT_SEND_ACK_DONE,
+} smartconfig_event_t;
+
+typedef enum {
+    SC_TYPE_ESPTOUCH = 0,
+} smartconfig_type_t;
+
+typedef struct {
+    uint8_t ssid[32];
+    uint8_t password[64];
+    bool bssid_set;
+    uint8_t bssid[6];
+    smartconfig_type_t type;
+} smartconfig_event_got_ssid_pswd_t;
+
+typedef struct {
+    bool enable_log;
+} smartconfig_start_config_t;
+
+#define SMARTCONFIG_START_CONFIG_DEFAULT() {.enable_log = false}
+
+esp_err_t esp_smartconfig_set_type(smartconfig_type_t type);
+esp_err_t esp_smartconfig_start(const smartconfig_start_config_t* config);
+esp_err_t esp_smartconfig_stop(void);
@@ -0,0 +1,28 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <sys/time.h>
+
+// 主机仿真用的 SNTP 替身：启动后过一段虚拟时间调用同步回调，不改动系统时间
+
+typedef enum {
+    SNTP_OPMODE_POLL,
+    SNTP_OPMODE_LISTENONLY,
+} sntp_operatingmode_t;
+
+typedef enum {
+    SNTP_SYNC_MODE_IMMED,
+    SNTP_SYNC_MODE_SMOOTH,
+} sntp_sync_mode_t;
+
+typedef void (*sntp_sync_time_cb_t)(struct timeval* tv);
+
+void esp_sntp_setoperatingmode(sntp_operatingmode_t operating_mode);
+void sntp_set_sync_mode(sntp_sync_mode_t sync_mode);
+void sntp_set_time_sync_notification_cb(sntp_sync_time_cb_t callback);
+void esp_sntp_setservername(unsigned char idx, const char* server);
+void esp_sntp_init(void);
@@ -0,0 +1,38 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdint.h>
+
+// 主机仿真用的 esp_system 替身，只有固件代码用到的声明；主机上没有堆统计，返回 0
+
+typedef enum
+{
+    ESP_RST_UNKNOWN,
+    ESP_RST_POWERON,
+    ESP_RST_EXT,
+    ESP_RST_SW,
+    ESP_RST_PANIC,
+    ESP_RST_INT_WDT,
+    ESP_RST_TASK_WDT,
+    ESP_RST_WDT,
+    ESP_RST_DEEPSLEEP,
+} esp_reset_reason_t;
+
+static inline esp_reset_reason_t esp_reset_reason(void)
+{
+    return ESP_RST_POWERON;
+}
+
+static inline uint32_t esp_get_free_heap_size(void)
+{
+    return 0;
+}
+
+static inline uint32_t esp_get_minimum_free_heap_size(void)
+{
+    return 0;
+}
@@ -0,0 +1,52 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct sim_task* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+typedef enum {
+    eNoAction = 0,
+    eSetBits,
+    eIncrement,
+    eSetValueWithOverwrite,
+    eSetValueWithoutOverwrite,
+} eNotifyAction;
+
+typedef struct {
+    TickType_t start;
+} TimeOut_t;
+
+// 仿真是单线程的，阻塞式任务函数无法运行，xTaskCreate 总是失败；仿真任务用 sim_task_create
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stack_depth, void* arg, UBaseType_t priority,
+                       TaskHandle_t* ret_task);
+void vTaskDelete(TaskHandle_t task);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+TickType_t xTaskGetTickCount(void);
+void vTaskDelay(TickType_t ticks);
+void vTaskSetTimeOutState(TimeOut_t* timeout);
+BaseType_t xTaskCheckForTimeOut(TimeOut_t* timeout, TickType_t* ticks_to_wait);
+
+BaseType_t xTaskGenericNotify(TaskHandle_t task, UBaseType_t index, uint32_t value, eNotifyAction action);
+BaseType_t xTaskGenericNotifyFromISR(TaskHandle_t task, UBaseType_t index, uint32_t value, eNotifyAction action,
+                                     BaseType_t* task_woken);
+BaseType_t xTaskGenericNotifyWait(UBaseType_t index, uint32_t clear_on_entry, uint32_t clear_on_exit,
+                                  uint32_t* value, TickType_t ticks_to_wait);
+uint32_t ulTaskGenericNotifyTake(UBaseType_t index, BaseType_t clear_on_exit, TickType_t ticks_to_wait);
+
+#define xTaskNotifyIndexed(task, index, value, action) xTaskGenericNotify(task, index, value, action)
+#define xTaskNotifyIndexedFromISR(task, index, value, action, woken) \
+    xTaskGenericNotifyFromISR(task, index, value, action, woken)
+#define xTaskNotifyGiveIndexed(task, index) xTaskGenericNotify(task, index, 0, eIncrement)
+#define vTaskNotifyGiveIndexedFromISR(task, index, woken) \
+    ((void)xTaskGenericNotifyFromISR(task, index, 0, eIncrement, woken))
+#define xTaskNotifyWaitIndexed(index, clear_entry, clear_exit, value, ticks) \
+    xTaskGenericNotifyWait(index, clear_entry, clear_exit, value, ticks)
+#define ulTaskNotifyTakeIndexed(index, clear, ticks) ulTaskGenericNotifyTake(index, clear, ticks)
+#define xTaskNotifyGive(task) xTaskNotifyGiveIndexed(task, 0)
+#define ulTaskNotifyTake(clear, ticks) ulTaskNotifyTakeIndexed(0, clear, ticks)
@@ -0,0 +1,15 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+typedef void (*PendedFunction_t)(void*, uint32_t);
+
+// 推迟的函数在仿真调度任务时于“定时器服务任务”中执行
+BaseType_t xTimerPendFunctionCallFromISR(PendedFunction_t function, void* param1, uint32_t param2,
+                                         BaseType_t* task_woken);
+BaseType_t xTimerPendFunctionCall(PendedFunction_t function, void* param1, uint32_t param2, TickType_t ticks_to_wait);
@@ -0,0 +1,23 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+// 主机仿真用的 sdkconfig 替身，只包含固件代码用到的选项
+
+#define CONFIG_STEP_MOTOR_ISR_STATS 1
+#define CONFIG_STEP_MOTOR_ISR_LATE_US 10
+#define CONFIG_PID_CTRL_BATCH_FUNC_IN_IRAM 1
+#define CONFIG_BINLOG_ENABLE 1
+#define CONFIG_BINLOG_RING_DEPTH 128
+#define CONFIG_BINLOG_FUNC_IN_IRAM 1
+#define CONFIG_POS_JOURNAL_SLOTS 4
+#define CONFIG_POS_JOURNAL_MIN_INTERVAL_S 30
+#define CONFIG_HOLLOW_CLOCK_WIFI_BACKOFF_MIN_MS 500
+#define CONFIG_HOLLOW_CLOCK_WIFI_BACKOFF_MAX_MS 60000
+#define CONFIG_HOLLOW_CLOCK_WIFI_FAST_ATTEMPTS 2
+#define CONFIG_HOLLOW_CLOCK_TIME_TRUST_MS 300000
+#define CONFIG_HOLLOW_CLOCK_TIME_DRIFT_PPM 50
+#define CONFIG_HOLLOW_CLOCK_RTC_DRIFT_PPM 10000
@@ -0,0 +1,183 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "telemetry.h"
+
+// 主机侧遥测解码：逐行读入串口输出，把 "TM <hex>" 行还原成每次采样的系统状态和各任务的
+// CPU 占比、栈余量，其余行原样输出。结束时按任务汇总最高 CPU 占比和最少栈余量，用来调整栈大小。
+// 记录格式取自固件的 telemetry.h，版本号不同的记录不解码
+//   idf.py monitor | ./build_sim/telemetry_decode
+
+#define TASK_SLOTS 256  // 按任务编号的低 8 位索引
+
+typedef struct
+{
+    bool seen;
+    char name[TELEMETRY_NAME_LEN + 1];
+    uint32_t runtime;        // 上一次采样的运行时间
+    uint32_t runtime_sample; // runtime 所属的采样序号
+    double max_cpu;
+    uint32_t min_stack_free;
+} task_summary_t;
+
+static task_summary_t s_tasks[TASK_SLOTS];
+
+static bool parse_hex(const char* hex, void* record, size_t size)
+{
+    uint8_t* bytes = (uint8_t*)record;
+    for (size_t i = 0; i < size; i++)
+    {
+        unsigned value;
+        if (sscanf(&hex[2 * i], "%2x", &value) != 1)
+        {
+            return false;
+        }
+        bytes[i] = (uint8_t)value;
+    }
+    return true;
+}
+
+static void print_system(const telemetry_system_t* system)
+{
+    printf("T (%u) sample %u: heap %u free, %u lowest; queue %u/%u, peak %u, %u overflows; "
+           "binlog %u dropped\n",
+           (unsigned)system->time_ms, (unsigned)system->sample, (unsigned)system->free_heap,
+           (unsigned)system->min_free_heap, system->queue_depth, system->queue_capacity, system->queue_peak,
+           system->queue_overflows, (unsigned)system->binlog_dropped);
+    printf("T (%u) motion: %u half steps, %u segments, %u clock moves in %u ms\n", (unsigned)system->time_ms,
+           (unsigned)system->emitted_steps, (unsigned)system->moves, (unsigned)system->clock_moves,
+           (unsigned)system->move_time_ms);
+}
+
+// CPU 占比按同一任务相邻两次采样的运行时间差值除以总运行时间的差值，第一次见到的任务没有占比
+static void print_task(const telemetry_task_t* task, const telemetry_system_t* system,
+                       const telemetry_system_t* previous)
+{
+    task_summary_t* summary = &s_tasks[task->number];
+    if (!summary->seen)
+    {
+        summary->min_stack_free = task->stack_free;
+    }
+    memcpy(summary->name, task->name, TELEMETRY_NAME_LEN);
+    summary->name[TELEMETRY_NAME_LEN] = '\0';
+
+    char cpu[16] = "-";
+    if (summary->seen && previous && summary->runtime_sample + 1 == system->sample &&
+        system->total_runtime != previous->total_runtime)
+    {
+        double share = 100.0 * (uint32_t)(task->runtime - summary->runtime) /
+                       (uint32_t)(system->total_runtime - previous->total_runtime);
+        snprintf(cpu, sizeof(cpu), "%.1f%%", share);
+        if (share > summary->max_cpu)
+        {
+            summary->max_cpu = share;
+        }
+    }
+    if (task->stack_free < summary->min_stack_free)
+    {
+        summary->min_stack_free = task->stack_free;
+    }
+    summary->seen = true;
+    summary->runtime = task->runtime;
+    summary->runtime_sample = system->sample;
+    printf("T (%u)   %-*s #%-3u prio %-2u cpu %6s  stack free %u B\n", (unsigned)system->time_ms,
+           TELEMETRY_NAME_LEN, summary->name, task->number, task->priority, cpu, (unsigned)task->stack_free);
+}
+
+int main(int argc, char** argv)
+{
+    FILE* in = stdin;
+    if (argc > 2)
+    {
+        fprintf(stderr, "usage: %s [FILE]\n", argv[0]);
+        return 2;
+    }
+    if (argc == 2)
+    {
+        in = fopen(argv[1], "r");
+        if (!in)
+        {
+            perror(argv[1]);
+            return 1;
+        }
+    }
+
+    char line[512];
+    unsigned long samples = 0;
+    unsigned long missed = 0;
+    unsigned long bad = 0;
+    telemetry_system_t system;
+    telemetry_system_t previous;
+    bool have_system = false;
+    bool have_previous = false;
+    while (fgets(line, sizeof(line), in))
+    {
+        // 监视器可能在行首加颜色或前缀，在行内查找标记
+        const char* mark = strstr(line, TELEMETRY_LINE_MARK);
+        const char* hex = mark ? mark + strlen(TELEMETRY_LINE_MARK) : NULL;
+        unsigned type = 0;
+        if (!hex || sscanf(hex, "%2x", &type) != 1)
+        {
+            fputs(line, stdout);
+            bad += mark != NULL;
+            continue;
+        }
+
+        if (type == TELEMETRY_RECORD_SYSTEM)
+        {
+            telemetry_system_t next;
+            if (strlen(hex) < 2 * sizeof(next) || !parse_hex(hex, &next, sizeof(next)) ||
+                next.version != TELEMETRY_VERSION)
+            {
+                bad++;
+                continue;
+            }
+            if (have_system)
+            {
+                previous = system;
+                have_previous = true;
+                missed += next.sample > system.sample + 1 ? next.sample - system.sample - 1 : 0;
+            }
+            system = next;
+            have_system = true;
+            samples++;
+            print_system(&system);
+        }
+        else if (type == TELEMETRY_RECORD_TASK && have_system)
+        {
+            telemetry_task_t task;
+            if (strlen(hex) < 2 * sizeof(task) || !parse_hex(hex, &task, sizeof(task)))
+            {
+                bad++;
+                continue;
+            }
+            print_task(&task, &system, have_previous && previous.sample + 1 == system.sample ? &previous : NULL);
+        }
+        else
+        {
+            bad++;
+        }
+    }
+    if (in != stdin)
+    {
+        fclose(in);
+    }
+
+    // 汇总：栈余量是整个运行期间的最小值，栈可以按 任务栈大小 - 最少剩余 + 余量 调整
+    printf("task          max_cpu  min_stack_free\n");
+    for (int i = 0; i < TASK_SLOTS; i++)
+    {
+        if (s_tasks[i].seen)
+        {
+            printf("%-*s %6.1f%%  %u\n", TELEMETRY_NAME_LEN, s_tasks[i].name, s_tasks[i].max_cpu,
+                   (unsigned)s_tasks[i].min_stack_free);
+        }
+    }
+    fprintf(stderr, "%lu samples decoded, %lu missed, %lu malformed\n", samples, missed, bad);
+    return 0;
+}
@@ -0,0 +1,166 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_wifi.h"
+#include "msg_bus.h"
+#include "nvs.h"
+#include "sim.h"
+#include "wifi_conn.h"
+
+// wifi_conn 在模拟 AP 上的重连场景：短暂断开、AP 断电几分钟、AP 换信道。
+// 检查断开后凭据仍在 NVS 里、事件处理从不阻塞事件循环、连接状态和 SNTP 同步经 msg_bus 发布，
+// 并给出每个场景的获取 IP 时间
+
+#define WIFI_SIM_DROP_S 60            // 信标丢失
+#define WIFI_SIM_OUTAGE_S 120         // AP 断电
+#define WIFI_SIM_OUTAGE_LEN_S 180
+#define WIFI_SIM_MOVE_S 900           // AP 换到另一个信道
+#define WIFI_SIM_END_S 1200
+#define WIFI_SIM_TRANSIENT_MAX_US 1000000  // 短暂断开后应在 1 秒内恢复
+
+static const uint8_t s_bssid[6] = {0x24, 0x0a, 0xc4, 0x12, 0x34, 0x56};
+
+typedef struct
+{
+    const char* name;
+    wifi_rc_stats_t before;
+    wifi_rc_stats_t after;
+} wifi_sim_phase_t;
+
+static void usage(const char* prog)
+{
+    fprintf(stderr, "usage: %s [--cold] [--verbose]\n"
+            "  --cold     boot without a cached AP, as right after provisioning\n", prog);
+}
+
+/* 预先写入凭据，相当于之前已经配过网 */
+static wifi_config_t wifi_sim_seed_nvs(bool cold)
+{
+    wifi_config_t config = {0};
+    memcpy(config.sta.ssid, "hollow-clock", 12);
+    memcpy(config.sta.password, "minute-hand", 11);
+    nvs_handle_t nvs;
+    ESP_ERROR_CHECK(nvs_open("wifi_data", NVS_READWRITE, &nvs));
+    ESP_ERROR_CHECK(nvs_set_blob(nvs, "key_wifi_data", &config, sizeof(config)));
+    if (!cold)
+    {
+        wifi_rc_ap_cache_t cache = {.channel = 6, .valid = true};
+        memcpy(cache.bssid, s_bssid, sizeof(cache.bssid));
+        ESP_ERROR_CHECK(nvs_set_blob(nvs, "ap_cache", &cache, sizeof(cache)));
+    }
+    nvs_close(nvs);
+    return config;
+}
+
+static bool wifi_sim_credentials_kept(const wifi_config_t* seeded)
+{
+    wifi_config_t stored;
+    size_t len = sizeof(stored);
+    nvs_handle_t nvs;
+    ESP_ERROR_CHECK(nvs_open("wifi_data", NVS_READONLY, &nvs));
+    bool kept = nvs_get_blob(nvs, "key_wifi_data", &stored, &len) == ESP_OK && len == sizeof(stored) &&
+                !memcmp(&stored, seeded, sizeof(stored));
+    nvs_close(nvs);
+    return kept;
+}
+
+static void wifi_sim_print_phase(const wifi_sim_phase_t* phase)
+{
+    printf("%s_time_to_ip_ms: %.1f\n", phase->name, phase->after.last_time_to_ip_us / 1000.0);
+    printf("%s_attempts: %u (%u fast)\n", phase->name, (unsigned)(phase->after.attempts - phase->before.attempts),
+           (unsigned)(phase->after.fast_attempts - phase->before.fast_attempts));
+}
+
+int main(int argc, char** argv)
+{
+    bool cold = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--cold"))
+        {
+            cold = true;
+        }
+        else if (!strcmp(argv[i], "--verbose"))
+        {
+            sim_log_verbose = 1;
+        }
+        else
+        {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    wifi_config_t seeded = wifi_sim_seed_nvs(cold);
+    uint32_t seed_writes = sim_nvs_get_writes();
+    // 仿真是单线程的，订阅者只查看不等待
+    msg_subscriber_t* sub;
+    ESP_ERROR_CHECK(msg_bus_subscribe(MSG_TOPIC_BIT(MSG_TOPIC_WIFI_STATE) | MSG_TOPIC_BIT(MSG_TOPIC_TIME_SYNC), &sub));
+    // 只订阅整分钟和调整请求的订阅者，相当于时钟任务，Wi-Fi 的任何事件都不应该让它有新消息
+    msg_subscriber_t* clock_sub;
+    ESP_ERROR_CHECK(msg_bus_subscribe(MSG_TOPIC_BIT(MSG_TOPIC_MINUTE_TICK) | MSG_TOPIC_BIT(MSG_TOPIC_ADJUST_TIME),
+                                      &clock_sub));
+    ESP_ERROR_CHECK(wifi_conn_start());
+
+    wifi_sim_phase_t boot = {.name = "boot"};
+    wifi_sim_phase_t drop = {.name = "drop"};
+    wifi_sim_phase_t outage = {.name = "outage"};
+    wifi_sim_phase_t move = {.name = "ap_move"};
+
+    sim_run_until(WIFI_SIM_DROP_S * 1000000ULL);
+    wifi_conn_get_stats(&boot.after);
+
+    drop.before = boot.after;
+    sim_wifi_drop();
+    sim_run_until(WIFI_SIM_OUTAGE_S * 1000000ULL);
+    wifi_conn_get_stats(&drop.after);
+
+    outage.before = drop.after;
+    sim_wifi_set_ap(false, NULL, 6);
+    sim_run_until((WIFI_SIM_OUTAGE_S + WIFI_SIM_OUTAGE_LEN_S) * 1000000ULL);
+    sim_wifi_set_ap(true, NULL, 6);
+    sim_run_until(WIFI_SIM_MOVE_S * 1000000ULL);
+    wifi_conn_get_stats(&outage.after);
+
+    move.before = outage.after;
+    sim_wifi_set_ap(true, NULL, 11);
+    sim_run_until(WIFI_SIM_END_S * 1000000ULL);
+    wifi_conn_get_stats(&move.after);
+
+    sim_wifi_stats_t driver;
+    sim_wifi_get_stats(&driver);
+    msg_payload_t state = {0};
+    bool published = msg_bus_take(sub, MSG_TOPIC_WIFI_STATE, &state);
+    bool connected = sim_wifi_has_ip() && published && state.wifi_state.connected;
+    msg_payload_t sync = {0};
+    bool synced = msg_bus_take(sub, MSG_TOPIC_TIME_SYNC, &sync) && sync.time_sync.epoch_us > 0;
+    bool kept = wifi_sim_credentials_kept(&seeded);
+
+    printf("boot_to_ip_ms: %.1f\n", move.after.boot_to_ip_us / 1000.0);
+    printf("boot_to_sntp_ms: %.1f\n", move.after.boot_to_sync_us / 1000.0);
+    wifi_sim_print_phase(&drop);
+    wifi_sim_print_phase(&outage);
+    wifi_sim_print_phase(&move);
+    printf("connects: %u\n", (unsigned)move.after.connects);
+    printf("drops: %u\n", (unsigned)move.after.drops);
+    printf("fast_misses: %u\n", (unsigned)move.after.fast_misses);
+    printf("max_time_to_ip_ms: %.1f\n", move.after.max_time_to_ip_us / 1000.0);
+    printf("driver_connects: %u (%u single channel)\n", (unsigned)driver.connects, (unsigned)driver.channel_scans);
+    printf("time_syncs: %u (%s published)\n", (unsigned)driver.sntp_syncs, synced ? "last" : "none");
+    printf("event_loop_max_block_ms: %.3f\n", driver.handler_max_block_us / 1000.0);
+    printf("nvs_writes: %u\n", (unsigned)(sim_nvs_get_writes() - seed_writes));
+    printf("credentials_kept: %s\n", kept ? "yes" : "no");
+    printf("connected_at_end: %s\n", connected ? "yes" : "no");
+    uint32_t clock_pending = msg_bus_wait(clock_sub, 0);
+    printf("clock_topics_pending: %u\n", (unsigned)clock_pending);
+
+    bool ok = connected && kept && driver.handler_max_block_us == 0 &&
+              drop.after.last_time_to_ip_us < WIFI_SIM_TRANSIENT_MAX_US && synced && !clock_pending;
+    return ok ? 0 : 1;
+}
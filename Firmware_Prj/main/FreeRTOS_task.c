@@ -4,24 +4,43 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 #include "freertos/FreeRTOS.h"
-#include "freertos/event_groups.h"
 #include "freertos/task.h"
 #include "main.h"
 #include "FreeRTOS_task.h"
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "binlog.h"
+#include "esp_attr.h"
 #include "esp_log.h"
-#include "esp_sntp.h"
+#include "esp_rtc_time.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include <inttypes.h>
+#include <sys/time.h>
 #include "step_motor.h"
+#include "clock_logic.h"
+#include "clock_status.h"
+#include "clock_sweep.h"
+#include "msg_bus.h"
+#include "time_source.h"
 
-#define MOTOR_TAG "STEP_MOTOR"
 #define CLOCK_TAG  "CLOCK_TASK"
+#define MINUTE_TICK_MARGIN_US 1000  // 在整分钟后稍晚触发，确保醒来时分钟已经变化
 
 // 前向声明
 void clock_control_task(void* pvParameters);
 static void update_clock_time(user_data_t* user_data);
-static float time_to_angle(int hour, int minute);
 static void feed_watchdog_if_needed(user_data_t* user_data);
+static void clock_arm_minute_timer(clock_control_handle_t* handle);
+static int32_t clock_target_step(const clock_time_t* time);
+static void clock_journal_position(void* ctx, bool force);
+static bool clock_restore_position(user_data_t* user_data);
+static void clock_time_init(void);
+static void clock_time_save(void);
+static bool clock_time_check_trusted(void);
+static void clock_publish_moved(int32_t from, int32_t target, esp_err_t err, int64_t start_us);
+static void clock_publish_status(user_data_t* user_data);
+static void clock_set_state(user_data_t* user_data, clock_state_t state);
 
 // 时钟控制处理函数 - 可以在管理任务空转时直接调用
 void clock_control_handler(clock_control_handle_t* handle);
@@ -35,73 +54,364 @@ clock_state_t get_clock_state(clock_control_handle_t* handle);
 // 静态时钟控制句柄定义
 static clock_control_handle_t clock_handle = {0};
 
+#if CONFIG_HOLLOW_CLOCK_SWEEP
+// 扫动模式的锁相环，积分项在重新对齐后保留
+static clock_sweep_t clock_sweep;
+#endif
 
-void step_motor_task(void* pvParameters)
+// 时间来源，SNTP 回调（lwIP 任务）、调整请求和时钟任务都会访问
+static time_source_t clock_time_source;
+static portMUX_TYPE clock_time_lock = portMUX_INITIALIZER_UNLOCKED;
+// 复位前最后一次的时间估计，时钟任务每次醒来更新
+static RTC_NOINIT_ATTR time_source_rtc_record_t clock_rtc_time;
+// 上一次醒来时时间是否可信，变为可信时立即跟上墙上时间
+static bool clock_time_trusted;
+
+// 分钟跳动、追赶、扫动和调整的判定在 clock_logic 里，与主机仿真共用；这里只提供回调
+static clock_logic_t clock_logic;
+// 当前这次运动开始的时间
+static int64_t clock_move_start_us;
+
+// 对外发布的状态快照，只有时钟任务写；最近一次运动的结果和运动次数只在时钟任务里更新
+static clock_status_lock_t clock_status;
+static msg_clock_moved_t clock_last_move;
+static uint32_t clock_moves;
+static uint32_t clock_move_time_ms;
+
+
+// 更新时钟时间
+static void update_clock_time(user_data_t* user_data) 
 {
-    user_data_t* signal = (user_data_t*)pvParameters;
-    ESP_LOGI(MOTOR_TAG, "Stepper task started");
-    signal->motor_control = stepper_driver_init();
-    signal->motor_control->motor_cmd_queue = xQueueCreate(4, sizeof(stepper_cmd_t));
-    ESP_LOGI(MOTOR_TAG, "Stepper task queue is ready");
-    while (1)
-    {
+    // 获取当前系统时间
+    clock_time_from_epoch(time(NULL), &user_data->current_time);
 
-        stepper_cmd_t cmd;
-        if unlikely (xQueueReceive(signal->motor_control->motor_cmd_queue, &cmd, portMAX_DELAY))
-        {
-            ESP_LOGI(MOTOR_TAG, "New command: steps=%d, dir=%s, speed=%dus", cmd.steps, cmd.dir_cw ? "CW" : "CCW",
-                     cmd.speed_us);
-            stepper_set_time(signal->motor_control, cmd.steps, cmd.dir_cw, cmd.speed_us);
-
-            while (stepper_is_moving(signal->motor_control))
-            {
-                vTaskDelay(pdMS_TO_TICKS(1));
-            }
-            
-            // 通知时钟任务电机运动完成
-            xEventGroupSetBits(signal->all_event, CLOCK_MOVE_COMPLETE_BIT);
-        }
-    }
+    BINLOG(CLOCK_TIME, user_data->current_time.hour, user_data->current_time.minute,
+           user_data->current_time.second);
+    clock_publish_status(user_data);
 }
 
-void stepper_rotate_angle(const motor_control_t* motor_control, float degree, bool cw, float rpm)
+// 把时钟任务的工作状态拷贝成快照发布，读者不会看到写了一半的时间
+static void clock_publish_status(user_data_t* user_data)
 {
-    int total_steps = (int)(degree / 360.0f * 4096.0f);
-    int us_per_step = (int)(60.0f * 1000000 / (rpm * 4096.0f));
+    const clock_status_t status = {
+        .state = user_data->clock_state,
+        .position = stepper_get_position(user_data->motor_control),
+        .current_time = user_data->current_time,
+        .target_time = user_data->target_time,
+        .time_trusted = clock_time_trusted,
+        .moves = clock_moves,
+        .last_move = clock_last_move,
+        .move_time_ms = clock_move_time_ms,
+        .catch_up_count = user_data->catch_up_count,
+        .catch_up_last_ms = user_data->catch_up_last_ms,
+        .catch_up_max_ms = user_data->catch_up_max_ms,
+    };
+    clock_status_publish(&clock_status, &status);
+}
+
+static void clock_set_state(user_data_t* user_data, clock_state_t state)
+{
+    user_data->clock_state = state;
+    clock_publish_status(user_data);
+}
+
+// 整分钟定时器回调（esp_timer 任务），只通知时钟任务
+static void clock_minute_timer_cb(void* arg)
+{
+    (void)arg;
+    msg_bus_publish(MSG_TOPIC_MINUTE_TICK, NULL);
+}
+
+// 按 gettimeofday() 算出到下一个整分钟的精确时间，重新装载单次定时器
+static void clock_arm_minute_timer(clock_control_handle_t* handle)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    uint64_t us = (60 - tv.tv_sec % 60) * 1000000ULL - tv.tv_usec + MINUTE_TICK_MARGIN_US;
+    esp_timer_stop(handle->minute_timer);  // 未在运行时返回 ESP_ERR_INVALID_STATE，忽略
+    ESP_ERROR_CHECK(esp_timer_start_once(handle->minute_timer, us));
+}
 
-    stepper_cmd_t cmd = {
-        .steps = total_steps,
-        .dir_cw = cw,
-        .speed_us = us_per_step,
+// 把系统时间设为某个来源的时间；SNTP 自己设置系统时间，其他来源成为最好的估计时由这里设置
+static void clock_set_system_time(int64_t epoch_us)
+{
+    struct timeval tv = {
+        .tv_sec = epoch_us / 1000000,
+        .tv_usec = epoch_us % 1000000,
     };
-    xQueueSend(motor_control->motor_cmd_queue, &cmd, portMAX_DELAY);
+    settimeofday(&tv, NULL);
 }
 
-// 将时间转换为角度的函数
-static float time_to_angle(int hour, int minute) 
+// 用 mono_us 时刻的读数重新锚定一个时间来源，返回更新后的最好估计
+static time_estimate_t clock_time_update(time_source_id_t source, int64_t epoch_us, uint32_t uncertainty_ms,
+                                         int64_t mono_us)
 {
-    // 小时角度计算：每小时30度，每分钟0.5度
-    float hour_angle = (hour % 12) * 30.0f + minute * 0.5f;
-    return hour_angle;
+    taskENTER_CRITICAL(&clock_time_lock);
+    time_source_update(&clock_time_source, source, epoch_us, uncertainty_ms, mono_us);
+    time_estimate_t best = time_source_best(&clock_time_source, esp_timer_get_time());
+    taskEXIT_CRITICAL(&clock_time_lock);
+    return best;
 }
 
-// 更新时钟时间
-static void update_clock_time(user_data_t* user_data) 
+// 获取当前最好的时间估计及其误差上限，可在任意任务中调用
+void clock_get_time_estimate(time_estimate_t* estimate)
 {
-    // 获取当前系统时间
-    time_t now;
+    taskENTER_CRITICAL(&clock_time_lock);
+    *estimate = time_source_best(&clock_time_source, esp_timer_get_time());
+    taskEXIT_CRITICAL(&clock_time_lock);
+}
+
+// 软件复位、看门狗复位和 panic 后 RTC 内存和 RTC 定时器都还在，加上复位期间走过的时间即可立即使用；
+// 上电和掉电复位后 RTC 内存的内容无效，只能等 SNTP 或手动设置
+static void clock_time_init(void)
+{
+    time_source_init(&clock_time_source, CONFIG_HOLLOW_CLOCK_TIME_DRIFT_PPM, CONFIG_HOLLOW_CLOCK_TIME_TRUST_MS);
+    esp_reset_reason_t reason = esp_reset_reason();
+    bool rtc_kept = reason == ESP_RST_SW || reason == ESP_RST_PANIC || reason == ESP_RST_INT_WDT ||
+                    reason == ESP_RST_TASK_WDT || reason == ESP_RST_WDT || reason == ESP_RST_DEEPSLEEP;
+    if (rtc_kept && time_source_restore(&clock_time_source, &clock_rtc_time, esp_rtc_get_time_us(),
+                                        CONFIG_HOLLOW_CLOCK_RTC_DRIFT_PPM, esp_timer_get_time())) {
+        time_estimate_t best = time_source_best(&clock_time_source, esp_timer_get_time());
+        clock_set_system_time(best.epoch_us);
+        ESP_LOGI(CLOCK_TAG, "Time resumed from RTC memory, uncertainty %"PRIu32" ms", best.uncertainty_ms);
+    }
+}
+
+// 把最好的估计存进 RTC 内存，复位后不必等 SNTP
+static void clock_time_save(void)
+{
+    uint64_t rtc_us = esp_rtc_get_time_us();
+    taskENTER_CRITICAL(&clock_time_lock);
+    time_source_save(&clock_time_source, esp_timer_get_time(), rtc_us, &clock_rtc_time);
+    taskEXIT_CRITICAL(&clock_time_lock);
+}
+
+// 手动设置的时分作为手动时间来源，日期沿用系统时间；没有更好的来源时系统时间随之改变，之后从这里接着走
+static void clock_set_manual_time(clock_control_handle_t* handle, const clock_time_t* manual)
+{
+    time_t now = time(NULL);
     struct tm timeinfo;
-    time(&now);
     localtime_r(&now, &timeinfo);
-    
-    user_data->current_time.hour = timeinfo.tm_hour;
-    user_data->current_time.minute = timeinfo.tm_min;
-    user_data->current_time.second = timeinfo.tm_sec;
-    
-    ESP_LOGI(CLOCK_TAG, "Current time: %02d:%02d:%02d", 
-             user_data->current_time.hour, 
-             user_data->current_time.minute, 
-             user_data->current_time.second);
+    timeinfo.tm_hour = manual->hour;
+    timeinfo.tm_min = manual->minute;
+    timeinfo.tm_sec = 0;
+    int64_t epoch_us = (int64_t)mktime(&timeinfo) * 1000000LL;
+    time_estimate_t best = clock_time_update(TIME_SOURCE_MANUAL, epoch_us, TIME_SOURCE_MANUAL_UNCERTAINTY_MS,
+                                             esp_timer_get_time());
+    if (best.source == TIME_SOURCE_MANUAL) {
+        clock_set_system_time(epoch_us);
+        clock_arm_minute_timer(handle);
+    }
+}
+
+// 时间是否可信，变化时打印一次
+static bool clock_time_check_trusted(void)
+{
+    time_estimate_t best;
+    clock_get_time_estimate(&best);
+    if (best.trusted != clock_time_trusted) {
+        ESP_LOGI(CLOCK_TAG, "Time %s: source %s, uncertainty %"PRIu32" ms",
+                 best.trusted ? "trusted" : "not trusted, holding the hand", time_source_name(best.source),
+                 best.uncertainty_ms);
+        clock_time_trusted = best.trusted;
+        clock_publish_status(clock_handle.user_data);
+    }
+    return best.trusted;
+}
+
+// 指针的一次运动结束，把结果发布给订阅者
+static void clock_publish_moved(int32_t from, int32_t target, esp_err_t err, int64_t start_us)
+{
+    msg_payload_t msg = {
+        .clock_moved = {
+            .from = from,
+            .target = target,
+            .position = stepper_get_position(clock_handle.user_data->motor_control),
+            .err = err,
+            .elapsed_ms = (uint32_t)((esp_timer_get_time() - start_us) / 1000),
+        },
+    };
+    clock_last_move = msg.clock_moved;
+    clock_moves++;
+    clock_move_time_ms += msg.clock_moved.elapsed_ms;
+    clock_publish_status(clock_handle.user_data);
+    msg_bus_publish(MSG_TOPIC_CLOCK_MOVED, &msg);
+}
+
+// 时间对应的指针绝对位置，位置始终以半步计
+static int32_t clock_target_step(const clock_time_t* time)
+{
+    return clock_time_to_step(time->hour, time->minute, stepper_steps_per_rev(STEPPER_DRIVE_HALF));
+}
+
+// 当天的墙上时间（微秒），SNTP 平滑校时期间也连续变化
+static int64_t wall_us_of_day(void)
+{
+    struct timeval tv;
+    struct tm timeinfo;
+    gettimeofday(&tv, NULL);
+    localtime_r(&tv.tv_sec, &timeinfo);
+    return ((timeinfo.tm_hour * 60 + timeinfo.tm_min) * 60 + timeinfo.tm_sec) * 1000000LL + tv.tv_usec;
+}
+
+// 追赶规划的耗时估计：按最高转速的双相整步走完最短路径
+static uint64_t catch_up_move_time(int32_t from, int32_t to, void* ctx)
+{
+    motor_control_t* motor_control = ((user_data_t*)ctx)->motor_control;
+    int32_t distance = clock_step_distance(from, to, stepper_steps_per_rev(STEPPER_DRIVE_HALF));
+    return stepper_move_duration_us(motor_control, distance < 0 ? -distance : distance, stepper_max_rpm(motor_control),
+                                    STEPPER_DRIVE_FULL);
+}
+
+static int64_t clock_ops_wall_us_of_day(void* ctx)
+{
+    (void)ctx;
+    return wall_us_of_day();
+}
+
+static int32_t clock_ops_get_position(void* ctx)
+{
+    return stepper_get_position(((user_data_t*)ctx)->motor_control);
+}
+
+static void clock_ops_move_begin(void* ctx, clock_move_kind_t kind, int32_t from, int32_t target)
+{
+    user_data_t* user_data = (user_data_t*)ctx;
+    clock_move_start_us = esp_timer_get_time();
+    if (kind == CLOCK_MOVE_ADJUST) {
+        BINLOG(CLOCK_ADJUST, from, target);
+        clock_set_state(user_data, CLOCK_STATE_ADJUSTING);
+        return;
+    }
+    if (kind == CLOCK_MOVE_CATCH_UP) {
+        BINLOG(CLOCK_JUMP, clock_step_distance(from, target, stepper_steps_per_rev(STEPPER_DRIVE_HALF)));
+    } else {
+        BINLOG(CLOCK_MOVE, from, target);
+    }
+    clock_set_state(user_data, CLOCK_STATE_MOVING);
+}
+
+// 分钟跳动按电机的默认驱动方式低速走；追赶和调整用双相整步，中断频率减半，启停由加速表平滑
+static int clock_ops_move_to(void* ctx, clock_move_kind_t kind, int32_t target, uint64_t predicted_us)
+{
+    motor_control_t* motor_control = ((user_data_t*)ctx)->motor_control;
+    uint32_t rpm = CLOCK_MINUTE_RPM;
+    stepper_drive_mode_t mode = motor_control->drive_mode;
+    if (kind == CLOCK_MOVE_CATCH_UP) {
+        BINLOG(CLOCK_CATCH_UP, stepper_get_position(motor_control), target, (uint32_t)(predicted_us / 1000));
+        rpm = stepper_max_rpm(motor_control);
+        mode = STEPPER_DRIVE_FULL;
+    } else if (kind == CLOCK_MOVE_ADJUST) {
+        rpm = CLOCK_ADJUST_RPM;
+        mode = STEPPER_DRIVE_FULL;
+    }
+    stepper_move_handle_t move = stepper_move_to(motor_control, target, rpm, mode);
+    return stepper_wait_move(motor_control, move, portMAX_DELAY);
+}
+
+static void clock_ops_move_end(void* ctx, clock_move_kind_t kind, int32_t from, int32_t target, int err)
+{
+    user_data_t* user_data = (user_data_t*)ctx;
+    if (kind == CLOCK_MOVE_MINUTE && err == ESP_OK) {
+        BINLOG(CLOCK_MOVE_DONE, stepper_get_position(user_data->motor_control));
+    } else if (kind == CLOCK_MOVE_ADJUST && err == ESP_OK) {
+        ESP_LOGI(CLOCK_TAG, "Time adjustment completed");
+        user_data->current_time = user_data->target_time;
+    }
+    clock_publish_moved(from, target, err, clock_move_start_us);
+    clock_set_state(user_data, CLOCK_STATE_IDLE);
+    if (kind != CLOCK_MOVE_CATCH_UP) {
+        return;
+    }
+
+    uint32_t elapsed_ms = (uint32_t)((esp_timer_get_time() - clock_move_start_us) / 1000);
+    user_data->catch_up_count++;
+    user_data->catch_up_last_ms = elapsed_ms;
+    if (elapsed_ms > user_data->catch_up_max_ms) {
+        user_data->catch_up_max_ms = elapsed_ms;
+    }
+    update_clock_time(user_data);
+    ESP_LOGI(CLOCK_TAG, "Catch-up completed in %"PRIu32" ms", elapsed_ms);
+}
+
+static bool clock_ops_is_sweeping(void* ctx)
+{
+    return stepper_is_sweeping(((user_data_t*)ctx)->motor_control);
+}
+
+static void clock_ops_stop(void* ctx)
+{
+    stepper_stop(((user_data_t*)ctx)->motor_control);
+}
+
+#if CONFIG_HOLLOW_CLOCK_SWEEP
+static bool clock_ops_sweep_update(void* ctx, int64_t us_of_day)
+{
+    int32_t error_us = clock_sweep_update(&clock_sweep, ((user_data_t*)ctx)->motor_control, us_of_day);
+    BINLOG(CLOCK_SWEEP, error_us, clock_sweep.trim_ppb);
+    return error_us <= CLOCK_SWEEP_LOCK_RANGE_US && error_us >= -CLOCK_SWEEP_LOCK_RANGE_US;
+}
+
+static void clock_ops_sweep_start(void* ctx, int64_t us_of_day)
+{
+    if (clock_sweep_start(&clock_sweep, ((user_data_t*)ctx)->motor_control, us_of_day) != ESP_OK) {
+        ESP_LOGW(CLOCK_TAG, "Sweep not started");
+    }
+}
+#endif
+
+static const clock_logic_ops_t clock_logic_ops = {
+    .wall_us_of_day = clock_ops_wall_us_of_day,
+    .get_position = clock_ops_get_position,
+    .move_begin = clock_ops_move_begin,
+    .move_end = clock_ops_move_end,
+    .move_to = clock_ops_move_to,
+    .catch_up_time = catch_up_move_time,
+    .journal = clock_journal_position,
+    .is_sweeping = clock_ops_is_sweeping,
+    .stop = clock_ops_stop,
+#if CONFIG_HOLLOW_CLOCK_SWEEP
+    .sweep_update = clock_ops_sweep_update,
+    .sweep_start = clock_ops_sweep_start,
+#endif
+};
+
+// 把指针停下的位置和最后通电的相位记入日志；force 时不等最短间隔，立即写入
+static void clock_journal_position(void* ctx, bool force)
+{
+    user_data_t* user_data = (user_data_t*)ctx;
+    if (!user_data->pos_journal) {
+        return;
+    }
+    int position;
+    int step_index;
+    stepper_get_position_phase(user_data->motor_control, &position, &step_index);
+    pos_journal_append(user_data->pos_journal, position, (uint8_t)step_index, (uint32_t)time(NULL));
+    if (force) {
+        pos_journal_flush(user_data->pos_journal);
+    }
+}
+
+// 从日志恢复断电前指针的位置和相位，不需要重新归零。日志时间只是当前时间的下限，作为最低一级的
+// 时间来源；断电后 RTC 从 1970 年开始，没有更好的来源时先把系统时间设回日志时间，
+// 指针停在原处等待可信的时间，之后只追赶一次补上断电期间的差值
+static bool clock_restore_position(user_data_t* user_data)
+{
+    pos_journal_record_t record;
+    if (!user_data->pos_journal || pos_journal_recover(user_data->pos_journal, &record) != ESP_OK) {
+        return false;
+    }
+    if (stepper_restore_position(user_data->motor_control, record.position, record.step_index) != ESP_OK) {
+        return false;
+    }
+    BINLOG(CLOCK_RESTORE, record.position, record.step_index, record.timestamp);
+    time_estimate_t best = clock_time_update(TIME_SOURCE_JOURNAL, record.timestamp * 1000000LL,
+                                             TIME_SOURCE_UNBOUNDED, esp_timer_get_time());
+    if (best.source == TIME_SOURCE_JOURNAL && time(NULL) < (time_t)record.timestamp) {
+        clock_set_system_time(record.timestamp * 1000000LL);
+        ESP_LOGW(CLOCK_TAG, "Wall clock lost, holding the hand until the time is trusted");
+    }
+    return true;
 }
 
 // 根据需要喂狗
@@ -125,75 +435,69 @@ void clock_control_task(void* pvParameters)
     // 使用文件作用域静态句柄
     if (!clock_handle.initialized) {
         clock_handle.user_data = user_data;
+        clock_status_init(&clock_status);
+        const esp_timer_create_args_t timer_args = {
+            .callback = clock_minute_timer_cb,
+            .arg = &clock_handle,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = "clock_minute",
+        };
+        ESP_ERROR_CHECK(esp_timer_create(&timer_args, &clock_handle.minute_timer));
+        clock_logic = (clock_logic_t) {
+            .ops = &clock_logic_ops,
+            .ctx = user_data,
+            .steps_per_rev = stepper_steps_per_rev(STEPPER_DRIVE_HALF),
+        };
+#if CONFIG_HOLLOW_CLOCK_SWEEP
+        ESP_ERROR_CHECK(clock_sweep_init(&clock_sweep, stepper_steps_per_rev(STEPPER_DRIVE_HALF)));
+        clock_logic.sweep = true;
+#endif
+        clock_time_init();
+        // 只订阅自己的主题，Wi-Fi 状态变化不会唤醒时钟任务
+        ESP_ERROR_CHECK(msg_bus_subscribe(MSG_TOPIC_BIT(MSG_TOPIC_MINUTE_TICK) | MSG_TOPIC_BIT(MSG_TOPIC_TIME_SYNC) |
+                                          MSG_TOPIC_BIT(MSG_TOPIC_ADJUST_TIME), &clock_handle.bus));
         clock_handle.initialized = true;
     }
     
-    // 初始化时间
+    // 初始化时间：日志里有断电前的位置时从那里继续，否则认为上电时指针指向当前时间，以此作为绝对位置的参考
+    bool restored = clock_restore_position(user_data);
     update_clock_time(user_data);
-    
-    TickType_t last_minute_check = xTaskGetTickCount();
-    const TickType_t minute_check_interval = pdMS_TO_TICKS(1000); // 每秒检查一次时间
+    if (!restored) {
+        stepper_set_position(user_data->motor_control, clock_target_step(&user_data->current_time));
+    }
+    clock_arm_minute_timer(&clock_handle);
+    clock_time_save();
+    bool trusted = clock_time_check_trusted();
+    if (!trusted) {
+        ESP_LOGW(CLOCK_TAG, "No trusted time source yet, the hand waits for SNTP or a manual setting");
+    }
+    clock_logic_boot(&clock_logic, &user_data->current_time, trusted, restored);
     
     while (1) {
-        // 检查是否需要更新时间（每分钟）
-        if (xTaskGetTickCount() - last_minute_check >= minute_check_interval) {
-            last_minute_check = xTaskGetTickCount();
-            
-            // 更新当前时间
-            clock_time_t old_time = user_data->current_time;
-            update_clock_time(user_data);
-            
-            // 检查分钟是否变化（分针跳动）
-            if (user_data->current_time.minute != old_time.minute || 
-                user_data->current_time.hour != old_time.hour) {
-                ESP_LOGI(CLOCK_TAG, "Minute changed, moving minute hand");
-                
-                // 计算需要旋转的角度
-                float target_angle = time_to_angle(user_data->current_time.hour, user_data->current_time.minute);
-                float current_angle = time_to_angle(old_time.hour, old_time.minute);
-                float angle_diff = target_angle - current_angle;
-                
-                // 规范化角度差到 [-180, 180] 范围
-                if (angle_diff > 180.0f) {
-                    angle_diff -= 360.0f;
-                } else if (angle_diff < -180.0f) {
-                    angle_diff += 360.0f;
-                }
-                
-                // 确定旋转方向
-                bool dir_cw = angle_diff >= 0;
-                float abs_angle_diff = dir_cw ? angle_diff : -angle_diff;
-                
-                ESP_LOGI(CLOCK_TAG, "Rotating minute hand by %.2f degrees %s", 
-                         abs_angle_diff, dir_cw ? "clockwise" : "counter-clockwise");
-                
-                // 设置状态为运动状态
-                user_data->clock_state = CLOCK_STATE_MOVING;
-                
-                // 发送旋转命令
-                stepper_rotate_angle(user_data->motor_control, abs_angle_diff, dir_cw, 6.0f); // 6 RPM速度
-                
-                // 等待运动完成
-                EventBits_t uxBits = xEventGroupWaitBits(user_data->all_event, 
-                                                         CLOCK_MOVE_COMPLETE_BIT, 
-                                                         pdTRUE, 
-                                                         pdFALSE, 
-                                                         portMAX_DELAY);
-                
-                if (uxBits & CLOCK_MOVE_COMPLETE_BIT) {
-                    ESP_LOGI(CLOCK_TAG, "Minute hand movement completed");
-                }
-                
-                // 恢复空闲状态
-                user_data->clock_state = CLOCK_STATE_IDLE;
-            }
+        // 一直阻塞到整分钟定时器、SNTP 同步或时间调整请求，期间系统可以进入浅睡眠
+        msg_bus_wait(clock_handle.bus, portMAX_DELAY);
+        // SNTP 同步或校正后墙上时间可能跳变，按收到应答的时刻锚定，再重新对齐整分钟定时器
+        msg_payload_t msg;
+        bool synced = msg_bus_take(clock_handle.bus, MSG_TOPIC_TIME_SYNC, &msg);
+        if (synced) {
+            clock_time_update(TIME_SOURCE_SNTP, msg.time_sync.epoch_us, TIME_SOURCE_SNTP_UNCERTAINTY_MS, msg.time_sync.mono_us);
+            ESP_LOGI(CLOCK_TAG, "Time synchronized, re-arming minute timer");
+        }
+        if (msg_bus_take(clock_handle.bus, MSG_TOPIC_MINUTE_TICK, NULL) || synced) {
+            clock_arm_minute_timer(&clock_handle);
         }
+        // 更新当前时间
+        clock_time_t old_time = user_data->current_time;
+        update_clock_time(user_data);
+        clock_time_save();
+        
+        // 时间不可信时指针停在原处，变为可信时立即跟上，不会先按错误的时间走一遍
+        bool was_trusted = clock_time_trusted;
+        trusted = clock_time_check_trusted();
+        clock_logic_wake(&clock_logic, &old_time, &user_data->current_time, was_trusted, trusted);
         
         // 调用时钟控制处理函数
         clock_control_handler(&clock_handle);
-        
-        // 短暂延迟以允许其他任务执行
-        vTaskDelay(pdMS_TO_TICKS(100));
     }
 }
 
@@ -206,52 +510,14 @@ void clock_control_handler(clock_control_handle_t* handle)
     
     user_data_t* user_data = handle->user_data;
     
-    // 检查是否有时间调整请求
-    EventBits_t uxBits = xEventGroupGetBits(user_data->all_event);
-    if (uxBits & CLOCK_ADJUST_TIME_BIT) {
+    // 检查是否有时间调整请求，连续的请求只取最后一个
+    msg_payload_t msg;
+    if (msg_bus_take(handle->bus, MSG_TOPIC_ADJUST_TIME, &msg)) {
         ESP_LOGI(CLOCK_TAG, "Time adjustment requested via handler");
-        xEventGroupClearBits(user_data->all_event, CLOCK_ADJUST_TIME_BIT);
-        
-        // 设置状态为调整状态
-        user_data->clock_state = CLOCK_STATE_ADJUSTING;
+        user_data->target_time = msg.adjust_time;
+        clock_set_manual_time(handle, &user_data->target_time);
         
-        // 计算目标角度和当前角度的差值
-        float target_angle = time_to_angle(user_data->target_time.hour, user_data->target_time.minute);
-        float current_angle = time_to_angle(user_data->current_time.hour, user_data->current_time.minute);
-        float angle_diff = target_angle - current_angle;
-        
-        // 规范化角度差到 [-180, 180] 范围
-        if (angle_diff > 180.0f) {
-            angle_diff -= 360.0f;
-        } else if (angle_diff < -180.0f) {
-            angle_diff += 360.0f;
-        }
-        
-        // 确定旋转方向
-        bool dir_cw = angle_diff >= 0;
-        float abs_angle_diff = dir_cw ? angle_diff : -angle_diff;
-        
-        ESP_LOGI(CLOCK_TAG, "Adjusting time: rotating by %.2f degrees %s", 
-                 abs_angle_diff, dir_cw ? "clockwise" : "counter-clockwise");
-        
-        // 发送旋转命令
-        stepper_rotate_angle(user_data->motor_control, abs_angle_diff, dir_cw, 10.0f); // 10 RPM速度
-        
-        // 等待运动完成
-        EventBits_t uxBits = xEventGroupWaitBits(user_data->all_event, 
-                                                 CLOCK_MOVE_COMPLETE_BIT, 
-                                                 pdTRUE, 
-                                                 pdFALSE, 
-                                                 portMAX_DELAY);
-        
-        if (uxBits & CLOCK_MOVE_COMPLETE_BIT) {
-            ESP_LOGI(CLOCK_TAG, "Time adjustment completed");
-            // 更新当前时间
-            user_data->current_time = user_data->target_time;
-        }
-        
-        // 恢复空闲状态
-        user_data->clock_state = CLOCK_STATE_IDLE;
+        clock_logic_adjust(&clock_logic, &user_data->target_time);
     }
     
     // 喂狗操作
@@ -265,12 +531,14 @@ void set_clock_target_time(clock_control_handle_t* handle, int hour, int minute)
         return;
     }
     
-    user_data_t* user_data = handle->user_data;
-    user_data->target_time.hour = hour;
-    user_data->target_time.minute = minute;
-    
-    // 触发时间调整事件
-    xEventGroupSetBits(user_data->all_event, CLOCK_ADJUST_TIME_BIT);
+    // 目标时间随请求一起发给时钟任务
+    msg_payload_t msg = {
+        .adjust_time = {
+            .hour = hour,
+            .minute = minute,
+        },
+    };
+    msg_bus_publish(MSG_TOPIC_ADJUST_TIME, &msg);
 }
 
 // 获取时钟状态
@@ -280,7 +548,15 @@ clock_state_t get_clock_state(clock_control_handle_t* handle)
         return CLOCK_STATE_IDLE;
     }
     
-    return handle->user_data->clock_state;
+    clock_status_t status;
+    clock_status_read(&clock_status, &status);
+    return status.state;
+}
+
+// 获取时钟与电机状态的一致快照
+void clock_get_status(clock_status_t* status)
+{
+    clock_status_read(&clock_status, status);
 }
 
 void motor_control_task(void* pvParameters)
@@ -288,7 +564,7 @@ void motor_control_task(void* pvParameters)
     user_data_t* signal = (user_data_t*)pvParameters;
     
     // 示例：旋转90度，顺时针，10 RPM
-    stepper_rotate_angle(signal->motor_control, 90, true, 10);
+    stepper_rotate_arcsec(signal->motor_control, 90 * 3600, true, 10, signal->motor_control->drive_mode);
     vTaskDelay(pdMS_TO_TICKS(2000)); // 等待2秒
     
     // 示例：旋转2秒，逆时针，速度500us/step
@@ -303,184 +579,7 @@ void motor_control_task(void* pvParameters)
     {
         // 每10秒执行一次示例动作
         ESP_LOGI("MOTOR_CTRL", "Performing periodic rotation");
-        stepper_rotate_angle(signal->motor_control, 30, true, 5); // 旋转30度
+        stepper_rotate_arcsec(signal->motor_control, 30 * 3600, true, 5, signal->motor_control->drive_mode); // 旋转30度
         vTaskDelay(pdMS_TO_TICKS(10000));
     }
 }
-///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-#include <time.h>
-#include "esp_smartconfig.h"
-#include "esp_wifi.h"
-#include "nvs.h"
-#include "nvs_flash.h"
-
-#define CONNECTED_BIT BIT0
-#define ESP_TOUCH_DONE_BIT BIT1
-#define ESP_NVS_STORED_BIT BIT2
-#define NTP_READY_BIT BIT4
-
-/*NVS_FLASH Configuration */
-static const char* NVS_Name_space = "wifi_data";
-static const char* NVS_Key = "key_wifi_data";
-static nvs_handle_t wifi_nvs_handle;
-static wifi_config_t wifi_config_stored;
-
-void smart_config_task(void* pvParameters);
-
-static const char* SMART_TAG = "smartconfig";
-
-static void event_handler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data)
-{
-    user_data_t* signal = (user_data_t*)arg;
-    if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START)
-    {
-        EventBits_t uxBits_NVS = xEventGroupWaitBits(signal->all_event, ESP_NVS_STORED_BIT, true, false, (TickType_t)0);
-        if (!(uxBits_NVS & (ESP_NVS_STORED_BIT)))
-        {
-            xTaskCreate(smart_config_task, "smart_config_task", 4096, signal, 3, NULL);
-            memset(&wifi_config_stored, 0x0, sizeof(wifi_config_stored));
-        }
-        else
-        {
-            esp_wifi_connect();
-        }
-    }
-    else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED)
-    {
-        ESP_ERROR_CHECK(nvs_open(NVS_Name_space, NVS_READWRITE, &wifi_nvs_handle));
-        ESP_ERROR_CHECK(nvs_erase_key(wifi_nvs_handle, NVS_Key));
-        vTaskDelay(2000 / portTICK_PERIOD_MS);
-        ESP_ERROR_CHECK(nvs_erase_all(wifi_nvs_handle));
-        vTaskDelay(2000 / portTICK_PERIOD_MS);
-        ESP_ERROR_CHECK(nvs_commit(wifi_nvs_handle));
-        nvs_close(wifi_nvs_handle);
-        esp_wifi_connect();
-        xEventGroupClearBits(signal->all_event, CONNECTED_BIT);
-    }
-    else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP)
-    {
-        user_data_t* user_signal = (user_data_t*)arg;
-        xEventGroupSetBits(user_signal->all_event, CONNECTED_BIT);
-        xEventGroupSetBits(user_signal->all_event, CONNECTED_BIT);
-    }
-    else if (event_base == SC_EVENT && event_id == SC_EVENT_SCAN_DONE)
-    {
-        ESP_LOGI(SMART_TAG, "Scan done");
-    }
-    else if (event_base == SC_EVENT && event_id == SC_EVENT_FOUND_CHANNEL)
-    {
-        ESP_LOGI(SMART_TAG, "Found channel");
-    }
-    else if (event_base == SC_EVENT && event_id == SC_EVENT_GOT_SSID_PSWD)
-    {
-        ESP_LOGI(SMART_TAG, "Got SSID and password");
-
-        smartconfig_event_got_ssid_pswd_t* evt = (smartconfig_event_got_ssid_pswd_t*)event_data;
-        wifi_config_t wifi_config;
-        uint8_t ssid[33] = {0};
-        uint8_t password[65] = {0};
-
-        bzero(&wifi_config, sizeof(wifi_config_t));
-        memcpy(wifi_config.sta.ssid, evt->ssid, sizeof(wifi_config.sta.ssid));
-        memcpy(wifi_config.sta.password, evt->password, sizeof(wifi_config.sta.password));
-        wifi_config.sta.bssid_set = evt->bssid_set;
-        if (wifi_config.sta.bssid_set == true)
-        {
-            memcpy(wifi_config.sta.bssid, evt->bssid, sizeof(wifi_config.sta.bssid));
-        }
-
-        memcpy(ssid, evt->ssid, sizeof(evt->ssid));
-        memcpy(password, evt->password, sizeof(evt->password));
-
-        ESP_LOGI(SMART_TAG, "SSID:%s", ssid);
-        ESP_LOGI(SMART_TAG, "PASSWORD:%s", password);
-
-        ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi_config));
-        ESP_ERROR_CHECK(nvs_open(NVS_Name_space, NVS_READWRITE, &wifi_nvs_handle));
-        ESP_ERROR_CHECK(nvs_set_blob(wifi_nvs_handle, NVS_Key, &wifi_config, sizeof(wifi_config)));
-        ESP_ERROR_CHECK(nvs_commit(wifi_nvs_handle));
-        nvs_close(wifi_nvs_handle);
-
-        ESP_ERROR_CHECK(esp_wifi_connect());
-    }
-    else if (event_base == SC_EVENT && event_id == SC_EVENT_SEND_ACK_DONE)
-    {
-        xEventGroupSetBits(signal->all_event, ESP_TOUCH_DONE_BIT);
-    }
-}
-
-void initialise_wifi_task(void* pvParameters)
-{
-    user_data_t* signal = (user_data_t*)pvParameters;
-    ESP_ERROR_CHECK(esp_netif_init());
-    ESP_ERROR_CHECK(nvs_flash_init());
-
-
-    ESP_ERROR_CHECK(esp_event_loop_create_default());
-    esp_netif_t* sta_netif = esp_netif_create_default_wifi_sta();
-    assert(sta_netif);
-
-    wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
-    ESP_ERROR_CHECK(esp_wifi_init(&cfg));
-
-    ESP_ERROR_CHECK(esp_event_handler_register(WIFI_EVENT, ESP_EVENT_ANY_ID, &event_handler, signal));
-    ESP_ERROR_CHECK(esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP, &event_handler, signal));
-    ESP_ERROR_CHECK(esp_event_handler_register(SC_EVENT, ESP_EVENT_ANY_ID, &event_handler, signal));
-
-    ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
-
-    ESP_ERROR_CHECK(nvs_open(NVS_Name_space, NVS_READWRITE, &wifi_nvs_handle));
-
-    uint32_t len = sizeof(wifi_config_stored);
-    esp_err_t ret = nvs_get_blob(wifi_nvs_handle, NVS_Key, &wifi_config_stored, (size_t*)&len);
-
-    if (likely(ret == ESP_OK))
-    {
-        xEventGroupSetBits(signal->all_event, ESP_NVS_STORED_BIT);
-        nvs_close(wifi_nvs_handle);
-        ESP_ERROR_CHECK(esp_wifi_set_config((wifi_interface_t)ESP_IF_WIFI_STA, &wifi_config_stored));
-    }
-    else
-    {
-        xEventGroupClearBits(signal->all_event, ESP_NVS_STORED_BIT);
-        nvs_close(wifi_nvs_handle);
-    }
-
-    ESP_ERROR_CHECK(esp_wifi_start());
-    vTaskDelete(NULL);
-}
-
-void smart_config_task(void* pvParameters)
-{
-    user_data_t* user_signal = (user_data_t*)pvParameters;
-    ESP_ERROR_CHECK(esp_smartconfig_set_type(SC_TYPE_ESPTOUCH));
-    smartconfig_start_config_t cfg = SMARTCONFIG_START_CONFIG_DEFAULT();
-    ESP_ERROR_CHECK(esp_smartconfig_start(&cfg));
-    while (1)
-    {
-        EventBits_t uxBits =
-            xEventGroupWaitBits(user_signal->all_event, CONNECTED_BIT | ESP_TOUCH_DONE_BIT, true, false, portMAX_DELAY);
-        if (likely(uxBits & CONNECTED_BIT))
-        {
-            ESP_LOGI(SMART_TAG, "WiFi Connected to ap");
-            xEventGroupSetBits(user_signal->all_event, CONNECTED_BIT);
-        }
-        if (likely(uxBits & ESP_TOUCH_DONE_BIT))
-        {
-            ESP_LOGI(SMART_TAG, "smart_config over");
-            esp_smartconfig_stop();
-            xEventGroupSetBits(user_signal->all_event, ESP_TOUCH_DONE_BIT);
-            ESP_LOGI("MAIN", "Network found, prepare to connect SNTP");
-            setenv("TZ", "EST-8", 1);
-            tzset();
-            sntp_set_sync_mode(SNTP_SYNC_MODE_SMOOTH);
-            esp_sntp_setservername(0, "ntp1.aliyun.com");
-            esp_sntp_setservername(1, "ntp2.aliyun.com");
-            esp_sntp_setservername(2, "ntp3.aliyun.com");
-            esp_sntp_init();
-            xEventGroupSetBits(user_signal->all_event, NTP_READY_BIT);
-            break;
-        }
-    }
-    vTaskDelete(NULL);
-}
\ No newline at end of file
@@ -1,34 +1,43 @@
-/*
- * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
- *
- * SPDX-License-Identifier: Apache-2.0
- */
-//
-// Created by jeong on 2025/5/27.
-//
-#ifndef FREERTOS_TASK_H
-#define FREERTOS_TASK_H
-
-#include "main.h"
-
-// 添加时钟控制句柄结构体定义
-typedef struct clock_control_handle {
-    user_data_t* user_data;
-    int target_hour;
-    int target_minute;
-    float target_angle;
-    bool initialized;  // 添加初始化标志字段
-} clock_control_handle_t;
-
-void step_motor_task(void *pvParameters);
-void initialise_wifi_task(void *pvParameters);
-void smartconfig_task(void *pvParameters);
-void motor_control_task(void *pvParameters);
-void clock_control_task(void *pvParameters); // 新增的时钟控制任务
-
-// 时钟控制句柄相关函数
-void clock_control_handler(clock_control_handle_t* handle);
-void set_clock_target_time(clock_control_handle_t* handle, int hour, int minute);
-clock_state_t get_clock_state(clock_control_handle_t* handle);
-
-#endif //FREERTOS_TASK_H
\ No newline at end of file
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+//
+// Created by jeong on 2025/5/27.
+//
+#ifndef FREERTOS_TASK_H
+#define FREERTOS_TASK_H
+
+#include "main.h"
+#include "esp_timer.h"
+#include "clock_status.h"
+#include "msg_bus.h"
+#include "time_source.h"
+
+// 添加时钟控制句柄结构体定义
+typedef struct clock_control_handle {
+    user_data_t* user_data;
+    int target_hour;
+    int target_minute;
+    float target_angle;
+    bool initialized;  // 添加初始化标志字段
+    esp_timer_handle_t minute_timer;  // 在下一个整分钟触发的单次定时器
+    msg_subscriber_t* bus;            // 整分钟、SNTP 同步和调整请求的订阅
+} clock_control_handle_t;
+
+void motor_control_task(void *pvParameters);
+void clock_control_task(void *pvParameters); // 新增的时钟控制任务
+
+// 当前最好的时间估计、来源和误差上限，可在任意任务中调用
+void clock_get_time_estimate(time_estimate_t* estimate);
+
+// 时钟与电机状态的一致快照，不加锁，可在任意任务、任意核心上高频调用
+void clock_get_status(clock_status_t* status);
+
+// 时钟控制句柄相关函数
+void clock_control_handler(clock_control_handle_t* handle);
+void set_clock_target_time(clock_control_handle_t* handle, int hour, int minute);
+clock_state_t get_clock_state(clock_control_handle_t* handle);
+
+#endif //FREERTOS_TASK_H
@@ -0,0 +1,223 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include "clock_logic.h"
+
+// 本地时间的时分秒
+void clock_time_from_epoch(time_t epoch, clock_time_t* ret_time)
+{
+    struct tm timeinfo;
+    localtime_r(&epoch, &timeinfo);
+    ret_time->hour = timeinfo.tm_hour;
+    ret_time->minute = timeinfo.tm_min;
+    ret_time->second = timeinfo.tm_sec;
+}
+
+// 将时间转换为角度的函数
+int32_t clock_time_to_arcsec(int hour, int minute)
+{
+    // 小时角度计算：每小时30度，每分钟0.5度
+    return ((hour % 12) * 60 + minute) * CLOCK_ARCSEC_PER_MINUTE;
+}
+
+// 将时间转换为绝对步数
+int32_t clock_time_to_step(int hour, int minute, int32_t steps_per_rev)
+{
+    int64_t minute_of_dial = (hour % 12) * 60 + minute;
+    return (int32_t)((minute_of_dial * steps_per_rev * 2 + 720) / (2 * 720));
+}
+
+// 表盘上的最短有符号步数
+int32_t clock_step_distance(int32_t from, int32_t to, int32_t steps_per_rev)
+{
+    int32_t diff = (to - from) % steps_per_rev;
+    if (diff > steps_per_rev / 2) {
+        diff -= steps_per_rev;
+    } else if (diff <= -steps_per_rev / 2) {
+        diff += steps_per_rev;
+    }
+    return diff;
+}
+
+// 预测落点：用估计的耗时推算到达时刻再重新取目标，目标所在分钟不再变化即收敛
+int32_t clock_catch_up_target(int64_t ms_of_day, int32_t from, int32_t steps_per_rev,
+                              clock_move_time_fn_t move_time, void* ctx, uint64_t* duration_us)
+{
+    int64_t arrive_ms = ms_of_day;
+    int32_t target = 0;
+    uint64_t duration = 0;
+    for (int pass = 0; pass < CLOCK_CATCH_UP_PASSES; pass++) {
+        int64_t minute_of_day = arrive_ms / 60000 % (24 * 60);
+        int32_t next_target = clock_time_to_step((int)(minute_of_day / 60), (int)(minute_of_day % 60), steps_per_rev);
+        if (pass && next_target == target) {
+            break;
+        }
+        target = next_target;
+        duration = move_time(from, target, ctx);
+        arrive_ms = ms_of_day + (int64_t)(duration / 1000);
+    }
+    if (duration_us) {
+        *duration_us = duration;
+    }
+    return target;
+}
+
+// 名义扫动间隔
+uint64_t clock_sweep_interval_q16(int32_t steps_per_rev)
+{
+    return ((uint64_t)CLOCK_US_PER_DIAL << 16) / (uint64_t)steps_per_rev;
+}
+
+// 理想位置：整数部分和余数分开算，避免 64 位溢出
+int64_t clock_sweep_ideal_q16(int64_t us_of_day, int32_t steps_per_rev)
+{
+    int64_t us = ((us_of_day % CLOCK_US_PER_DIAL) + CLOCK_US_PER_DIAL) % CLOCK_US_PER_DIAL;
+    int64_t scaled = us * steps_per_rev;
+    int64_t whole = scaled / CLOCK_US_PER_DIAL;
+    int64_t frac = (scaled % CLOCK_US_PER_DIAL) * 65536 / CLOCK_US_PER_DIAL;
+    return whole * 65536 + frac;
+}
+
+// Q16 的表盘最短距离
+int64_t clock_sweep_distance_q16(int64_t from_q16, int64_t to_q16, int32_t steps_per_rev)
+{
+    int64_t rev = (int64_t)steps_per_rev * 65536;
+    int64_t diff = (to_q16 - from_q16) % rev;
+    if (diff > rev / 2) {
+        diff -= rev;
+    } else if (diff <= -rev / 2) {
+        diff += rev;
+    }
+    return diff;
+}
+
+// 修正间隔：走快即缩短间隔
+uint64_t clock_sweep_trim_interval(uint64_t nominal_q16, int32_t ppb)
+{
+    return (uint64_t)((int64_t)nominal_q16 - (int64_t)nominal_q16 * ppb / 1000000000);
+}
+
+// 时间对应的绝对位置
+static int32_t clock_logic_target(const clock_logic_t* logic, const clock_time_t* time)
+{
+    return clock_time_to_step(time->hour, time->minute, logic->steps_per_rev);
+}
+
+// 指针离 target 是否远到算作时间跳变
+static bool clock_logic_jumped(const clock_logic_t* logic, int32_t target)
+{
+    int32_t distance = clock_step_distance(logic->ops->get_position(logic->ctx), target, logic->steps_per_rev);
+    return distance > CLOCK_CATCH_UP_MIN_STEPS || distance < -CLOCK_CATCH_UP_MIN_STEPS;
+}
+
+// 时间跳变后的追赶：以最高转速走最短路径，目标取预计到达时的时间，落点仍有偏差时再补走，
+// 直到指针与墙上时间一致；结束后立即提交日志
+static void clock_logic_catch_up(const clock_logic_t* logic, int32_t target)
+{
+    const clock_logic_ops_t* ops = logic->ops;
+    int32_t start = ops->get_position(logic->ctx);
+    int err = 0;
+    ops->move_begin(logic->ctx, CLOCK_MOVE_CATCH_UP, start, target);
+    for (int i = 0; i < CLOCK_CATCH_UP_MAX_MOVES; i++) {
+        int32_t from = ops->get_position(logic->ctx);
+        uint64_t predicted_us;
+        target = clock_catch_up_target(ops->wall_us_of_day(logic->ctx) / 1000, from, logic->steps_per_rev,
+                                       ops->catch_up_time, logic->ctx, &predicted_us);
+        if (!clock_step_distance(from, target, logic->steps_per_rev)) {
+            break;
+        }
+        err = ops->move_to(logic->ctx, CLOCK_MOVE_CATCH_UP, target, predicted_us);
+        if (err) {
+            break;
+        }
+    }
+    ops->move_end(logic->ctx, CLOCK_MOVE_CATCH_UP, start, target, err);
+    ops->journal(logic->ctx, true);
+}
+
+// 跟上墙上时间
+void clock_logic_follow_wall_time(const clock_logic_t* logic, const clock_time_t* now)
+{
+    const clock_logic_ops_t* ops = logic->ops;
+    int32_t target = clock_logic_target(logic, now);
+    if (clock_logic_jumped(logic, target)) {
+        clock_logic_catch_up(logic, target);
+        return;
+    }
+    int32_t from = ops->get_position(logic->ctx);
+    ops->move_begin(logic->ctx, CLOCK_MOVE_MINUTE, from, target);
+    int err = ops->move_to(logic->ctx, CLOCK_MOVE_MINUTE, target, 0);
+    if (!err) {
+        ops->journal(logic->ctx, false);
+    }
+    ops->move_end(logic->ctx, CLOCK_MOVE_MINUTE, from, target, err);
+}
+
+// 扫动模式的一次醒来
+void clock_logic_sweep_tick(const clock_logic_t* logic, const clock_time_t* now)
+{
+    const clock_logic_ops_t* ops = logic->ops;
+    if (ops->is_sweeping(logic->ctx)) {
+        if (ops->sweep_update(logic->ctx, ops->wall_us_of_day(logic->ctx))) {
+            // 扫动中每次醒来记一次，断电最多丢掉一分钟内走的几步
+            ops->journal(logic->ctx, false);
+            return;
+        }
+        ops->stop(logic->ctx);
+    }
+    int32_t target = clock_logic_target(logic, now);
+    if (clock_logic_jumped(logic, target)) {
+        clock_logic_catch_up(logic, target);
+    }
+    ops->sweep_start(logic->ctx, ops->wall_us_of_day(logic->ctx));
+}
+
+// 手动调整
+void clock_logic_adjust(const clock_logic_t* logic, const clock_time_t* target_time)
+{
+    const clock_logic_ops_t* ops = logic->ops;
+    // 扫动会拒绝其他运动
+    if (ops->is_sweeping(logic->ctx)) {
+        ops->stop(logic->ctx);
+    }
+    int32_t target = clock_logic_target(logic, target_time);
+    int32_t from = ops->get_position(logic->ctx);
+    ops->move_begin(logic->ctx, CLOCK_MOVE_ADJUST, from, target);
+    int err = ops->move_to(logic->ctx, CLOCK_MOVE_ADJUST, target, 0);
+    if (!err) {
+        ops->journal(logic->ctx, true);
+    }
+    ops->move_end(logic->ctx, CLOCK_MOVE_ADJUST, from, target, err);
+}
+
+// 启动
+void clock_logic_boot(const clock_logic_t* logic, const clock_time_t* now, bool trusted, bool restored)
+{
+    if (!trusted) {
+        return;
+    }
+    if (logic->sweep) {
+        // 不等第一个整分钟，上电即开始扫动
+        clock_logic_sweep_tick(logic, now);
+    } else if (restored) {
+        // 断电期间错过的分钟不等下一个整分钟，上电即补上
+        clock_logic_follow_wall_time(logic, now);
+    }
+}
+
+// 一次醒来
+void clock_logic_wake(const clock_logic_t* logic, const clock_time_t* old_time, const clock_time_t* now,
+                      bool was_trusted, bool trusted)
+{
+    if (!trusted) {
+        return;
+    }
+    if (logic->sweep) {
+        // 扫动模式没有分钟跳动，每次醒来只做鉴相和间隔修正
+        clock_logic_sweep_tick(logic, now);
+    } else if (now->minute != old_time->minute || now->hour != old_time->hour || !was_trusted) {
+        clock_logic_follow_wall_time(logic, now);
+    }
+}
@@ -0,0 +1,131 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef CLOCK_LOGIC_H
+#define CLOCK_LOGIC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 时钟换算逻辑，不依赖 FreeRTOS 和外设，固件与主机仿真共用
+
+// 添加时间结构体定义
+typedef struct {
+    int hour;
+    int minute;
+    int second;
+} clock_time_t;
+
+// 角度以角秒计，只用整数运算，时钟任务不会用到 FPU
+#define CLOCK_ARCSEC_PER_REV 1296000
+#define CLOCK_ARCSEC_PER_MINUTE (CLOCK_ARCSEC_PER_REV / 720)  // 每分钟 0.5 度
+
+// 追赶规划预测落点的最多迭代次数
+#define CLOCK_CATCH_UP_PASSES 4
+
+// 按本地时区把 Unix 时间换算成时分秒
+void clock_time_from_epoch(time_t epoch, clock_time_t* ret_time);
+
+// 将时间转换为表盘角度：每小时30度，每分钟0.5度
+int32_t clock_time_to_arcsec(int hour, int minute);
+
+// 时间对应的指针绝对位置：半日内的第几分钟按 steps_per_rev 精确换算并四舍五入，误差不会累积
+int32_t clock_time_to_step(int hour, int minute, int32_t steps_per_rev);
+
+// 表盘上从 from 到 to 的最短有符号步数，范围 (-steps_per_rev / 2, steps_per_rev / 2]
+int32_t clock_step_distance(int32_t from, int32_t to, int32_t steps_per_rev);
+
+// 估计从 from 步走到 to 步所需的时间（微秒）
+typedef uint64_t (*clock_move_time_fn_t)(int32_t from, int32_t to, void* ctx);
+
+// 追赶规划：目标取运动结束时的墙上时间而不是出发时的时间。
+// ms_of_day 为当天的毫秒数，返回目标步数并给出预计耗时
+int32_t clock_catch_up_target(int64_t ms_of_day, int32_t from, int32_t steps_per_rev,
+                              clock_move_time_fn_t move_time, void* ctx, uint64_t* duration_us);
+
+// 扫动模式：表盘 12 小时一圈，位置与间隔都用 Q16 定点，整除不尽的部分不会被舍掉
+#define CLOCK_US_PER_DIAL (12LL * 3600 * 1000000)
+
+// 一圈 steps_per_rev 步时的名义步进间隔（微秒，Q16）
+uint64_t clock_sweep_interval_q16(int32_t steps_per_rev);
+
+// 当天的墙上时间（微秒）对应的理想指针位置（步，Q16），范围 [0, steps_per_rev << 16)
+int64_t clock_sweep_ideal_q16(int64_t us_of_day, int32_t steps_per_rev);
+
+// Q16 位置在表盘上从 from 到 to 的最短有符号距离
+int64_t clock_sweep_distance_q16(int64_t from_q16, int64_t to_q16, int32_t steps_per_rev);
+
+// 按 ppb 修正步进间隔，正值走快
+uint64_t clock_sweep_trim_interval(uint64_t nominal_q16, int32_t ppb);
+
+// 时钟任务的决策：分钟跳动、时间跳变后的追赶、扫动的鉴相与重新对齐、指针停下后记日志和时间可信的门控。
+// 墙上时间、电机运动和位置日志都经由回调，固件的时钟任务与主机仿真执行同一套判定
+
+#define CLOCK_CATCH_UP_MIN_STEPS 12  // 偏差超过约两分钟视为时间跳变，走追赶规划
+#define CLOCK_CATCH_UP_MAX_MOVES 3   // 追赶时预测落点失准后最多补走的次数
+#define CLOCK_MINUTE_RPM 6           // 分钟跳动的转速，驱动方式取电机的默认方式
+#define CLOCK_ADJUST_RPM 30          // 手动调整的转速，双相整步，中断频率减半
+
+typedef enum {
+    CLOCK_MOVE_MINUTE,    // 分钟跳动
+    CLOCK_MOVE_CATCH_UP,  // 时间跳变后按最高转速双相整步追赶，可能分几段走
+    CLOCK_MOVE_ADJUST,    // 手动调整到目标时间
+} clock_move_kind_t;
+
+typedef struct {
+    // 当天的墙上时间（微秒）
+    int64_t (*wall_us_of_day)(void* ctx);
+    // 指针的绝对位置（半步）
+    int32_t (*get_position)(void* ctx);
+    // 一次运动开始和结束，追赶的几段合为一次；err 为最后一段的结果
+    void (*move_begin)(void* ctx, clock_move_kind_t kind, int32_t from, int32_t target);
+    void (*move_end)(void* ctx, clock_move_kind_t kind, int32_t from, int32_t target, int err);
+    // 走到 target 并等到停下，成功返回 0；predicted_us 为追赶规划预计的耗时，其他运动为 0
+    int (*move_to)(void* ctx, clock_move_kind_t kind, int32_t target, uint64_t predicted_us);
+    // 追赶规划用来估计一段运动的耗时
+    clock_move_time_fn_t catch_up_time;
+    // 指针停下后记入位置日志，force 时不等最短间隔
+    void (*journal)(void* ctx, bool force);
+    bool (*is_sweeping)(void* ctx);
+    void (*stop)(void* ctx);
+    // 扫动模式：用墙上时间更新锁相环并返回是否仍在锁定范围内；从墙上时间对应的位置开始扫动
+    bool (*sweep_update)(void* ctx, int64_t us_of_day);
+    void (*sweep_start)(void* ctx, int64_t us_of_day);
+} clock_logic_ops_t;
+
+typedef struct {
+    const clock_logic_ops_t* ops;
+    void* ctx;               // 传给每个回调
+    int32_t steps_per_rev;   // 半步计的每圈步数
+    bool sweep;              // 扫动模式，否则分钟跳动
+} clock_logic_t;
+
+// 按 now 算出绝对目标，丢步和漏掉的跳动在这一次里一并补上；偏差过大时走追赶规划
+void clock_logic_follow_wall_time(const clock_logic_t* logic, const clock_time_t* now);
+
+// 扫动模式的一次醒来：锁定范围内只修正间隔；否则停下，跳变较大先追赶，再从墙上时间对应的位置重新开始扫动
+void clock_logic_sweep_tick(const clock_logic_t* logic, const clock_time_t* now);
+
+// 手动调整：扫动中先停下，下一次醒来时再从墙上时间重新对齐
+void clock_logic_adjust(const clock_logic_t* logic, const clock_time_t* target);
+
+// 启动时：时间可信时扫动模式立即开始扫动，分钟跳动模式从日志恢复了位置时立即补上断电期间的分钟
+void clock_logic_boot(const clock_logic_t* logic, const clock_time_t* now, bool trusted, bool restored);
+
+// 时钟任务的一次醒来：时间不可信时指针停在原处；扫动模式每次都鉴相，分钟跳动模式在分钟变化或
+// 时间刚变为可信时跟上墙上时间，不会先按错误的时间走一遍
+void clock_logic_wake(const clock_logic_t* logic, const clock_time_t* old_time, const clock_time_t* now,
+                      bool was_trusted, bool trusted);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CLOCK_LOGIC_H
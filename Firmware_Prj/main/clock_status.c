@@ -0,0 +1,40 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "clock_status.h"
+
+void clock_status_init(clock_status_lock_t* lock)
+{
+    memset(&lock->status, 0, sizeof(lock->status));
+    portMUX_INITIALIZE(&lock->writer_lock);
+    atomic_init(&lock->seq, 0);
+}
+
+void clock_status_publish(clock_status_lock_t* lock, const clock_status_t* status)
+{
+    // 写一份快照只要几十个字节的拷贝，关中断期间完成，另一核心上的读者最多重读一次
+    taskENTER_CRITICAL(&lock->writer_lock);
+    unsigned seq = atomic_load_explicit(&lock->seq, memory_order_relaxed);
+    atomic_store_explicit(&lock->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy(&lock->status, status, sizeof(*status));
+    atomic_store_explicit(&lock->seq, seq + 2, memory_order_release);
+    taskEXIT_CRITICAL(&lock->writer_lock);
+}
+
+void clock_status_read(clock_status_lock_t* lock, clock_status_t* status)
+{
+    unsigned before;
+    unsigned after;
+    do {
+        before = atomic_load_explicit(&lock->seq, memory_order_acquire);
+        memcpy(status, &lock->status, sizeof(*status));
+        atomic_thread_fence(memory_order_acquire);
+        after = atomic_load_explicit(&lock->seq, memory_order_relaxed);
+    } while ((before & 1) || before != after);
+}
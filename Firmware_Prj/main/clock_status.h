@@ -0,0 +1,55 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef CLOCK_STATUS_H
+#define CLOCK_STATUS_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "main.h"
+#include "msg_bus.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 时钟与电机状态的快照，用顺序锁发布：只有时钟任务写，任意任务、任意核心都可以读，读者不加锁。
+// 写者先把序号加成奇数，写完再加成偶数；读者拷贝前后序号相同且为偶数才算一致，否则重读
+
+typedef struct {
+    clock_state_t state;
+    int32_t position;             // 指针的绝对位置（半步）
+    clock_time_t current_time;    // 指针应指的时间
+    clock_time_t target_time;     // 最近一次调整请求的目标
+    bool time_trusted;            // 时间来源是否可信，不可信时指针停住
+    uint32_t moves;               // 运动结束的次数，包括追赶和调整
+    msg_clock_moved_t last_move;  // 最近一次运动的结果
+    uint32_t move_time_ms;        // 所有运动的累计耗时
+    uint32_t catch_up_count;      // 时间跳变后的追赶次数
+    uint32_t catch_up_last_ms;    // 最近一次追赶耗时
+    uint32_t catch_up_max_ms;     // 最长一次追赶耗时
+} clock_status_t;
+
+typedef struct {
+    atomic_uint seq;           // 奇数表示正在写
+    portMUX_TYPE writer_lock;  // 只有写者使用，不会等待，只是不让同一核心上的读者打断写了一半的快照
+    clock_status_t status;
+} clock_status_lock_t;
+
+void clock_status_init(clock_status_lock_t* lock);
+
+// 发布新的快照，只能由唯一的写者调用，不阻塞
+void clock_status_publish(clock_status_lock_t* lock, const clock_status_t* status);
+
+// 读取一致的快照，不阻塞写者；与写者同时进行时重读，可在任意任务中调用
+void clock_status_read(clock_status_lock_t* lock, clock_status_t* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CLOCK_STATUS_H
@@ -0,0 +1,89 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include "clock_sweep.h"
+#include "clock_logic.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+
+#define SWEEP_TAG "CLOCK_SWEEP"
+
+// 误差每秒对应的速率修正：比例项约 600 秒把相位误差收掉，积分时间约 40 个更新周期，
+// 离散系统的两个极点都在 0.94~0.96，过阻尼不振荡
+#define SWEEP_KP_PPB_PER_US 1.667f
+#define SWEEP_KI_PPB_PER_US 0.0417f
+
+esp_err_t clock_sweep_init(clock_sweep_t* sweep, int32_t steps_per_rev)
+{
+    ESP_RETURN_ON_FALSE(sweep && steps_per_rev > 0, ESP_ERR_INVALID_ARG, SWEEP_TAG, "invalid argument");
+    const pid_batch_config_t config = {
+        .count = 1,
+        .gain_shift = 1,
+        .cal_type = PID_CAL_TYPE_POSITIONAL,
+    };
+    ESP_RETURN_ON_ERROR(pid_new_batch(&config, &sweep->pid), SWEEP_TAG, "create PID failed");
+    const pid_ctrl_parameter_t params = {
+        .kp = SWEEP_KP_PPB_PER_US,
+        .ki = SWEEP_KI_PPB_PER_US,
+        .kd = 0,
+        .max_output = CLOCK_SWEEP_MAX_TRIM_PPB,
+        .min_output = -CLOCK_SWEEP_MAX_TRIM_PPB,
+        // 积分项单独就能给出满量程修正，再多只会在大误差后超调
+        .max_integral = CLOCK_SWEEP_MAX_TRIM_PPB / SWEEP_KI_PPB_PER_US,
+        .min_integral = -CLOCK_SWEEP_MAX_TRIM_PPB / SWEEP_KI_PPB_PER_US,
+        .cal_type = PID_CAL_TYPE_POSITIONAL,
+    };
+    esp_err_t ret = pid_batch_update_parameters(sweep->pid, 0, &params);
+    if (ret != ESP_OK) {
+        pid_del_batch(sweep->pid);
+        return ret;
+    }
+    sweep->steps_per_rev = steps_per_rev;
+    sweep->nominal_q16 = clock_sweep_interval_q16(steps_per_rev);
+    sweep->trim_ppb = 0;
+    sweep->error_us = 0;
+    return ESP_OK;
+}
+
+esp_err_t clock_sweep_start(clock_sweep_t* sweep, motor_control_t* motor_control, int64_t us_of_day)
+{
+    ESP_RETURN_ON_FALSE(sweep && motor_control, ESP_ERR_INVALID_ARG, SWEEP_TAG, "invalid argument");
+    int64_t start_us = esp_timer_get_time();
+
+    // 先以分钟跳动的速度走到理想位置所在的整步，只有几步，耗时可以忽略
+    int32_t target = (int32_t)(clock_sweep_ideal_q16(us_of_day, sweep->steps_per_rev) >> 16);
+    if (clock_step_distance(stepper_get_position(motor_control), target, sweep->steps_per_rev)) {
+        stepper_move_handle_t move = stepper_move_to(motor_control, target, 6, STEPPER_DRIVE_HALF);
+        ESP_RETURN_ON_FALSE(move, ESP_ERR_INVALID_STATE, SWEEP_TAG, "positioning rejected");
+        ESP_RETURN_ON_ERROR(stepper_wait_move(motor_control, move, portMAX_DELAY), SWEEP_TAG, "positioning failed");
+    }
+
+    // 按走完后的时间算出到下一步还差多少，第一步就落在理想时刻上
+    us_of_day += esp_timer_get_time() - start_us;
+    uint64_t interval_q16 = clock_sweep_trim_interval(sweep->nominal_q16, sweep->trim_ppb);
+    int64_t ahead_q16 = clock_sweep_distance_q16(clock_sweep_ideal_q16(us_of_day, sweep->steps_per_rev),
+                                                 (int64_t)stepper_get_position(motor_control) * 65536,
+                                                 sweep->steps_per_rev);
+    int64_t delay_us = (int64_t)((65536 + ahead_q16) * (int64_t)(interval_q16 >> 16) / 65536);
+    return stepper_sweep_start(motor_control, interval_q16, delay_us > 1 ? (uint32_t)delay_us : 1, true);
+}
+
+int32_t clock_sweep_update(clock_sweep_t* sweep, motor_control_t* motor_control, int64_t us_of_day)
+{
+    int64_t error_q16 = clock_sweep_distance_q16(stepper_sweep_position_q16(motor_control),
+                                                 clock_sweep_ideal_q16(us_of_day, sweep->steps_per_rev),
+                                                 sweep->steps_per_rev);
+    int64_t error_us = error_q16 * (int64_t)(sweep->nominal_q16 >> 16) / 65536;
+    int32_t error = error_us > INT32_MAX ? INT32_MAX : error_us < INT32_MIN ? INT32_MIN : (int32_t)error_us;
+    sweep->error_us = error;
+
+    // 超出锁定范围时不更新控制器，积分项里的晶振误差估计保持不变，由调用者重新对齐
+    if (error > CLOCK_SWEEP_LOCK_RANGE_US || error < -CLOCK_SWEEP_LOCK_RANGE_US) {
+        return error;
+    }
+    pid_batch_compute(sweep->pid, &error, &sweep->trim_ppb);
+    stepper_sweep_set_interval(motor_control, clock_sweep_trim_interval(sweep->nominal_q16, sweep->trim_ppb));
+    return error;
+}
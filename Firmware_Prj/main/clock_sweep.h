@@ -0,0 +1,49 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef CLOCK_SWEEP_H
+#define CLOCK_SWEEP_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "pid_ctrl_batch.h"
+#include "step_motor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 扫动模式的锁相环：指针每 12 小时一圈连续走半步，每次更新比较指针的连续位置与墙上时间，
+// 由 PI 控制器修正步进间隔，吸收晶振误差和 SNTP 的平滑校时。固件与主机仿真共用
+
+// 更新周期按整分钟设计，增益以此换算
+#define CLOCK_SWEEP_UPDATE_PERIOD_S 60
+// 间隔修正上限（ppb），±0.5% 的速率变化在表盘上看不出来
+#define CLOCK_SWEEP_MAX_TRIM_PPB 5000000
+// 锁定范围：相位误差超过约两步时不再慢慢追，停下扫动重新对齐
+#define CLOCK_SWEEP_LOCK_RANGE_US 20000000
+
+typedef struct {
+    pid_batch_handle_t pid;     // 单个定点 PI 块：输入相位误差（微秒），输出速率修正（ppb）
+    int32_t steps_per_rev;      // 扫动所用驱动方式的每圈步数
+    uint64_t nominal_q16;       // 名义步进间隔（微秒，Q16）
+    int32_t trim_ppb;           // 当前速率修正，积分项包含晶振的长期误差
+    int32_t error_us;           // 最近一次的相位误差，正值表示指针落后
+} clock_sweep_t;
+
+// 创建 PI 控制器，steps_per_rev 取半步驱动的每圈步数
+esp_err_t clock_sweep_init(clock_sweep_t* sweep, int32_t steps_per_rev);
+
+// 把指针移到 us_of_day 对应的整步上，再对齐下一步的时刻开始扫动。电机须静止，积分项保留
+esp_err_t clock_sweep_start(clock_sweep_t* sweep, motor_control_t* motor_control, int64_t us_of_day);
+
+// 鉴相并修正间隔，返回相位误差（微秒）；超出 CLOCK_SWEEP_LOCK_RANGE_US 时不修正，由调用者停下扫动重新对齐
+int32_t clock_sweep_update(clock_sweep_t* sweep, motor_control_t* motor_control, int64_t us_of_day);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CLOCK_SWEEP_H
@@ -0,0 +1,294 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "esp_check.h"
+#include "esp_log.h"
+#include "binlog.h"
+#include "pid_ctrl.h"
+#include "clock_logic.h"
+#include "clock_status.h"
+#include "hot_bench.h"
+#ifdef ESP_PLATFORM
+#include "esp_cpu.h"
+#endif
+
+#define BENCH_TAG "HOT_BENCH"
+#define HOT_BENCH_BATCH 32        // 纯计算用例每个样本连续调用的次数，样本取每次的平均
+#define HOT_BENCH_ALARM_STEPS 64  // 步进中断用例每段运动的半步数
+#define HOT_BENCH_RPM 5           // 约 340 步/秒，低于回放门限，全部由步进中断输出
+#define HOT_BENCH_MAX_RESULTS 12
+
+typedef struct {
+    const char* name;
+    size_t count;
+    uint32_t median;
+    uint32_t p99;
+    uint32_t min;
+    uint32_t max;
+} hot_bench_result_t;
+
+typedef struct {
+    const hot_bench_port_t* port;
+    motor_control_t* motor_control;
+    uint32_t overhead;  // 连续两次计时之间的中位数
+    hot_bench_result_t results[HOT_BENCH_MAX_RESULTS];
+    size_t result_count;
+} hot_bench_t;
+
+static uint32_t s_samples[HOT_BENCH_SAMPLES];
+// 纯计算用例的结果写到这里，编译器不能把调用优化掉
+static volatile int32_t s_sink;
+
+static int hot_bench_cmp(const void* a, const void* b)
+{
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+// 排序后取中位数和 p99（最近秩），样本数为 0 时结果全为 0
+static void hot_bench_summarize(hot_bench_t* bench, const char* name, uint32_t* samples, size_t count)
+{
+    if (bench->result_count >= HOT_BENCH_MAX_RESULTS) {
+        return;
+    }
+    hot_bench_result_t* result = &bench->results[bench->result_count++];
+    *result = (hot_bench_result_t) {.name = name, .count = count};
+    if (!count) {
+        return;
+    }
+    qsort(samples, count, sizeof(uint32_t), hot_bench_cmp);
+    result->median = samples[count / 2];
+    result->p99 = samples[(count * 99 + 99) / 100 - 1];
+    result->min = samples[0];
+    result->max = samples[count - 1];
+}
+
+// 扣除计时开销，批量用例再除以每个样本的调用次数
+static uint32_t hot_bench_sample(const hot_bench_t* bench, uint32_t start, uint32_t end, uint32_t batch)
+{
+    uint32_t elapsed = end - start;
+    return (elapsed > bench->overhead ? elapsed - bench->overhead : 0) / batch;
+}
+
+static void hot_bench_calibrate(hot_bench_t* bench)
+{
+    uint32_t (*now)(void) = bench->port->now;
+    for (size_t i = 0; i < HOT_BENCH_SAMPLES; i++) {
+        uint32_t start = now();
+        s_samples[i] = now() - start;
+    }
+    qsort(s_samples, HOT_BENCH_SAMPLES, sizeof(uint32_t), hot_bench_cmp);
+    bench->overhead = s_samples[HOT_BENCH_SAMPLES / 2];
+}
+
+// 电机在两个位置之间往返，由平台收集每次步进中断服务的耗时
+static void hot_bench_alarm(hot_bench_t* bench, int32_t home)
+{
+    size_t count = 0;
+    bool away = true;
+    while (count < HOT_BENCH_SAMPLES) {
+        bench->port->alarm_begin(bench->motor_control);
+        stepper_move_handle_t move = stepper_move_to(bench->motor_control, away ? home + HOT_BENCH_ALARM_STEPS : home,
+                                                     HOT_BENCH_RPM, STEPPER_DRIVE_HALF);
+        if (!move || stepper_wait_move(bench->motor_control, move, portMAX_DELAY) != ESP_OK) {
+            break;
+        }
+        size_t got = bench->port->alarm_end(bench->motor_control, &s_samples[count], HOT_BENCH_SAMPLES - count);
+        if (!got) {
+            break;
+        }
+        count += got;
+        away = !away;
+    }
+    hot_bench_summarize(bench, "stepper_alarm_cb", s_samples, count);
+}
+
+// 运动提交：每次都从静止提交，计时后立即停下，提交时启动定时器的开销也计在内
+static void hot_bench_submit(hot_bench_t* bench)
+{
+    uint32_t (*now)(void) = bench->port->now;
+    motor_control_t* motor_control = bench->motor_control;
+
+    for (size_t i = 0; i < HOT_BENCH_SAMPLES; i++) {
+        uint32_t start = now();
+        stepper_set_time(motor_control, 8, i & 1, 2000);
+        s_samples[i] = hot_bench_sample(bench, start, now(), 1);
+        stepper_stop(motor_control);
+    }
+    hot_bench_summarize(bench, "stepper_set_time", s_samples, HOT_BENCH_SAMPLES);
+
+    for (size_t i = 0; i < HOT_BENCH_SAMPLES; i++) {
+        uint32_t start = now();
+        stepper_rotate_angle(motor_control, 1.0f, i & 1, HOT_BENCH_RPM);
+        s_samples[i] = hot_bench_sample(bench, start, now(), 1);
+        stepper_stop(motor_control);
+    }
+    hot_bench_summarize(bench, "stepper_rotate_angle", s_samples, HOT_BENCH_SAMPLES);
+
+    for (size_t i = 0; i < HOT_BENCH_SAMPLES; i++) {
+        uint32_t start = now();
+        stepper_rotate_to_angle(motor_control, (float)(i * 7 % 360), HOT_BENCH_RPM);
+        s_samples[i] = hot_bench_sample(bench, start, now(), 1);
+        stepper_stop(motor_control);
+    }
+    hot_bench_summarize(bench, "stepper_rotate_to_angle", s_samples, HOT_BENCH_SAMPLES);
+}
+
+static void hot_bench_clock(hot_bench_t* bench)
+{
+    uint32_t (*now)(void) = bench->port->now;
+    int32_t steps_per_rev = stepper_steps_per_rev(STEPPER_DRIVE_HALF);
+
+    for (size_t i = 0; i < HOT_BENCH_SAMPLES; i++) {
+        int32_t acc = 0;
+        uint32_t start = now();
+        for (int j = 0; j < HOT_BENCH_BATCH; j++) {
+            acc += clock_time_to_arcsec(j % 24, (int)(i + j) % 60);
+        }
+        s_samples[i] = hot_bench_sample(bench, start, now(), HOT_BENCH_BATCH);
+        s_sink = acc;
+    }
+    hot_bench_summarize(bench, "clock_time_to_arcsec", s_samples, HOT_BENCH_SAMPLES);
+
+    for (size_t i = 0; i < HOT_BENCH_SAMPLES; i++) {
+        int32_t acc = 0;
+        uint32_t start = now();
+        for (int j = 0; j < HOT_BENCH_BATCH; j++) {
+            acc += clock_time_to_step(j % 24, (int)(i + j) % 60, steps_per_rev);
+        }
+        s_samples[i] = hot_bench_sample(bench, start, now(), HOT_BENCH_BATCH);
+        s_sink = acc;
+    }
+    hot_bench_summarize(bench, "clock_time_to_step", s_samples, HOT_BENCH_SAMPLES);
+
+    // 与时钟任务的 update_clock_time() 相同的工作：换算本地时间、写二进制日志、发布状态快照
+    static clock_status_lock_t lock;
+    clock_status_t status = {0};
+    clock_status_init(&lock);
+    for (size_t i = 0; i < HOT_BENCH_SAMPLES; i++) {
+        uint32_t start = now();
+        clock_time_from_epoch(time(NULL), &status.current_time);
+        BINLOG(CLOCK_TIME, status.current_time.hour, status.current_time.minute, status.current_time.second);
+        clock_status_publish(&lock, &status);
+        s_samples[i] = hot_bench_sample(bench, start, now(), 1);
+    }
+    hot_bench_summarize(bench, "update_clock_time", s_samples, HOT_BENCH_SAMPLES);
+
+    for (size_t i = 0; i < HOT_BENCH_SAMPLES; i++) {
+        uint32_t start = now();
+        for (int j = 0; j < HOT_BENCH_BATCH; j++) {
+            clock_status_read(&lock, &status);
+        }
+        s_samples[i] = hot_bench_sample(bench, start, now(), HOT_BENCH_BATCH);
+        s_sink = status.position;
+    }
+    hot_bench_summarize(bench, "clock_status_read", s_samples, HOT_BENCH_SAMPLES);
+}
+
+static esp_err_t hot_bench_pid(hot_bench_t* bench, pid_calculate_type_t cal_type, const char* name)
+{
+    uint32_t (*now)(void) = bench->port->now;
+    const pid_ctrl_config_t config = {
+        .init_param = {
+            .kp = 2.0f,
+            .ki = 0.1f,
+            .kd = 0.5f,
+            .max_output = 100.0f,
+            .min_output = -100.0f,
+            .max_integral = 50.0f,
+            .min_integral = -50.0f,
+            .cal_type = cal_type,
+        },
+    };
+    pid_ctrl_block_handle_t pid;
+    ESP_RETURN_ON_ERROR(pid_new_control_block(&config, &pid), BENCH_TAG, "create PID block failed");
+
+    for (size_t i = 0; i < HOT_BENCH_SAMPLES; i++) {
+        float output = 0;
+        uint32_t start = now();
+        for (int j = 0; j < HOT_BENCH_BATCH; j++) {
+            // 误差在正负之间往返，积分和输出都会碰到限幅
+            pid_compute(pid, (float)((int)((i * HOT_BENCH_BATCH + j) % 64) - 32), &output);
+        }
+        s_samples[i] = hot_bench_sample(bench, start, now(), HOT_BENCH_BATCH);
+        s_sink = (int32_t)output;
+    }
+    hot_bench_summarize(bench, name, s_samples, HOT_BENCH_SAMPLES);
+    return pid_del_control_block(pid);
+}
+
+static void hot_bench_print(const hot_bench_t* bench)
+{
+    printf("{\"bench\":\"hot_path\",\"platform\":\"%s\",\"unit\":\"%s\",\"overhead\":%u,\"results\":[",
+           bench->port->platform, bench->port->unit, (unsigned)bench->overhead);
+    for (size_t i = 0; i < bench->result_count; i++) {
+        const hot_bench_result_t* result = &bench->results[i];
+        printf("%s{\"name\":\"%s\",\"samples\":%u,\"median\":%u,\"p99\":%u,\"min\":%u,\"max\":%u}",
+               i ? "," : "", result->name, (unsigned)result->count, (unsigned)result->median,
+               (unsigned)result->p99, (unsigned)result->min, (unsigned)result->max);
+    }
+    printf("]}\n");
+    fflush(stdout);
+}
+
+esp_err_t hot_bench_run(motor_control_t* motor_control, const hot_bench_port_t* port)
+{
+    ESP_RETURN_ON_FALSE(motor_control && port && port->now && port->alarm_begin && port->alarm_end,
+                        ESP_ERR_INVALID_ARG, BENCH_TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(!stepper_is_moving(motor_control), ESP_ERR_INVALID_STATE, BENCH_TAG, "motor is moving");
+
+    static hot_bench_t bench;
+    bench = (hot_bench_t) {.port = port, .motor_control = motor_control};
+    int32_t home = stepper_get_position(motor_control);
+
+    hot_bench_calibrate(&bench);
+    hot_bench_alarm(&bench, home);
+    hot_bench_submit(&bench);
+    hot_bench_clock(&bench);
+    ESP_RETURN_ON_ERROR(hot_bench_pid(&bench, PID_CAL_TYPE_POSITIONAL, "pid_compute_positional"), BENCH_TAG,
+                        "positional PID failed");
+    ESP_RETURN_ON_ERROR(hot_bench_pid(&bench, PID_CAL_TYPE_INCREMENTAL, "pid_compute_incremental"), BENCH_TAG,
+                        "incremental PID failed");
+
+    // 提交用例停下时可能已经走了几步，回到开始时的位置
+    stepper_move_handle_t move = stepper_move_to(motor_control, home, HOT_BENCH_RPM, STEPPER_DRIVE_HALF);
+    if (move) {
+        ESP_RETURN_ON_ERROR(stepper_wait_move(motor_control, move, portMAX_DELAY), BENCH_TAG, "return move failed");
+    }
+    hot_bench_print(&bench);
+    return ESP_OK;
+}
+
+#ifdef ESP_PLATFORM
+static uint32_t hot_bench_target_now(void)
+{
+    return esp_cpu_get_cycle_count();
+}
+
+static void hot_bench_target_alarm_begin(motor_control_t* motor_control)
+{
+    stepper_reset_isr_stats(motor_control);
+}
+
+// 步进中断统计保留最近 STEPPER_ISR_CYCLE_SAMPLES 次服务，HOT_BENCH_ALARM_STEPS 步的运动放得下
+static size_t hot_bench_target_alarm_end(motor_control_t* motor_control, uint32_t* samples, size_t capacity)
+{
+    size_t count = 0;
+    return stepper_get_isr_cycles(motor_control, samples, capacity, &count) == ESP_OK ? count : 0;
+}
+
+const hot_bench_port_t hot_bench_target_port = {
+    .platform = CONFIG_IDF_TARGET,
+    .unit = "cycles",
+    .now = hot_bench_target_now,
+    .alarm_begin = hot_bench_target_alarm_begin,
+    .alarm_end = hot_bench_target_alarm_end,
+};
+#endif
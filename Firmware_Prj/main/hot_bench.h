@@ -0,0 +1,46 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef HOT_BENCH_H
+#define HOT_BENCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "step_motor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 热路径微基准：步进中断、运动提交、时间换算、状态快照和 PID，固件与主机共用同一组用例。
+// 每个用例取 HOT_BENCH_SAMPLES 个样本，结果以一行 JSON 输出中位数和 p99，
+// 固件上单位是 CPU 周期，主机上是纳秒。计时本身的开销已从每个样本中扣除
+
+#define HOT_BENCH_SAMPLES 256
+
+// 平台相关的部分
+typedef struct {
+    const char* platform;  // 输出中的平台名
+    const char* unit;      // 样本单位
+    uint32_t (*now)(void); // 计时，差值按无符号回绕计算
+    // 步进中断的执行时间不能在任务里直接测：运动开始前调用 alarm_begin，运动结束后由 alarm_end
+    // 取出这段运动中每次服务的耗时，返回取到的个数
+    void (*alarm_begin)(motor_control_t* motor_control);
+    size_t (*alarm_end)(motor_control_t* motor_control, uint32_t* samples, size_t capacity);
+} hot_bench_port_t;
+
+// 依次运行全部用例并把结果写到标准输出。电机要静止，结束时回到原来的位置
+esp_err_t hot_bench_run(motor_control_t* motor_control, const hot_bench_port_t* port);
+
+#ifdef ESP_PLATFORM
+// 用 CPU 周期计数器和步进中断统计计时
+extern const hot_bench_port_t hot_bench_target_port;
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //HOT_BENCH_H
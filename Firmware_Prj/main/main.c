@@ -1,44 +1,162 @@
-/*
- * SPDX-FileCopyrightText: 2010-2022 Espressif Systems (Shanghai) CO LTD
- *
- * SPDX-License-Identifier: CC0-1.0
- */
-/*
- * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
- *
- * SPDX-License-Identifier: Apache-2.0
- */
-
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
-#include "esp_log.h"
-#include "FreeRTOS_task.h"
-#include "main.h"
-
-char *TAG = "app_main";
-
-_Noreturn void app_main(void)
-{
-    TaskHandle_t motor_task_handle = NULL;
-    TaskHandle_t motor_control_task_handle = NULL;
-    TaskHandle_t clock_control_task_handle = NULL; // 新增的时钟控制任务句柄
-
-    user_data_t cb_user_data = {
-        .all_event = xEventGroupCreate(),
-        .motor_control = 0,
-        .clock_state = CLOCK_STATE_IDLE,
-        .watchdog_enabled = false, // 初始禁用看门狗
-    };
-    
-    xEventGroupClearBits(cb_user_data.all_event, 0xff);
-
-    xTaskCreatePinnedToCore(step_motor_task, "step_motor", 4096, &cb_user_data, 0, &motor_task_handle,0);
-    vTaskDelay(pdMS_TO_TICKS(1000));
-    xTaskCreatePinnedToCore(motor_control_task, "motor_control", 4096, &cb_user_data, 0, &motor_control_task_handle, tskNO_AFFINITY);
-    xTaskCreatePinnedToCore(clock_control_task, "clock_control", 4096, &cb_user_data, 1, &clock_control_task_handle, tskNO_AFFINITY);
-    while (1)
-    {
-        ESP_LOGI(TAG, "Main task running");
-        vTaskDelay(pdMS_TO_TICKS(2000));
-    }
+/*
+ * SPDX-FileCopyrightText: 2010-2022 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: CC0-1.0
+ */
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "nvs_flash.h"
+#include "binlog.h"
+#include "FreeRTOS_task.h"
+#include "hot_bench.h"
+#include "main.h"
+#include "msg_bus.h"
+#include "power_save.h"
+#include "telemetry.h"
+#include "wifi_conn.h"
+
+// 主任务打印统计信息的周期
+#define STATS_INTERVAL_MS (5 * 60 * 1000)
+
+char *TAG = "app_main";
+
+// 统计中 -1 表示还没有发生，原样打印
+static int64_t stats_us_to_ms(int64_t us)
+{
+    return us < 0 ? -1 : us / 1000;
+}
+
+_Noreturn void app_main(void)
+{
+    TaskHandle_t motor_control_task_handle = NULL;
+    TaskHandle_t clock_control_task_handle = NULL; // 新增的时钟控制任务句柄
+
+    user_data_t cb_user_data = {
+        .motor_control = 0,
+        .clock_state = CLOCK_STATE_IDLE,
+        .watchdog_enabled = false, // 初始禁用看门狗
+    };
+
+    // 主任务只在打印统计时查看 Wi-Fi 状态，从不等待，发布时不会被唤醒
+    msg_subscriber_t* stats_sub = NULL;
+    ESP_ERROR_CHECK(msg_bus_subscribe(MSG_TOPIC_BIT(MSG_TOPIC_WIFI_STATE), &stats_sub));
+    msg_payload_t wifi_state = {0};
+
+    // 时区在联网前就设置，断电恢复按本地时间换算指针位置
+    setenv("TZ", "EST-8", 1);
+    tzset();
+
+    // 热路径上的日志写入二进制环形缓冲，由低优先级任务在之后格式化输出
+    if (binlog_init() != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Binary log drain task not started");
+    }
+
+    if (power_save_init() != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Automatic light sleep disabled");
+    }
+
+    // 指针位置日志存在 NVS 中，分区已满或格式版本变化时按 IDF 的惯例擦除后重新初始化
+    esp_err_t ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND)
+    {
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        ret = nvs_flash_init();
+    }
+    const pos_journal_config_t journal_config = POS_JOURNAL_DEFAULT_CONFIG();
+    if (ret != ESP_OK || pos_journal_new(&journal_config, &cb_user_data.pos_journal) != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Position journal disabled, the hand is assumed to show the current time at boot");
+    }
+
+    // 命令由步进中断直接从环形缓冲取出，不需要单独的电机任务
+    cb_user_data.motor_control = stepper_driver_init();
+#if CONFIG_HOLLOW_CLOCK_BENCH
+    // 在时钟任务启动前运行热路径微基准，结果以一行 JSON 打印到控制台
+    if (cb_user_data.motor_control && hot_bench_run(cb_user_data.motor_control, &hot_bench_target_port) != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Hot path benchmark failed");
+    }
+#endif
+    if (cb_user_data.motor_control)
+    {
+#if CONFIG_HOLLOW_CLOCK_MOTOR_DEMO
+        xTaskCreatePinnedToCore(motor_control_task, "motor_control", 4096, &cb_user_data, 0, &motor_control_task_handle, tskNO_AFFINITY);
+#else
+        (void)motor_control_task_handle;
+#endif
+        xTaskCreatePinnedToCore(clock_control_task, "clock_control", 4096, &cb_user_data, 1, &clock_control_task_handle, tskNO_AFFINITY);
+    }
+    else
+    {
+        // 没有电机驱动时不启动时钟任务，其余部分照常运行以便通过日志和统计排查
+        ESP_LOGE(TAG, "Stepper driver init failed, clock task not started");
+    }
+#if CONFIG_HOLLOW_CLOCK_TELEMETRY
+    // 各任务的 CPU 占比和栈余量以二进制记录输出到控制台，由 telemetry_decode 解码
+    if (telemetry_start(cb_user_data.motor_control) != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Telemetry not started");
+    }
+#endif
+
+    // 连接与重连都由事件驱动，不需要单独的任务；SNTP 同步经 msg_bus 通知时钟任务
+    bool wifi_started = ret == ESP_OK && wifi_conn_start() == ESP_OK;
+    if (!wifi_started)
+    {
+        ESP_LOGW(TAG, "Wi-Fi not started, the clock runs on its own crystal");
+    }
+    while (1)
+    {
+        // 主任务只定期打印统计，其余时间不唤醒系统
+        vTaskDelay(pdMS_TO_TICKS(STATS_INTERVAL_MS));
+        power_save_log_stats();
+        // 时钟状态从快照读取，不会与时钟任务的写入交错
+        clock_status_t clock_status;
+        clock_get_status(&clock_status);
+        ESP_LOGI(TAG, "Clock: %02d:%02d, position %"PRId32", %"PRIu32" moves, time %s",
+                 clock_status.current_time.hour, clock_status.current_time.minute, clock_status.position,
+                 clock_status.moves, clock_status.time_trusted ? "trusted" : "not trusted");
+        ESP_LOGI(TAG, "Catch-up: %"PRIu32" runs, last %"PRIu32" ms, longest %"PRIu32" ms",
+                 clock_status.catch_up_count, clock_status.catch_up_last_ms, clock_status.catch_up_max_ms);
+        time_estimate_t time_estimate;
+        clock_get_time_estimate(&time_estimate);
+        ESP_LOGI(TAG, "Time: source %s, uncertainty %"PRIu32" ms, %s", time_source_name(time_estimate.source),
+                 time_estimate.uncertainty_ms, time_estimate.trusted ? "trusted" : "not trusted");
+        if (clock_status.moves)
+        {
+            ESP_LOGI(TAG, "Last move: %"PRId32" -> %"PRId32", stopped at %"PRId32" in %"PRIu32" ms (%s)",
+                     clock_status.last_move.from, clock_status.last_move.target, clock_status.last_move.position,
+                     clock_status.last_move.elapsed_ms, esp_err_to_name(clock_status.last_move.err));
+        }
+        if (wifi_started)
+        {
+            wifi_rc_stats_t wifi_stats;
+            wifi_conn_get_stats(&wifi_stats);
+            msg_bus_take(stats_sub, MSG_TOPIC_WIFI_STATE, &wifi_state);
+            ESP_LOGI(TAG, "Wi-Fi %s: %"PRIu32" connects, %"PRIu32" drops, %"PRIu32" attempts (%"PRIu32" fast), "
+                     "time to IP last %"PRId64" ms, longest %"PRId64" ms, boot to IP %"PRId64" ms, boot to SNTP %"PRId64" ms",
+                     wifi_state.wifi_state.connected ? "connected" : "disconnected",
+                     wifi_stats.connects, wifi_stats.drops, wifi_stats.attempts, wifi_stats.fast_attempts,
+                     stats_us_to_ms(wifi_stats.last_time_to_ip_us), stats_us_to_ms(wifi_stats.max_time_to_ip_us),
+                     stats_us_to_ms(wifi_stats.boot_to_ip_us), stats_us_to_ms(wifi_stats.boot_to_sync_us));
+        }
+#if CONFIG_STEP_MOTOR_ISR_STATS
+        if (cb_user_data.motor_control)
+        {
+            stepper_dump_isr_stats(cb_user_data.motor_control);
+        }
+#endif
+    }
 }
\ No newline at end of file
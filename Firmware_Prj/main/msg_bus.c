@@ -0,0 +1,107 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "msg_bus.h"
+
+struct msg_subscriber {
+    uint32_t topics;                       // 订阅的主题位
+    uint32_t pending;                      // 有新消息还没取走的主题位
+    TaskHandle_t task;                     // 最近一次等待的任务，没有等待过时为 NULL
+    msg_payload_t latest[MSG_TOPIC_COUNT]; // 每个主题最新的一条消息
+};
+
+static msg_subscriber_t s_subscribers[MSG_BUS_MAX_SUBSCRIBERS];
+static int s_subscriber_count;
+static portMUX_TYPE s_bus_lock = portMUX_INITIALIZER_UNLOCKED;
+
+esp_err_t msg_bus_subscribe(uint32_t topics, msg_subscriber_t** ret_sub)
+{
+    if (!topics || !ret_sub) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    taskENTER_CRITICAL(&s_bus_lock);
+    msg_subscriber_t* sub = NULL;
+    if (s_subscriber_count < MSG_BUS_MAX_SUBSCRIBERS) {
+        sub = &s_subscribers[s_subscriber_count++];
+        memset(sub, 0, sizeof(*sub));
+        sub->topics = topics;
+    }
+    taskEXIT_CRITICAL(&s_bus_lock);
+    *ret_sub = sub;
+    return sub ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+void msg_bus_publish(msg_topic_t topic, const msg_payload_t* payload)
+{
+    if (topic >= MSG_TOPIC_COUNT) {
+        return;
+    }
+    uint32_t bit = MSG_TOPIC_BIT(topic);
+    TaskHandle_t notify[MSG_BUS_MAX_SUBSCRIBERS];
+    int notify_count = 0;
+
+    taskENTER_CRITICAL(&s_bus_lock);
+    for (int i = 0; i < s_subscriber_count; i++) {
+        msg_subscriber_t* sub = &s_subscribers[i];
+        if (!(sub->topics & bit)) {
+            continue;
+        }
+        if (payload) {
+            sub->latest[topic] = *payload;
+        } else {
+            memset(&sub->latest[topic], 0, sizeof(sub->latest[topic]));
+        }
+        sub->pending |= bit;
+        if (sub->task) {
+            notify[notify_count++] = sub->task;
+        }
+    }
+    taskEXIT_CRITICAL(&s_bus_lock);
+
+    // 通知放在锁外，被唤醒的任务不会马上撞上这把锁
+    for (int i = 0; i < notify_count; i++) {
+        xTaskNotifyIndexed(notify[i], MSG_BUS_NOTIFY_INDEX, bit, eSetBits);
+    }
+}
+
+uint32_t msg_bus_wait(msg_subscriber_t* sub, TickType_t timeout)
+{
+    TimeOut_t time_out;
+    vTaskSetTimeOutState(&time_out);
+    while (1) {
+        taskENTER_CRITICAL(&s_bus_lock);
+        if (timeout) {
+            sub->task = xTaskGetCurrentTaskHandle();
+        }
+        uint32_t pending = sub->pending;
+        taskEXIT_CRITICAL(&s_bus_lock);
+        if (pending || !timeout || xTaskCheckForTimeOut(&time_out, &timeout) != pdFALSE) {
+            return pending;
+        }
+        // 通知值只用来唤醒，是否有消息以 pending 为准：之前已取走的消息留下的通知会让这里多醒一次
+        xTaskNotifyWaitIndexed(MSG_BUS_NOTIFY_INDEX, 0, UINT32_MAX, NULL, timeout);
+    }
+}
+
+bool msg_bus_take(msg_subscriber_t* sub, msg_topic_t topic, msg_payload_t* payload)
+{
+    if (topic >= MSG_TOPIC_COUNT) {
+        return false;
+    }
+    uint32_t bit = MSG_TOPIC_BIT(topic);
+    taskENTER_CRITICAL(&s_bus_lock);
+    bool taken = sub->pending & bit;
+    if (taken) {
+        sub->pending &= ~bit;
+        if (payload) {
+            *payload = sub->latest[topic];
+        }
+    }
+    taskEXIT_CRITICAL(&s_bus_lock);
+    return taken;
+}
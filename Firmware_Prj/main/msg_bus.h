@@ -0,0 +1,82 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef MSG_BUS_H
+#define MSG_BUS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "clock_logic.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 按主题分发的消息总线，代替各子系统共用的事件组。订阅表是静态的，启动时登记；
+// 每个订阅者每个主题只保留最新的一条消息，发布时只通知订阅了该主题且正在等待的任务，
+// 通知用任务通知的第 MSG_BUS_NOTIFY_INDEX 个值。不订阅的主题不会唤醒任务
+
+#define MSG_BUS_MAX_SUBSCRIBERS 4
+// 步进驱动用第 1 个通知值等待运动结束，总线用第 0 个
+#define MSG_BUS_NOTIFY_INDEX 0
+
+typedef enum {
+    MSG_TOPIC_MINUTE_TICK,  // 整分钟定时器到期，没有负载
+    MSG_TOPIC_TIME_SYNC,    // SNTP 同步或校正，负载 time_sync
+    MSG_TOPIC_ADJUST_TIME,  // 请求把指针调到某个时间，负载 adjust_time
+    MSG_TOPIC_CLOCK_MOVED,  // 指针的一次运动结束，负载 clock_moved
+    MSG_TOPIC_WIFI_STATE,   // 获取 IP 或断开，负载 wifi_state
+    MSG_TOPIC_COUNT,
+} msg_topic_t;
+
+#define MSG_TOPIC_BIT(topic) (1UL << (topic))
+
+typedef struct {
+    int64_t epoch_us;  // 服务器给出的 Unix 时间
+    int64_t mono_us;   // 收到应答时的 esp_timer 时间，处理晚了也能按这个时刻锚定
+} msg_time_sync_t;
+
+typedef struct {
+    int32_t from;         // 运动开始时的绝对位置
+    int32_t target;       // 目标位置
+    int32_t position;     // 结束时的位置
+    esp_err_t err;        // 等待运动的结果
+    uint32_t elapsed_ms;  // 运动耗时
+} msg_clock_moved_t;
+
+typedef struct {
+    bool connected;
+    int64_t time_to_ip_us;  // 本次从开始连接或断开到获取 IP 的时间，断开时为 -1
+} msg_wifi_state_t;
+
+typedef union {
+    msg_time_sync_t time_sync;
+    clock_time_t adjust_time;
+    msg_clock_moved_t clock_moved;
+    msg_wifi_state_t wifi_state;
+} msg_payload_t;
+
+typedef struct msg_subscriber msg_subscriber_t;
+
+// 登记一个订阅者，topics 为 MSG_TOPIC_BIT 的组合。在发布者启动前调用；订阅表满时返回 ESP_ERR_NO_MEM
+esp_err_t msg_bus_subscribe(uint32_t topics, msg_subscriber_t** ret_sub);
+
+// 发布一条消息，payload 可为 NULL（负载清零）。可在任务和 esp_timer 回调中调用，不能在中断中调用
+void msg_bus_publish(msg_topic_t topic, const msg_payload_t* payload);
+
+// 等待任一订阅的主题有新消息，返回有新消息的主题位，超时返回 0。调用的任务成为此后被通知的任务；
+// 只查看不等待的订阅者（timeout 为 0）不会被通知
+uint32_t msg_bus_wait(msg_subscriber_t* sub, TickType_t timeout);
+
+// 取走某个主题最新的一条消息，没有新消息时返回 false；payload 可为 NULL
+bool msg_bus_take(msg_subscriber_t* sub, msg_topic_t topic, msg_payload_t* payload);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //MSG_BUS_H
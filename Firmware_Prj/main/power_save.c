@@ -0,0 +1,78 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include "power_save.h"
+#include <inttypes.h>
+#include "esp_attr.h"
+#include "esp_check.h"
+#include "esp_log.h"
+#include "esp_pm.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "sdkconfig.h"
+
+#define POWER_TAG "POWER"
+
+static portMUX_TYPE power_spinlock = portMUX_INITIALIZER_UNLOCKED;
+static int64_t sleep_time_total_us;
+static uint32_t sleep_count;
+
+#if CONFIG_HOLLOW_CLOCK_POWER_SAVE && CONFIG_PM_LIGHT_SLEEP_CALLBACKS
+/* 浅睡眠唤醒回调，在睡眠流程中关中断执行，只做累加 */
+static esp_err_t IRAM_ATTR power_save_on_wakeup(int64_t sleep_time_us, void* arg)
+{
+    portENTER_CRITICAL_ISR(&power_spinlock);
+    sleep_time_total_us += sleep_time_us;
+    sleep_count++;
+    portEXIT_CRITICAL_ISR(&power_spinlock);
+    return ESP_OK;
+}
+#endif
+
+/* 启用动态调频与自动浅睡眠，空闲时由 tickless idle 睡到下一个定时事件 */
+esp_err_t power_save_init(void)
+{
+#if CONFIG_HOLLOW_CLOCK_POWER_SAVE
+    esp_pm_config_t pm_config = {
+        .max_freq_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+        .min_freq_mhz = CONFIG_XTAL_FREQ,
+        .light_sleep_enable = true,
+    };
+    ESP_RETURN_ON_ERROR(esp_pm_configure(&pm_config), POWER_TAG, "failed to configure power management");
+
+#if CONFIG_PM_LIGHT_SLEEP_CALLBACKS
+    esp_pm_sleep_cbs_register_config_t sleep_cbs = {
+        .exit_cb = power_save_on_wakeup,
+    };
+    ESP_RETURN_ON_ERROR(esp_pm_light_sleep_register_cbs(&sleep_cbs), POWER_TAG, "failed to register sleep callback");
+#endif
+
+    ESP_LOGI(POWER_TAG, "Automatic light sleep enabled, %d-%d MHz", pm_config.min_freq_mhz, pm_config.max_freq_mhz);
+    return ESP_OK;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+/* 读取睡眠统计 */
+void power_save_get_stats(power_save_stats_t* stats)
+{
+    portENTER_CRITICAL(&power_spinlock);
+    stats->sleep_us = sleep_time_total_us;
+    stats->sleep_count = sleep_count;
+    portEXIT_CRITICAL(&power_spinlock);
+    stats->uptime_us = esp_timer_get_time();
+}
+
+/* 打印活动与睡眠时间占比 */
+void power_save_log_stats(void)
+{
+    power_save_stats_t stats;
+    power_save_get_stats(&stats);
+    int64_t active_us = stats.uptime_us - stats.sleep_us;
+    ESP_LOGI(POWER_TAG, "Uptime %" PRId64 " s: active %" PRId64 " ms (%.2f%%), asleep %" PRId64 " ms in %" PRIu32
+             " sleeps", stats.uptime_us / 1000000, active_us / 1000,
+             stats.uptime_us ? 100.0 * active_us / stats.uptime_us : 0.0, stats.sleep_us / 1000, stats.sleep_count);
+}
@@ -0,0 +1,36 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef POWER_SAVE_H
+#define POWER_SAVE_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 自动浅睡眠统计
+typedef struct {
+    int64_t uptime_us;    // 启动以来的时间
+    int64_t sleep_us;     // 其中处于浅睡眠的时间
+    uint32_t sleep_count; // 进入浅睡眠的次数
+} power_save_stats_t;
+
+// 启用动态调频与自动浅睡眠，未开启 CONFIG_HOLLOW_CLOCK_POWER_SAVE 时返回 ESP_ERR_NOT_SUPPORTED
+esp_err_t power_save_init(void);
+
+// 读取睡眠统计
+void power_save_get_stats(power_save_stats_t* stats);
+
+// 打印活动与睡眠时间占比
+void power_save_log_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //POWER_SAVE_H
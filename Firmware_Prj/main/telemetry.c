@@ -0,0 +1,108 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_check.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+#include "binlog.h"
+#include "clock_status.h"
+#include "FreeRTOS_task.h"
+#include "telemetry.h"
+
+#define TELEMETRY_TAG "TELEMETRY"
+#define TELEMETRY_MAX_TASKS 24  // 采样缓冲能容纳的任务数
+
+#if CONFIG_HOLLOW_CLOCK_TELEMETRY
+// uxTaskGetSystemState() 和周期、栈大小等选项只在打开遥测时存在，打开遥测会选中 FREERTOS_USE_TRACE_FACILITY
+static motor_control_t* s_motor_control;
+static TaskStatus_t s_tasks[TELEMETRY_MAX_TASKS];
+
+// 一条记录一行十六进制，与 binlog 的原始输出相同，控制台上的其他日志不影响解码
+static void telemetry_emit(const void* record, size_t size)
+{
+    const uint8_t* bytes = (const uint8_t*)record;
+    char line[sizeof(TELEMETRY_LINE_MARK) + 2 * sizeof(telemetry_system_t)] = TELEMETRY_LINE_MARK;
+    size_t mark = sizeof(TELEMETRY_LINE_MARK) - 1;
+    for (size_t i = 0; i < size; i++) {
+        snprintf(&line[mark + 2 * i], 3, "%02x", bytes[i]);
+    }
+    puts(line);
+}
+
+static void telemetry_sample(uint32_t sample)
+{
+    uint32_t total_runtime = 0;
+    UBaseType_t task_count = uxTaskGetSystemState(s_tasks, TELEMETRY_MAX_TASKS, &total_runtime);
+    clock_status_t status;
+    clock_get_status(&status);
+
+    telemetry_system_t system = {
+        .type = TELEMETRY_RECORD_SYSTEM,
+        .version = TELEMETRY_VERSION,
+        .task_count = (uint8_t)task_count,
+        .sample = sample,
+        .time_ms = (uint32_t)(esp_timer_get_time() / 1000),
+        .total_runtime = total_runtime,
+        .free_heap = esp_get_free_heap_size(),
+        .min_free_heap = esp_get_minimum_free_heap_size(),
+        .queue_capacity = STEP_PLANNER_DEPTH,
+        .binlog_dropped = binlog_get_dropped(),
+        .clock_moves = status.moves,
+        .move_time_ms = status.move_time_ms,
+    };
+    if (s_motor_control) {
+        system.queue_depth = (uint8_t)stepper_get_queue_depth(s_motor_control);
+        system.queue_peak = (uint8_t)stepper_take_queue_peak(s_motor_control);
+        system.queue_overflows = (uint16_t)stepper_get_cmd_overflows(s_motor_control);
+        system.emitted_steps = stepper_get_emitted_steps(s_motor_control);
+        system.moves = stepper_get_completed_moves(s_motor_control);
+    }
+    telemetry_emit(&system, sizeof(system));
+
+    for (UBaseType_t i = 0; i < task_count; i++) {
+        const TaskStatus_t* task = &s_tasks[i];
+        telemetry_task_t record = {
+            .type = TELEMETRY_RECORD_TASK,
+            .number = (uint8_t)task->xTaskNumber,
+            .priority = (uint8_t)task->uxCurrentPriority,
+            .state = (uint8_t)task->eCurrentState,
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+            .runtime = task->ulRunTimeCounter,
+#endif
+            // 与 uxTaskGetStackHighWaterMark() 相同，IDF 中以字节计
+            .stack_free = task->usStackHighWaterMark,
+        };
+        memcpy(record.name, task->pcTaskName, strnlen(task->pcTaskName, TELEMETRY_NAME_LEN));
+        telemetry_emit(&record, sizeof(record));
+    }
+}
+
+static void telemetry_task(void* arg)
+{
+    TickType_t last_wake = xTaskGetTickCount();
+    for (uint32_t sample = 0;; sample++) {
+        telemetry_sample(sample);
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(CONFIG_HOLLOW_CLOCK_TELEMETRY_PERIOD_MS));
+    }
+}
+#endif
+
+esp_err_t telemetry_start(motor_control_t* motor_control)
+{
+#if CONFIG_HOLLOW_CLOCK_TELEMETRY
+    s_motor_control = motor_control;
+    ESP_RETURN_ON_FALSE(xTaskCreate(telemetry_task, "telemetry", CONFIG_HOLLOW_CLOCK_TELEMETRY_STACK_SIZE, NULL,
+                                    CONFIG_HOLLOW_CLOCK_TELEMETRY_PRIORITY, NULL) == pdPASS,
+                        ESP_ERR_NO_MEM, TELEMETRY_TAG, "create telemetry task failed");
+    return ESP_OK;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
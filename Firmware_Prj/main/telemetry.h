@@ -0,0 +1,72 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "step_motor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 运行时遥测：低优先级任务定期采样各任务的运行时间和栈余量、堆、运动段环形缓冲的占用和运动计数，
+// 编成定长的二进制记录，每条记录一行 "TM <hex>" 写到控制台（UART 或 USB-Serial-JTAG），
+// 由主机上的 telemetry_decode 还原并计算 CPU 占比。记录格式由固件与解码器共用，改动时增加版本号
+
+#define TELEMETRY_VERSION 1
+#define TELEMETRY_NAME_LEN 12
+#define TELEMETRY_LINE_MARK "TM "
+
+typedef enum {
+    TELEMETRY_RECORD_SYSTEM = 1,
+    TELEMETRY_RECORD_TASK = 2,
+} telemetry_record_type_t;
+
+// 每次采样的第一条记录，随后是 task_count 条任务记录
+typedef struct {
+    uint8_t type;              // TELEMETRY_RECORD_SYSTEM
+    uint8_t version;           // TELEMETRY_VERSION
+    uint8_t task_count;        // 随后的任务记录数，任务多于采样缓冲时为 0
+    uint8_t queue_depth;       // 采样时环形缓冲中的运动段数
+    uint32_t sample;           // 采样序号，解码时缺号说明丢了行
+    uint32_t time_ms;          // 启动以来的时间
+    uint32_t total_runtime;    // 运行时间计数器的总值，各任务的占比按两次采样的差值计算
+    uint32_t free_heap;
+    uint32_t min_free_heap;
+    uint8_t queue_peak;        // 上次采样以来环形缓冲的最高占用
+    uint8_t queue_capacity;    // 环形缓冲的容量
+    uint16_t queue_overflows;  // 因环形缓冲满而被拒绝的命令数（低 16 位）
+    uint32_t binlog_dropped;   // binlog 环形缓冲满时丢弃的事件数
+    uint32_t emitted_steps;    // 已输出的半步数
+    uint32_t moves;            // 驱动完成的运动段数
+    uint32_t clock_moves;      // 时钟任务的运动次数
+    uint32_t move_time_ms;     // 时钟任务运动的累计耗时
+} telemetry_system_t;
+
+typedef struct {
+    uint8_t type;                   // TELEMETRY_RECORD_TASK
+    uint8_t number;                 // FreeRTOS 的任务编号，同名任务也能区分（低 8 位）
+    uint8_t priority;               // 当前优先级
+    uint8_t state;                  // eTaskState
+    uint32_t runtime;               // 运行时间计数器，没有开启运行时间统计时为 0
+    uint32_t stack_free;            // 栈的历史最少剩余（字节）
+    char name[TELEMETRY_NAME_LEN];  // 任务名，过长时截断，不一定以 0 结尾
+} telemetry_task_t;
+
+_Static_assert(sizeof(telemetry_system_t) == 48, "telemetry_system_t must stay packed");
+_Static_assert(sizeof(telemetry_task_t) == 24, "telemetry_task_t must stay packed");
+
+// 启动采样任务，周期为 CONFIG_HOLLOW_CLOCK_TELEMETRY_PERIOD_MS；motor_control 可为 NULL，运动计数为 0。
+// 未开启 CONFIG_HOLLOW_CLOCK_TELEMETRY 时返回 ESP_ERR_NOT_SUPPORTED
+esp_err_t telemetry_start(motor_control_t* motor_control);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //TELEMETRY_H
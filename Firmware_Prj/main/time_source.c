@@ -0,0 +1,107 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stddef.h>
+#include <string.h>
+#include "pos_journal.h"
+#include "time_source.h"
+
+#define TIME_SOURCE_RTC_MAGIC 0x54494d45  // "TIME"
+
+static const char* const s_names[TIME_SOURCE_COUNT] = {
+    [TIME_SOURCE_NONE] = "none",
+    [TIME_SOURCE_JOURNAL] = "journal",
+    [TIME_SOURCE_MANUAL] = "manual",
+    [TIME_SOURCE_RTC] = "rtc",
+    [TIME_SOURCE_SNTP] = "sntp",
+};
+
+// 误差上限加上 elapsed_us 内按 drift_ppm 漂移的量，溢出时视为未知
+static uint32_t time_source_grow(uint32_t uncertainty_ms, int64_t elapsed_us, uint32_t drift_ppm)
+{
+    if (uncertainty_ms == TIME_SOURCE_UNBOUNDED) {
+        return TIME_SOURCE_UNBOUNDED;
+    }
+    uint64_t grown = uncertainty_ms + (uint64_t)(elapsed_us > 0 ? elapsed_us : 0) * drift_ppm / 1000000000ULL;
+    return grown >= TIME_SOURCE_UNBOUNDED ? TIME_SOURCE_UNBOUNDED : (uint32_t)grown;
+}
+
+void time_source_init(time_source_t* ts, uint32_t drift_ppm, uint32_t trust_ms)
+{
+    memset(ts, 0, sizeof(*ts));
+    ts->drift_ppm = drift_ppm;
+    ts->trust_ms = trust_ms;
+}
+
+void time_source_update(time_source_t* ts, time_source_id_t source, int64_t epoch_us, uint32_t uncertainty_ms,
+                        int64_t mono_us)
+{
+    if (source <= TIME_SOURCE_NONE || source >= TIME_SOURCE_COUNT) {
+        return;
+    }
+    ts->anchors[source] = (time_source_anchor_t) {
+        .valid = true,
+        .epoch_us = epoch_us,
+        .mono_us = mono_us,
+        .uncertainty_ms = uncertainty_ms,
+    };
+}
+
+time_estimate_t time_source_best(const time_source_t* ts, int64_t mono_us)
+{
+    time_estimate_t best = {
+        .source = TIME_SOURCE_NONE,
+        .uncertainty_ms = TIME_SOURCE_UNBOUNDED,
+    };
+    for (int i = TIME_SOURCE_COUNT - 1; i > TIME_SOURCE_NONE; i--) {
+        const time_source_anchor_t* anchor = &ts->anchors[i];
+        if (!anchor->valid) {
+            continue;
+        }
+        uint32_t uncertainty = time_source_grow(anchor->uncertainty_ms, mono_us - anchor->mono_us, ts->drift_ppm);
+        // 从高到低遍历，误差上限相同时保留质量高的
+        if (best.source == TIME_SOURCE_NONE || uncertainty < best.uncertainty_ms) {
+            best.source = (time_source_id_t)i;
+            best.epoch_us = anchor->epoch_us + (mono_us - anchor->mono_us);
+            best.uncertainty_ms = uncertainty;
+        }
+    }
+    best.trusted = best.uncertainty_ms <= ts->trust_ms;
+    return best;
+}
+
+void time_source_save(const time_source_t* ts, int64_t mono_us, uint64_t rtc_us, time_source_rtc_record_t* record)
+{
+    time_estimate_t best = time_source_best(ts, mono_us);
+    memset(record, 0, sizeof(*record));
+    if (best.uncertainty_ms == TIME_SOURCE_UNBOUNDED) {
+        return;
+    }
+    record->magic = TIME_SOURCE_RTC_MAGIC;
+    record->uncertainty_ms = best.uncertainty_ms;
+    record->epoch_us = best.epoch_us;
+    record->rtc_us = rtc_us;
+    record->source = (uint8_t)best.source;
+    record->crc = pos_journal_crc16(record, offsetof(time_source_rtc_record_t, crc));
+}
+
+bool time_source_restore(time_source_t* ts, const time_source_rtc_record_t* record, uint64_t rtc_us,
+                         uint32_t rtc_drift_ppm, int64_t mono_us)
+{
+    if (record->magic != TIME_SOURCE_RTC_MAGIC ||
+        record->crc != pos_journal_crc16(record, offsetof(time_source_rtc_record_t, crc)) ||
+        record->uncertainty_ms == TIME_SOURCE_UNBOUNDED || rtc_us < record->rtc_us) {
+        return false;
+    }
+    int64_t elapsed_us = (int64_t)(rtc_us - record->rtc_us);
+    time_source_update(ts, TIME_SOURCE_RTC, record->epoch_us + elapsed_us,
+                       time_source_grow(record->uncertainty_ms, elapsed_us, rtc_drift_ppm), mono_us);
+    return true;
+}
+
+const char* time_source_name(time_source_id_t source)
+{
+    return source < TIME_SOURCE_COUNT ? s_names[source] : "?";
+}
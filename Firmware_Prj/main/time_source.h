@@ -0,0 +1,92 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef TIME_SOURCE_H
+#define TIME_SOURCE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 时间来源的分级：每个来源记下锚定时的 Unix 时间、单调时间和误差上限，之后误差按晶振的
+// 漂移上限随时间增长。当前最好的估计取误差上限最小的来源，误差上限不超过阈值时才可信，
+// 时钟只按可信的时间转动指针。不依赖 FreeRTOS，固件与主机仿真共用，锁由调用者负责
+
+// 误差上限未知，例如位置日志里的时间只是当前时间的下限
+#define TIME_SOURCE_UNBOUNDED UINT32_MAX
+#define TIME_SOURCE_SNTP_UNCERTAINTY_MS 100     // SNTP 应答的往返时延和服务器误差
+#define TIME_SOURCE_MANUAL_UNCERTAINTY_MS 30000 // 手动设置只精确到分钟
+
+// 按质量从低到高排列，误差上限相同时取排在后面的
+typedef enum {
+    TIME_SOURCE_NONE,     // 没有任何来源，系统时间从 1970 年开始
+    TIME_SOURCE_JOURNAL,  // 位置日志里最后一次记录的时间，断电多久未知
+    TIME_SOURCE_MANUAL,   // set_clock_target_time() 手动设置，只精确到分钟
+    TIME_SOURCE_RTC,      // 复位前存在 RTC 内存里的估计加上 RTC 慢时钟走过的时间
+    TIME_SOURCE_SNTP,     // 最近一次 SNTP 同步
+    TIME_SOURCE_COUNT,
+} time_source_id_t;
+
+typedef struct {
+    bool valid;
+    int64_t epoch_us;         // 锚定时的 Unix 时间（微秒）
+    int64_t mono_us;          // 锚定时的单调时间（微秒）
+    uint32_t uncertainty_ms;  // 锚定时的误差上限
+} time_source_anchor_t;
+
+typedef struct {
+    time_source_anchor_t anchors[TIME_SOURCE_COUNT];
+    uint32_t drift_ppm;  // 锚定之后本地晶振的漂移上限
+    uint32_t trust_ms;   // 误差上限不超过此值的估计才可信
+} time_source_t;
+
+// 当前最好的估计
+typedef struct {
+    time_source_id_t source;
+    int64_t epoch_us;
+    uint32_t uncertainty_ms;
+    bool trusted;
+} time_estimate_t;
+
+// 存在 RTC 内存里的最后一次估计，软件复位、看门狗复位和 panic 后保留，上电后内容随机
+typedef struct {
+    uint32_t magic;
+    uint32_t uncertainty_ms;
+    int64_t epoch_us;   // 保存时的估计
+    uint64_t rtc_us;    // 保存时的 RTC 定时器，复位期间继续计数
+    uint8_t source;     // 保存时估计的来源，只用于日志
+    uint8_t reserved;
+    uint16_t crc;       // 之前字节的 CRC-16/CCITT
+} time_source_rtc_record_t;
+
+// 初始化，所有来源都无效
+void time_source_init(time_source_t* ts, uint32_t drift_ppm, uint32_t trust_ms);
+
+// 用新的读数重新锚定一个来源，mono_us 为读数对应的单调时间
+void time_source_update(time_source_t* ts, time_source_id_t source, int64_t epoch_us, uint32_t uncertainty_ms,
+                        int64_t mono_us);
+
+// mono_us 时刻的最好估计；没有任何来源时 source 为 TIME_SOURCE_NONE，误差上限未知
+time_estimate_t time_source_best(const time_source_t* ts, int64_t mono_us);
+
+// 把 mono_us 时刻的最好估计写成 RTC 记录；误差上限未知时写入无效记录
+void time_source_save(const time_source_t* ts, int64_t mono_us, uint64_t rtc_us, time_source_rtc_record_t* record);
+
+// 复位后从 RTC 记录恢复 TIME_SOURCE_RTC：复位期间走过的时间由 RTC 定时器给出，误差按 rtc_drift_ppm 增长。
+// 记录无效或 RTC 定时器已经从头计数（上电复位）时返回 false
+bool time_source_restore(time_source_t* ts, const time_source_rtc_record_t* record, uint64_t rtc_us,
+                         uint32_t rtc_drift_ppm, int64_t mono_us);
+
+// 来源的名字，用于日志
+const char* time_source_name(time_source_id_t source);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //TIME_SOURCE_H
@@ -0,0 +1,308 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <inttypes.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_check.h"
+#include "esp_event.h"
+#include "esp_log.h"
+#include "esp_netif.h"
+#include "esp_smartconfig.h"
+#include "esp_sntp.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+#include "msg_bus.h"
+#include "nvs.h"
+#include "sdkconfig.h"
+#include "wifi_conn.h"
+
+static const char* TAG = "wifi_conn";
+
+// 凭据的命名空间、键和格式沿用原来的，已配网的设备升级后不用重新配网
+#define WIFI_NVS_NAMESPACE "wifi_data"
+#define WIFI_NVS_KEY_CONFIG "key_wifi_data"
+#define WIFI_NVS_KEY_AP "ap_cache"
+
+// 退避定时器和 SNTP 回调都把事件转到默认事件循环，状态机只在事件循环任务中运行
+ESP_EVENT_DEFINE_BASE(WIFI_CONN_EVENT);
+
+enum {
+    WIFI_CONN_EVENT_RETRY,      // 退避定时器到期
+    WIFI_CONN_EVENT_TIME_SYNC,  // SNTP 同步完成
+};
+
+static wifi_reconnect_t s_rc;
+static portMUX_TYPE s_rc_lock = portMUX_INITIALIZER_UNLOCKED;  // 状态机在事件循环中改动，其他任务读统计时持有
+static wifi_config_t s_wifi_config;      // 保存的凭据，每次连接按动作改写扫描方式
+static esp_timer_handle_t s_retry_timer;
+static TaskHandle_t s_smartconfig_task;
+static bool s_provisioning;              // 没有凭据，连接由 SmartConfig 控制
+static bool s_sntp_started;
+
+// 读取凭据和上次关联的 AP，返回是否有凭据
+static bool wifi_conn_load(wifi_rc_ap_cache_t* cache)
+{
+    nvs_handle_t nvs;
+    if (nvs_open(WIFI_NVS_NAMESPACE, NVS_READONLY, &nvs) != ESP_OK) {
+        return false;
+    }
+    size_t len = sizeof(s_wifi_config);
+    bool has_config = nvs_get_blob(nvs, WIFI_NVS_KEY_CONFIG, &s_wifi_config, &len) == ESP_OK &&
+                      len == sizeof(s_wifi_config);
+    len = sizeof(*cache);
+    if (nvs_get_blob(nvs, WIFI_NVS_KEY_AP, cache, &len) != ESP_OK || len != sizeof(*cache)) {
+        memset(cache, 0, sizeof(*cache));
+    }
+    nvs_close(nvs);
+    return has_config;
+}
+
+static void wifi_conn_save(const char* key, const void* value, size_t len)
+{
+    nvs_handle_t nvs;
+    esp_err_t ret = nvs_open(WIFI_NVS_NAMESPACE, NVS_READWRITE, &nvs);
+    if (ret == ESP_OK) {
+        ret = nvs_set_blob(nvs, key, value, len);
+        if (ret == ESP_OK) {
+            ret = nvs_commit(nvs);
+        }
+        nvs_close(nvs);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Saving %s failed: %s", key, esp_err_to_name(ret));
+    }
+}
+
+// 执行状态机给出的动作。连接调用本身立即返回，结果由驱动事件送回
+static void wifi_conn_apply(wifi_rc_action_t action)
+{
+    if (action.type == WIFI_RC_ACTION_WAIT) {
+        ESP_LOGI(TAG, "Retrying in %" PRIu32 " ms", action.delay_ms);
+        esp_timer_stop(s_retry_timer);  // 未在运行时返回 ESP_ERR_INVALID_STATE，忽略
+        ESP_ERROR_CHECK(esp_timer_start_once(s_retry_timer, (uint64_t)action.delay_ms * 1000));
+        return;
+    }
+    if (action.type != WIFI_RC_ACTION_CONNECT) {
+        return;
+    }
+    wifi_config_t config = s_wifi_config;
+    if (action.fast) {
+        // 只扫上次的信道并直接锁定 BSSID，省掉全信道扫描
+        config.sta.bssid_set = true;
+        memcpy(config.sta.bssid, s_rc.cache.bssid, sizeof(config.sta.bssid));
+        config.sta.channel = s_rc.cache.channel;
+        config.sta.scan_method = WIFI_FAST_SCAN;
+    } else {
+        config.sta.channel = 0;
+        config.sta.scan_method = WIFI_ALL_CHANNEL_SCAN;
+        config.sta.sort_method = WIFI_CONNECT_AP_BY_SIGNAL;
+    }
+    esp_err_t ret = esp_wifi_set_config(WIFI_IF_STA, &config);
+    if (ret == ESP_OK) {
+        ret = esp_wifi_connect();
+    }
+    if (ret != ESP_OK) {
+        // 按一次失败处理，状态机会退避，不会在这里反复重试
+        ESP_LOGW(TAG, "Connect failed: %s", esp_err_to_name(ret));
+        taskENTER_CRITICAL(&s_rc_lock);
+        action = wifi_reconnect_on_disconnected(&s_rc, esp_timer_get_time());
+        taskEXIT_CRITICAL(&s_rc_lock);
+        wifi_conn_apply(action);
+    }
+}
+
+// esp_timer 任务中运行，只投递事件
+static void wifi_conn_retry_cb(void* arg)
+{
+    if (esp_event_post(WIFI_CONN_EVENT, WIFI_CONN_EVENT_RETRY, NULL, 0, 0) != ESP_OK) {
+        ESP_LOGW(TAG, "Event queue full, retry dropped");
+    }
+}
+
+// lwIP 任务中运行，带上收到应答的时刻，订阅者晚些处理也能按这个时刻锚定
+static void wifi_conn_time_sync_cb(struct timeval* tv)
+{
+    msg_payload_t msg = {
+        .time_sync = {
+            .epoch_us = tv->tv_sec * 1000000LL + tv->tv_usec,
+            .mono_us = esp_timer_get_time(),
+        },
+    };
+    esp_event_post(WIFI_CONN_EVENT, WIFI_CONN_EVENT_TIME_SYNC, NULL, 0, 0);
+    msg_bus_publish(MSG_TOPIC_TIME_SYNC, &msg);
+}
+
+static void wifi_conn_publish_state(bool connected, int64_t time_to_ip_us)
+{
+    msg_payload_t msg = {
+        .wifi_state = {
+            .connected = connected,
+            .time_to_ip_us = time_to_ip_us,
+        },
+    };
+    msg_bus_publish(MSG_TOPIC_WIFI_STATE, &msg);
+}
+
+static void wifi_conn_start_sntp(void)
+{
+    esp_sntp_setoperatingmode(SNTP_OPMODE_POLL);
+    sntp_set_sync_mode(SNTP_SYNC_MODE_SMOOTH);
+    sntp_set_time_sync_notification_cb(wifi_conn_time_sync_cb);
+    esp_sntp_setservername(0, "ntp1.aliyun.com");
+    esp_sntp_setservername(1, "ntp2.aliyun.com");
+    esp_sntp_setservername(2, "ntp3.aliyun.com");
+    esp_sntp_init();
+    s_sntp_started = true;
+}
+
+static void wifi_conn_smartconfig_task(void* pvParameters)
+{
+    ESP_ERROR_CHECK(esp_smartconfig_set_type(SC_TYPE_ESPTOUCH));
+    smartconfig_start_config_t cfg = SMARTCONFIG_START_CONFIG_DEFAULT();
+    ESP_ERROR_CHECK(esp_smartconfig_start(&cfg));
+    // 手机收到确认后由事件处理函数通知
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    ESP_LOGI(TAG, "SmartConfig done");
+    esp_smartconfig_stop();
+    s_smartconfig_task = NULL;
+    vTaskDelete(NULL);
+}
+
+static void wifi_conn_on_credentials(const smartconfig_event_got_ssid_pswd_t* evt)
+{
+    memset(&s_wifi_config, 0, sizeof(s_wifi_config));
+    memcpy(s_wifi_config.sta.ssid, evt->ssid, sizeof(s_wifi_config.sta.ssid));
+    memcpy(s_wifi_config.sta.password, evt->password, sizeof(s_wifi_config.sta.password));
+    s_wifi_config.sta.bssid_set = evt->bssid_set;
+    if (evt->bssid_set) {
+        memcpy(s_wifi_config.sta.bssid, evt->bssid, sizeof(s_wifi_config.sta.bssid));
+    }
+    ESP_LOGI(TAG, "Got credentials for SSID %.32s", (const char*)s_wifi_config.sta.ssid);
+    wifi_conn_save(WIFI_NVS_KEY_CONFIG, &s_wifi_config, sizeof(s_wifi_config));
+    s_provisioning = false;
+
+    // 新网络的 AP 一定不是缓存的那个
+    taskENTER_CRITICAL(&s_rc_lock);
+    wifi_reconnect_forget_ap(&s_rc);
+    wifi_rc_action_t action = wifi_reconnect_on_start(&s_rc, esp_timer_get_time());
+    taskEXIT_CRITICAL(&s_rc_lock);
+    wifi_conn_apply(action);
+}
+
+static void wifi_conn_event_handler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data)
+{
+    int64_t now = esp_timer_get_time();
+    wifi_rc_action_t action = {.type = WIFI_RC_ACTION_NONE};
+
+    if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START) {
+        if (s_provisioning) {
+            if (xTaskCreate(wifi_conn_smartconfig_task, "smartconfig", 4096, NULL, 3, &s_smartconfig_task) != pdPASS) {
+                ESP_LOGE(TAG, "SmartConfig task not started");
+            }
+            return;
+        }
+        taskENTER_CRITICAL(&s_rc_lock);
+        action = wifi_reconnect_on_start(&s_rc, now);
+        taskEXIT_CRITICAL(&s_rc_lock);
+    } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_CONNECTED) {
+        const wifi_event_sta_connected_t* evt = (const wifi_event_sta_connected_t*)event_data;
+        taskENTER_CRITICAL(&s_rc_lock);
+        bool changed = wifi_reconnect_on_associated(&s_rc, evt->bssid, evt->channel);
+        wifi_rc_ap_cache_t cache = s_rc.cache;
+        taskEXIT_CRITICAL(&s_rc_lock);
+        // 只在换了 AP 或信道时写 NVS，平时的重连不产生写入
+        if (changed) {
+            ESP_LOGI(TAG, "AP on channel %u cached", cache.channel);
+            wifi_conn_save(WIFI_NVS_KEY_AP, &cache, sizeof(cache));
+        }
+    } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
+        const wifi_event_sta_disconnected_t* evt = (const wifi_event_sta_disconnected_t*)event_data;
+        wifi_conn_publish_state(false, -1);
+        if (s_provisioning) {
+            return;
+        }
+        ESP_LOGI(TAG, "Disconnected, reason %u", evt->reason);
+        taskENTER_CRITICAL(&s_rc_lock);
+        action = wifi_reconnect_on_disconnected(&s_rc, now);
+        taskEXIT_CRITICAL(&s_rc_lock);
+    } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
+        taskENTER_CRITICAL(&s_rc_lock);
+        wifi_reconnect_on_got_ip(&s_rc, now);
+        int64_t time_to_ip_us = s_rc.stats.last_time_to_ip_us;
+        taskEXIT_CRITICAL(&s_rc_lock);
+        ESP_LOGI(TAG, "Got IP in %" PRId64 " ms", time_to_ip_us / 1000);
+        wifi_conn_publish_state(true, time_to_ip_us);
+        if (!s_sntp_started) {
+            wifi_conn_start_sntp();
+        }
+    } else if (event_base == SC_EVENT && event_id == SC_EVENT_GOT_SSID_PSWD) {
+        wifi_conn_on_credentials((const smartconfig_event_got_ssid_pswd_t*)event_data);
+    } else if (event_base == SC_EVENT && event_id == SC_EVENT_SEND_ACK_DONE) {
+        if (s_smartconfig_task) {
+            xTaskNotifyGive(s_smartconfig_task);
+        }
+    } else if (event_base == WIFI_CONN_EVENT && event_id == WIFI_CONN_EVENT_RETRY) {
+        taskENTER_CRITICAL(&s_rc_lock);
+        action = wifi_reconnect_on_timer(&s_rc, now);
+        taskEXIT_CRITICAL(&s_rc_lock);
+    } else if (event_base == WIFI_CONN_EVENT && event_id == WIFI_CONN_EVENT_TIME_SYNC) {
+        taskENTER_CRITICAL(&s_rc_lock);
+        wifi_reconnect_on_time_sync(&s_rc, now);
+        taskEXIT_CRITICAL(&s_rc_lock);
+    }
+    wifi_conn_apply(action);
+}
+
+esp_err_t wifi_conn_start(void)
+{
+    ESP_RETURN_ON_ERROR(esp_netif_init(), TAG, "netif init failed");
+    ESP_RETURN_ON_ERROR(esp_event_loop_create_default(), TAG, "event loop create failed");
+    ESP_RETURN_ON_FALSE(esp_netif_create_default_wifi_sta(), ESP_FAIL, TAG, "sta netif create failed");
+    wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
+    ESP_RETURN_ON_ERROR(esp_wifi_init(&cfg), TAG, "wifi init failed");
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = wifi_conn_retry_cb,
+        .name = "wifi_retry",
+    };
+    ESP_RETURN_ON_ERROR(esp_timer_create(&timer_args, &s_retry_timer), TAG, "retry timer create failed");
+
+    // esp_timer 从启动开始计时，统计中的启动时间取 0
+    wifi_rc_ap_cache_t cache;
+    bool has_config = wifi_conn_load(&cache);
+    const wifi_rc_config_t rc_config = {
+        .backoff_min_ms = CONFIG_HOLLOW_CLOCK_WIFI_BACKOFF_MIN_MS,
+        .backoff_max_ms = CONFIG_HOLLOW_CLOCK_WIFI_BACKOFF_MAX_MS,
+        .fast_attempts = CONFIG_HOLLOW_CLOCK_WIFI_FAST_ATTEMPTS,
+    };
+    wifi_reconnect_init(&s_rc, &rc_config, &cache, 0);
+    s_provisioning = !has_config;
+    ESP_LOGI(TAG, "%s, %s", has_config ? "Credentials found" : "No credentials, starting SmartConfig",
+             s_rc.cache.valid ? "fast reconnect to cached AP" : "no cached AP");
+
+    ESP_RETURN_ON_ERROR(esp_event_handler_register(WIFI_EVENT, ESP_EVENT_ANY_ID, wifi_conn_event_handler, NULL),
+                        TAG, "register handler failed");
+    ESP_RETURN_ON_ERROR(esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP, wifi_conn_event_handler, NULL),
+                        TAG, "register handler failed");
+    ESP_RETURN_ON_ERROR(esp_event_handler_register(SC_EVENT, ESP_EVENT_ANY_ID, wifi_conn_event_handler, NULL),
+                        TAG, "register handler failed");
+    ESP_RETURN_ON_ERROR(esp_event_handler_register(WIFI_CONN_EVENT, ESP_EVENT_ANY_ID, wifi_conn_event_handler, NULL),
+                        TAG, "register handler failed");
+
+    ESP_RETURN_ON_ERROR(esp_wifi_set_mode(WIFI_MODE_STA), TAG, "set mode failed");
+    if (has_config) {
+        ESP_RETURN_ON_ERROR(esp_wifi_set_config(WIFI_IF_STA, &s_wifi_config), TAG, "set config failed");
+    }
+    return esp_wifi_start();
+}
+
+void wifi_conn_get_stats(wifi_rc_stats_t* stats)
+{
+    taskENTER_CRITICAL(&s_rc_lock);
+    *stats = s_rc.stats;
+    taskEXIT_CRITICAL(&s_rc_lock);
+}
@@ -0,0 +1,31 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef WIFI_CONN_H
+#define WIFI_CONN_H
+
+#include "esp_err.h"
+#include "wifi_reconnect.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Wi-Fi 连接管理：按 wifi_reconnect 状态机的动作驱动 esp_wifi，所有回调都不阻塞事件循环。
+// 凭据只在 SmartConfig 配网时写入 NVS，断开不会清除；第一次获取 IP 后启动 SNTP。
+// 连接状态发布到 MSG_TOPIC_WIFI_STATE，SNTP 同步或校正发布到 MSG_TOPIC_TIME_SYNC
+
+// 初始化网络接口、默认事件循环和 Wi-Fi 驱动并启动连接，NVS 须已初始化；
+// 没有保存的凭据时启动 SmartConfig 配网
+esp_err_t wifi_conn_start(void);
+
+// 连接统计，可在任意任务中调用
+void wifi_conn_get_stats(wifi_rc_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //WIFI_CONN_H
@@ -0,0 +1,121 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <string.h>
+#include "wifi_reconnect.h"
+
+void wifi_reconnect_init(wifi_reconnect_t* rc, const wifi_rc_config_t* config,
+                         const wifi_rc_ap_cache_t* cache, int64_t now_us)
+{
+    memset(rc, 0, sizeof(*rc));
+    rc->config = *config;
+    if (cache && cache->valid && cache->channel) {
+        rc->cache = *cache;
+    }
+    rc->state = WIFI_RC_IDLE;
+    rc->backoff_ms = config->backoff_min_ms;
+    rc->boot_us = now_us;
+    rc->outage_us = now_us;
+    rc->stats.last_time_to_ip_us = -1;
+    rc->stats.max_time_to_ip_us = -1;
+    rc->stats.boot_to_ip_us = -1;
+    rc->stats.boot_to_sync_us = -1;
+}
+
+// 发起一次连接：缓存有效且这一轮还没失败够次数时只扫一个信道
+static wifi_rc_action_t wifi_reconnect_connect(wifi_reconnect_t* rc)
+{
+    rc->state = WIFI_RC_CONNECTING;
+    rc->attempt_fast = rc->cache.valid && rc->fast_failures < rc->config.fast_attempts;
+    rc->stats.attempts++;
+    if (rc->attempt_fast) {
+        rc->stats.fast_attempts++;
+    }
+    return (wifi_rc_action_t) {.type = WIFI_RC_ACTION_CONNECT, .fast = rc->attempt_fast};
+}
+
+// 新一轮连接：退避和缓存失败次数从头算
+static wifi_rc_action_t wifi_reconnect_begin(wifi_reconnect_t* rc, int64_t now_us)
+{
+    rc->outage_us = now_us;
+    rc->backoff_ms = rc->config.backoff_min_ms;
+    rc->fast_failures = 0;
+    return wifi_reconnect_connect(rc);
+}
+
+wifi_rc_action_t wifi_reconnect_on_start(wifi_reconnect_t* rc, int64_t now_us)
+{
+    return wifi_reconnect_begin(rc, now_us);
+}
+
+void wifi_reconnect_forget_ap(wifi_reconnect_t* rc)
+{
+    rc->cache.valid = false;
+}
+
+bool wifi_reconnect_on_associated(wifi_reconnect_t* rc, const uint8_t bssid[6], uint8_t channel)
+{
+    bool changed = !rc->cache.valid || rc->cache.channel != channel || memcmp(rc->cache.bssid, bssid, 6);
+    memcpy(rc->cache.bssid, bssid, 6);
+    rc->cache.channel = channel;
+    rc->cache.valid = true;
+    return changed;
+}
+
+void wifi_reconnect_on_got_ip(wifi_reconnect_t* rc, int64_t now_us)
+{
+    int64_t time_to_ip = now_us - rc->outage_us;
+    rc->state = WIFI_RC_CONNECTED;
+    rc->backoff_ms = rc->config.backoff_min_ms;
+    rc->fast_failures = 0;
+    rc->stats.connects++;
+    rc->stats.last_time_to_ip_us = time_to_ip;
+    if (time_to_ip > rc->stats.max_time_to_ip_us) {
+        rc->stats.max_time_to_ip_us = time_to_ip;
+    }
+    if (rc->stats.boot_to_ip_us < 0) {
+        rc->stats.boot_to_ip_us = now_us - rc->boot_us;
+    }
+}
+
+wifi_rc_action_t wifi_reconnect_on_disconnected(wifi_reconnect_t* rc, int64_t now_us)
+{
+    switch (rc->state) {
+    case WIFI_RC_CONNECTED:
+        // 多数断开是短暂的（信标丢失、AP 重启），AP 大概率还在原来的信道上，立即重连
+        rc->stats.drops++;
+        return wifi_reconnect_begin(rc, now_us);
+    case WIFI_RC_CONNECTING:
+        if (rc->attempt_fast && ++rc->fast_failures >= rc->config.fast_attempts) {
+            // AP 换了信道或已经不在，不必等待，立即全信道扫描确认
+            rc->stats.fast_misses++;
+            return wifi_reconnect_connect(rc);
+        }
+        rc->state = WIFI_RC_BACKOFF;
+        wifi_rc_action_t action = {.type = WIFI_RC_ACTION_WAIT, .delay_ms = rc->backoff_ms};
+        rc->backoff_ms = rc->backoff_ms > rc->config.backoff_max_ms / 2 ? rc->config.backoff_max_ms
+                                                                        : rc->backoff_ms * 2;
+        return action;
+    default:
+        // 主动断开或退避期间的重复事件，下一次连接由定时器发起
+        return (wifi_rc_action_t) {.type = WIFI_RC_ACTION_NONE};
+    }
+}
+
+wifi_rc_action_t wifi_reconnect_on_timer(wifi_reconnect_t* rc, int64_t now_us)
+{
+    (void)now_us;
+    if (rc->state != WIFI_RC_BACKOFF) {
+        return (wifi_rc_action_t) {.type = WIFI_RC_ACTION_NONE};
+    }
+    return wifi_reconnect_connect(rc);
+}
+
+void wifi_reconnect_on_time_sync(wifi_reconnect_t* rc, int64_t now_us)
+{
+    if (rc->stats.boot_to_sync_us < 0) {
+        rc->stats.boot_to_sync_us = now_us - rc->boot_us;
+    }
+}
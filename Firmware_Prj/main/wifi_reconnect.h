@@ -0,0 +1,103 @@
+/*
+ * SPDX-FileCopyrightText: Copyright 2025 JeongYeham
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef WIFI_RECONNECT_H
+#define WIFI_RECONNECT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Wi-Fi 重连状态机，不依赖 esp_wifi 和 FreeRTOS，固件与主机仿真共用。
+// 输入是驱动事件和退避定时器到期，输出是下一步该做的动作，由调用者执行；
+// 断开只会重试，不会清除凭据
+
+typedef enum {
+    WIFI_RC_IDLE,        // 还没有开始连接
+    WIFI_RC_CONNECTING,  // 已调用连接，等待关联和 DHCP
+    WIFI_RC_CONNECTED,   // 已获取 IP
+    WIFI_RC_BACKOFF,     // 连接失败，等待退避定时器
+} wifi_rc_state_t;
+
+typedef enum {
+    WIFI_RC_ACTION_NONE,     // 什么也不做
+    WIFI_RC_ACTION_CONNECT,  // 立即连接，fast 为真时只扫缓存的信道并锁定缓存的 BSSID
+    WIFI_RC_ACTION_WAIT,     // 启动退避定时器，delay_ms 后调用 wifi_reconnect_on_timer
+} wifi_rc_action_type_t;
+
+typedef struct {
+    wifi_rc_action_type_t type;
+    bool fast;
+    uint32_t delay_ms;
+} wifi_rc_action_t;
+
+typedef struct {
+    uint32_t backoff_min_ms;  // 第一次失败后的等待时间，之后每次失败翻倍
+    uint32_t backoff_max_ms;  // 等待时间上限
+    uint8_t fast_attempts;    // 缓存的 AP 连续失败多少次后改为全信道扫描
+} wifi_rc_config_t;
+
+// 上次获取 IP 时关联的 AP，断电后仍然有效，由调用者保存
+typedef struct {
+    uint8_t bssid[6];
+    uint8_t channel;
+    bool valid;
+} wifi_rc_ap_cache_t;
+
+typedef struct {
+    uint32_t connects;            // 获取 IP 的次数
+    uint32_t drops;               // 已连接后断开的次数
+    uint32_t attempts;            // 调用连接的次数
+    uint32_t fast_attempts;       // 其中只扫缓存信道的次数
+    uint32_t fast_misses;         // 缓存的 AP 找不到或换了信道，退回全信道扫描的次数
+    int64_t last_time_to_ip_us;   // 最近一次从开始连接或断开到获取 IP 的时间，-1 表示还没有
+    int64_t max_time_to_ip_us;    // 其中最长的一次
+    int64_t boot_to_ip_us;        // 启动到第一次获取 IP，-1 表示还没有
+    int64_t boot_to_sync_us;      // 启动到第一次 SNTP 同步，-1 表示还没有
+} wifi_rc_stats_t;
+
+typedef struct {
+    wifi_rc_config_t config;
+    wifi_rc_state_t state;
+    wifi_rc_ap_cache_t cache;
+    bool attempt_fast;        // 当前这次连接是否只扫缓存信道
+    uint8_t fast_failures;    // 本轮缓存 AP 连续失败的次数
+    uint32_t backoff_ms;      // 下一次失败后的等待时间
+    int64_t boot_us;          // 初始化时的时间
+    int64_t outage_us;        // 本轮连接开始或断开的时间
+    wifi_rc_stats_t stats;
+} wifi_reconnect_t;
+
+// 初始化状态机，cache 可为 NULL；所有时间由调用者给出（微秒，单调递增）
+void wifi_reconnect_init(wifi_reconnect_t* rc, const wifi_rc_config_t* config,
+                         const wifi_rc_ap_cache_t* cache, int64_t now_us);
+
+// 驱动已启动且凭据可用，或者刚配网拿到新凭据（此时 cache 先失效）
+wifi_rc_action_t wifi_reconnect_on_start(wifi_reconnect_t* rc, int64_t now_us);
+void wifi_reconnect_forget_ap(wifi_reconnect_t* rc);
+
+// 已关联到 AP，返回 true 表示缓存的 BSSID 或信道变了，调用者应保存新的缓存
+bool wifi_reconnect_on_associated(wifi_reconnect_t* rc, const uint8_t bssid[6], uint8_t channel);
+
+// 已获取 IP，退避复位
+void wifi_reconnect_on_got_ip(wifi_reconnect_t* rc, int64_t now_us);
+
+// 断开或连接失败：刚断开时立即用缓存重连，连接中失败则退避
+wifi_rc_action_t wifi_reconnect_on_disconnected(wifi_reconnect_t* rc, int64_t now_us);
+
+// 退避定时器到期
+wifi_rc_action_t wifi_reconnect_on_timer(wifi_reconnect_t* rc, int64_t now_us);
+
+// SNTP 同步完成，只用于统计
+void wifi_reconnect_on_time_sync(wifi_reconnect_t* rc, int64_t now_us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //WIFI_RECONNECT_H